@@ -0,0 +1,117 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "emu/graphics/bitmap_image.h"
+#include "emu/graphics/copybits.h"
+#include "emu/graphics/graphics_helpers.h"
+#include "emu/graphics/region.h"
+
+namespace cyder {
+namespace {
+
+using graphics::BitmapImage;
+
+// The dimensions of the original Macintosh screen.
+constexpr int kScreenWidth = 512;
+constexpr int kScreenHeight = 342;
+
+constexpr uint8_t kGrayPattern[8] = {0xAA, 0x55, 0xAA, 0x55,
+                                     0xAA, 0x55, 0xAA, 0x55};
+
+// A square of `size` pixels which is deliberately not byte aligned.
+Rect NewSquare(int size) {
+  return NewRect(/*x=*/3, /*y=*/5, size, size);
+}
+
+void BM_FillRect(benchmark::State& state) {
+  BitmapImage screen(kScreenWidth, kScreenHeight);
+  const Rect rect = NewSquare(state.range(0));
+  for (auto _ : state) {
+    screen.FillRect(rect, kGrayPattern);
+  }
+  benchmark::DoNotOptimize(screen.bits());
+  state.SetItemsProcessed(state.iterations() * state.range(0) *
+                          state.range(0));
+}
+BENCHMARK(BM_FillRect)->RangeMultiplier(4)->Range(8, 256);
+
+void BM_FillRectXOr(benchmark::State& state) {
+  BitmapImage screen(kScreenWidth, kScreenHeight);
+  const Rect rect = NewSquare(state.range(0));
+  for (auto _ : state) {
+    screen.FillRect(rect, kGrayPattern, BitmapImage::FillMode::XOr);
+  }
+  benchmark::DoNotOptimize(screen.bits());
+  state.SetItemsProcessed(state.iterations() * state.range(0) *
+                          state.range(0));
+}
+BENCHMARK(BM_FillRectXOr)->RangeMultiplier(4)->Range(8, 256);
+
+void BM_FillEllipse(benchmark::State& state) {
+  BitmapImage screen(kScreenWidth, kScreenHeight);
+  const Rect rect = NewSquare(state.range(0));
+  for (auto _ : state) {
+    screen.FillEllipse(rect, kGrayPattern);
+  }
+  benchmark::DoNotOptimize(screen.bits());
+  state.SetItemsProcessed(state.iterations() * state.range(0) *
+                          state.range(0));
+}
+BENCHMARK(BM_FillEllipse)->RangeMultiplier(4)->Range(8, 256);
+
+void BM_FillRegion(benchmark::State& state) {
+  BitmapImage screen(kScreenWidth, kScreenHeight);
+  // Two overlapping squares so that the region has multiple ranges per row
+  const int size = state.range(0);
+  auto r1 = region::NewRectRegion(NewSquare(size));
+  auto r2 = region::NewRectRegion(3 + size / 2, 5 + size / 2, size, size);
+  auto region =
+      region::Union(region::ConvertRegion(r1), region::ConvertRegion(r2));
+  for (auto _ : state) {
+    screen.FillRegion(region, kGrayPattern);
+  }
+  benchmark::DoNotOptimize(screen.bits());
+}
+BENCHMARK(BM_FillRegion)->RangeMultiplier(4)->Range(8, 256);
+
+void BM_CopyBits(benchmark::State& state) {
+  BitmapImage screen(kScreenWidth, kScreenHeight);
+  BitmapImage source(kScreenWidth, kScreenHeight);
+  source.FillRect(NewRect(0, 0, kScreenWidth, kScreenHeight), kGrayPattern);
+
+  const Rect src_dims = NewRect(0, 0, kScreenWidth, kScreenHeight);
+  const int size = state.range(0);
+  const Rect src_rect = NewRect(/*x=*/0, /*y=*/0, size, size);
+  // Unaligned with the source so every row must be shifted
+  const Rect dst_rect = NewSquare(size);
+  for (auto _ : state) {
+    screen.CopyBits(source.bits(), src_dims, src_rect, dst_rect);
+  }
+  benchmark::DoNotOptimize(screen.bits());
+  state.SetItemsProcessed(state.iterations() * size * size);
+}
+BENCHMARK(BM_CopyBits)->RangeMultiplier(4)->Range(8, 256);
+
+// Copies a row of `range(0)` bits from bit offset `range(1)` to bit offset 3.
+void BM_BitarrayCopy(benchmark::State& state) {
+  const int length = state.range(0);
+  std::vector<uint8_t> src(length / 8 + 2, 0xA5);
+  std::vector<uint8_t> dst(length / 8 + 2);
+  for (auto _ : state) {
+    bitarray_copy(src.data(), state.range(1), length, dst.data(),
+                  /*dst_offset=*/3);
+    benchmark::DoNotOptimize(dst.data());
+  }
+  state.SetBytesProcessed(state.iterations() * length / 8);
+}
+BENCHMARK(BM_BitarrayCopy)
+    ->ArgNames({"bits", "src_offset"})
+    ->ArgsProduct({{64, 512, 4096}, {3, 5}});
+
+}  // namespace
+}  // namespace cyder
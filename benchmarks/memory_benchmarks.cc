@@ -0,0 +1,199 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "core/memory_reader.h"
+#include "core/memory_region.h"
+#include "core/status_helpers.h"
+#include "emu/debug/debug_manager.h"
+#include "emu/machine.h"
+#include "emu/memory/memory_manager.h"
+#include "emu/memory/memory_map.h"
+
+namespace cyder {
+namespace {
+
+constexpr size_t kRegionSize = 64 * 1024;
+
+template <typename T>
+void BM_MemoryRegionRead(benchmark::State& state) {
+  std::vector<uint8_t> data(kRegionSize);
+  core::MemoryRegion region(data.data(), data.size());
+
+  size_t offset = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(MUST(region.Read<T>(offset)));
+    offset = (offset + sizeof(T)) % kRegionSize;
+  }
+  state.SetBytesProcessed(state.iterations() * sizeof(T));
+}
+BENCHMARK(BM_MemoryRegionRead<uint8_t>);
+BENCHMARK(BM_MemoryRegionRead<uint16_t>);
+BENCHMARK(BM_MemoryRegionRead<uint32_t>);
+
+template <typename T>
+void BM_MemoryRegionWrite(benchmark::State& state) {
+  std::vector<uint8_t> data(kRegionSize);
+  core::MemoryRegion region(data.data(), data.size());
+
+  size_t offset = 0;
+  for (auto _ : state) {
+    CHECK_OK(region.Write<T>(offset, static_cast<T>(offset)));
+    offset = (offset + sizeof(T)) % kRegionSize;
+  }
+  benchmark::DoNotOptimize(data.data());
+  state.SetBytesProcessed(state.iterations() * sizeof(T));
+}
+BENCHMARK(BM_MemoryRegionWrite<uint8_t>);
+BENCHMARK(BM_MemoryRegionWrite<uint16_t>);
+BENCHMARK(BM_MemoryRegionWrite<uint32_t>);
+
+// Reads through a sub-region (as done for every handle/resource).
+void BM_MemoryRegionCreateAndRead(benchmark::State& state) {
+  std::vector<uint8_t> data(kRegionSize);
+  core::MemoryRegion region(data.data(), data.size());
+
+  size_t offset = 0;
+  for (auto _ : state) {
+    auto sub_region = MUST(region.Create("sub", offset, /*size=*/64));
+    benchmark::DoNotOptimize(MUST(sub_region.Read<uint32_t>(60)));
+    offset = (offset + 64) % kRegionSize;
+  }
+}
+BENCHMARK(BM_MemoryRegionCreateAndRead);
+
+template <typename T>
+void BM_MemoryReaderNext(benchmark::State& state) {
+  std::vector<uint8_t> data(kRegionSize);
+  core::MemoryRegion region(data.data(), data.size());
+
+  core::MemoryReader reader(region);
+  for (auto _ : state) {
+    if (!reader.HasNext())
+      reader.OffsetTo(0);
+    benchmark::DoNotOptimize(MUST(reader.Next<T>()));
+  }
+  state.SetBytesProcessed(state.iterations() * sizeof(T));
+}
+BENCHMARK(BM_MemoryReaderNext<uint8_t>);
+BENCHMARK(BM_MemoryReaderNext<uint16_t>);
+BENCHMARK(BM_MemoryReaderNext<uint32_t>);
+
+void BM_MemoryReaderNextString(benchmark::State& state) {
+  // A Pascal string (length byte followed by the characters) per 32 bytes
+  std::vector<uint8_t> data(kRegionSize);
+  for (size_t offset = 0; offset < kRegionSize; offset += 32) {
+    data[offset] = 31;
+    std::fill_n(&data[offset + 1], 31, 'A');
+  }
+  core::MemoryRegion region(data.data(), data.size());
+
+  core::MemoryReader reader(region);
+  for (auto _ : state) {
+    if (!reader.HasNext())
+      reader.OffsetTo(0);
+    benchmark::DoNotOptimize(MUST(reader.NextString()));
+  }
+}
+BENCHMARK(BM_MemoryReaderNextString);
+
+// The number of handles allocated for the MemoryManager benchmarks
+constexpr int kHandleCount = 512;
+
+void BM_GetRegionForHandle(benchmark::State& state) {
+  Machine machine;
+  Machine::Activation activation(machine);
+  memory::MemoryManager memory_manager;
+  std::vector<Handle> handles;
+  for (int i = 0; i < kHandleCount; ++i)
+    handles.push_back(memory_manager.AllocateHandle(32, "Benchmark"));
+
+  size_t index = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(memory_manager.GetRegionForHandle(
+        handles[index++ % handles.size()]));
+  }
+}
+BENCHMARK(BM_GetRegionForHandle);
+
+void BM_GetHandleThatContains(benchmark::State& state) {
+  Machine machine;
+  Machine::Activation activation(machine);
+  memory::MemoryManager memory_manager;
+  std::vector<Ptr> ptrs;
+  for (int i = 0; i < kHandleCount; ++i) {
+    ptrs.push_back(memory_manager.GetPtrForHandle(
+        memory_manager.AllocateHandle(32, "Benchmark")));
+  }
+
+  size_t index = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(memory_manager.GetHandleThatContains(
+        ptrs[index++ % ptrs.size()] + 16));
+  }
+}
+BENCHMARK(BM_GetHandleThatContains);
+
+// A store to `kSystemMemory` with the initialized memory watcher installed
+// (as with --checked_memory) and many tagged spans in the `DebugManager`.
+void BM_WatchedWrite(benchmark::State& state) {
+  Machine machine;
+  Machine::Activation activation(machine);
+  memory::InstallMemoryWatcher();
+  for (size_t i = 0; i < kHandleCount; ++i) {
+    DebugManager::Instance().TagMemory(memory::kHeapStart + i * 64,
+                                       memory::kHeapStart + i * 64 + 32,
+                                       "Benchmark");
+  }
+
+  size_t offset = 0;
+  for (auto _ : state) {
+    CHECK_OK(memory::kSystemMemory.Write<uint32_t>(
+        memory::kHeapStart + offset, static_cast<uint32_t>(offset)));
+    offset = (offset + sizeof(uint32_t)) % kRegionSize;
+  }
+  benchmark::DoNotOptimize(DebugManager::Instance().GetMemoryTags());
+}
+BENCHMARK(BM_WatchedWrite);
+
+// Tags a struct each time it is written (as typegen's WriteType<> does).
+void BM_TagMemory(benchmark::State& state) {
+  Machine machine;
+  Machine::Activation activation(machine);
+  DebugManager& debug_manager = DebugManager::Instance();
+
+  size_t index = 0;
+  for (auto _ : state) {
+    const size_t start = memory::kHeapStart + (index++ % 4096) * 16;
+    debug_manager.TagMemory(start, start + 8, "Rect");
+  }
+  benchmark::DoNotOptimize(debug_manager.GetMemoryTags());
+}
+BENCHMARK(BM_TagMemory);
+
+void BM_GetMemoryTagsAt(benchmark::State& state) {
+  Machine machine;
+  Machine::Activation activation(machine);
+  DebugManager& debug_manager = DebugManager::Instance();
+  debug_manager.TagMemory(memory::kHeapStart, memory::kHeapStart + 64_kb,
+                          "CODE1");
+  for (size_t i = 0; i < 4096; ++i) {
+    const size_t start = memory::kHeapStart + i * 16;
+    debug_manager.TagMemory(start, start + 8, "Rect");
+  }
+
+  size_t index = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(debug_manager.GetMemoryTagsAt(
+        memory::kHeapStart + (index++ % 4096) * 16 + 4));
+  }
+}
+BENCHMARK(BM_GetMemoryTagsAt);
+
+}  // namespace
+}  // namespace cyder
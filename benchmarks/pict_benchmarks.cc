@@ -0,0 +1,96 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "core/memory_reader.h"
+#include "core/memory_region.h"
+#include "core/status_helpers.h"
+#include "emu/graphics/pict_v1.h"
+
+namespace cyder {
+namespace {
+
+constexpr uint16_t kWidth = 512;
+constexpr uint16_t kHeight = 342;
+constexpr uint16_t kRowBytes = kWidth / 8;
+
+void AppendWord(std::vector<uint8_t>& data, uint16_t value) {
+  data.push_back(value >> 8);
+  data.push_back(value & 0xFF);
+}
+
+void AppendRect(std::vector<uint8_t>& data) {
+  AppendWord(data, /*top=*/0);
+  AppendWord(data, /*left=*/0);
+  AppendWord(data, /*bottom=*/kHeight);
+  AppendWord(data, /*right=*/kWidth);
+}
+
+// Appends a row of `kRowBytes` packed as a literal run of half the row followed
+// by a repeated byte for the rest (preceded by the packed length).
+void AppendPackedRow(std::vector<uint8_t>& data) {
+  constexpr uint8_t kHalf = kRowBytes / 2;
+  data.push_back(/*length=*/1 + kHalf + 2);
+  data.push_back(kHalf - 1);
+  for (uint8_t i = 0; i < kHalf; ++i) {
+    data.push_back(i);
+  }
+  data.push_back(static_cast<uint8_t>(-(kHalf - 1)));
+  data.push_back(0xAA);
+}
+
+// A PICT (version 1) of a screen-sized PackBitsRect.
+std::vector<uint8_t> NewPicture() {
+  std::vector<uint8_t> data;
+  AppendWord(data, /*pict_size=*/0);
+  AppendRect(data);
+  data.push_back(0x11);  // picVersion
+  data.push_back(0x01);
+  data.push_back(0x98);  // PackBitsRect
+  AppendWord(data, kRowBytes);
+  AppendRect(data);  // bounds
+  AppendRect(data);  // srcRect
+  AppendRect(data);  // dstRect
+  AppendWord(data, /*mode=*/0);
+  for (int row = 0; row < kHeight; ++row) {
+    AppendPackedRow(data);
+  }
+  data.push_back(0xFF);  // EndOfPicture
+  return data;
+}
+
+void BM_UnpackBits(benchmark::State& state) {
+  std::vector<uint8_t> data;
+  AppendPackedRow(data);
+  core::MemoryRegion region(data.data(), data.size());
+
+  uint8_t row[kRowBytes];
+  for (auto _ : state) {
+    core::MemoryReader reader(region);
+    CHECK_OK(graphics::UnpackBits(reader, row, kRowBytes));
+    benchmark::DoNotOptimize(row);
+  }
+  state.SetBytesProcessed(state.iterations() * kRowBytes);
+}
+BENCHMARK(BM_UnpackBits);
+
+void BM_ParsePICTv1(benchmark::State& state) {
+  std::vector<uint8_t> data = NewPicture();
+  core::MemoryRegion region(data.data(), data.size());
+
+  auto output = std::make_unique<uint8_t[]>(kRowBytes * kHeight);
+  for (auto _ : state) {
+    CHECK_OK(graphics::ParsePICTv1(region, output.get()));
+    benchmark::DoNotOptimize(output.get());
+  }
+  state.SetBytesProcessed(state.iterations() * kRowBytes * kHeight);
+}
+BENCHMARK(BM_ParsePICTv1);
+
+}  // namespace
+}  // namespace cyder
@@ -0,0 +1,79 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "emu/graphics/region.h"
+
+namespace cyder {
+namespace {
+
+using region::OwnedRegion;
+
+// A "staircase" of `steps` overlapping rectangles (so every step adds
+// scanlines and ranges to the region).
+OwnedRegion NewStaircaseRegion(int steps, int16_t offset) {
+  OwnedRegion result = region::NewRectRegion(offset, offset, 32, 32);
+  for (int step = 1; step < steps; ++step) {
+    auto rect = region::NewRectRegion(offset + step * 8, offset + step * 8,
+                                      32, 32);
+    result = region::Union(region::ConvertRegion(result),
+                           region::ConvertRegion(rect));
+  }
+  return result;
+}
+
+// A single scanline of `ranges` ranges (start/end pairs) spaced `stride` apart.
+std::vector<int16_t> NewScanline(int ranges, int16_t start, int16_t stride) {
+  std::vector<int16_t> scanline;
+  for (int range = 0; range < ranges; ++range) {
+    scanline.push_back(start + range * stride);
+    scanline.push_back(start + range * stride + stride / 2);
+  }
+  return scanline;
+}
+
+template <std::vector<int16_t> (*Op)(const core::MemoryRegion&,
+                                     const core::MemoryRegion&)>
+void BM_ScanlineOp(benchmark::State& state) {
+  auto v1_data = NewScanline(state.range(0), /*start=*/0, /*stride=*/8);
+  auto v2_data = NewScanline(state.range(0), /*start=*/3, /*stride=*/8);
+  core::MemoryRegion v1(v1_data.data(), v1_data.size() * sizeof(int16_t),
+                        /*is_big_endian=*/false);
+  core::MemoryRegion v2(v2_data.data(), v2_data.size() * sizeof(int16_t),
+                        /*is_big_endian=*/false);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(Op(v1, v2));
+  }
+}
+BENCHMARK(BM_ScanlineOp<region::Union>)->Range(1, 64);
+BENCHMARK(BM_ScanlineOp<region::Intersect>)->Range(1, 64);
+BENCHMARK(BM_ScanlineOp<region::Subtract>)->Range(1, 64);
+
+template <OwnedRegion (*Op)(const region::Region&, const region::Region&)>
+void BM_RegionOp(benchmark::State& state) {
+  auto r1 = NewStaircaseRegion(state.range(0), /*offset=*/0);
+  auto r2 = NewStaircaseRegion(state.range(0), /*offset=*/12);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        Op(region::ConvertRegion(r1), region::ConvertRegion(r2)));
+  }
+}
+BENCHMARK(BM_RegionOp<region::Union>)->Range(1, 64);
+BENCHMARK(BM_RegionOp<region::Intersect>)->Range(1, 64);
+BENCHMARK(BM_RegionOp<region::Subtract>)->Range(1, 64);
+
+void BM_RegionOffset(benchmark::State& state) {
+  auto r1 = NewStaircaseRegion(state.range(0), /*offset=*/0);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        region::Offset(region::ConvertRegion(r1), /*dx=*/5, /*dy=*/7));
+  }
+}
+BENCHMARK(BM_RegionOffset)->Range(1, 64);
+
+}  // namespace
+}  // namespace cyder
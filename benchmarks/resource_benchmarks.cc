@@ -0,0 +1,120 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <benchmark/benchmark.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/memory_region.h"
+#include "core/status_helpers.h"
+#include "emu/machine.h"
+#include "emu/memory/memory_manager.h"
+#include "emu/rsrc/resource_file.h"
+#include "emu/rsrc/resource_manager.h"
+
+namespace cyder {
+namespace {
+
+// A raw resource fork with a variety of resources (see //examples).
+constexpr char kResourceFork[] = CYDER_EXAMPLES_DIR "/Window.rsrc";
+
+std::vector<char> ReadFile(const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  CHECK(file.is_open()) << "Unable to open: " << path;
+  return std::vector<char>(std::istreambuf_iterator<char>(file), {});
+}
+
+// Returns the type and ID of every resource in `file`.
+std::vector<std::pair<ResType, ResId>> ListResources(
+    const rsrc::ResourceFile& file) {
+  std::vector<std::pair<ResType, ResId>> resources;
+  for (const auto& group : file.groups()) {
+    for (const auto& resource : group.GetResources()) {
+      resources.emplace_back(group.GetType(), resource.GetId());
+    }
+  }
+  return resources;
+}
+
+void BM_LoadRsrcFork(benchmark::State& state) {
+  std::vector<char> data = ReadFile(kResourceFork);
+  core::MemoryRegion region(data.data(), data.size());
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(MUST(rsrc::ResourceFile::LoadRsrcFork(region)));
+  }
+  state.SetBytesProcessed(state.iterations() * data.size());
+}
+BENCHMARK(BM_LoadRsrcFork);
+
+void BM_FindByTypeAndId(benchmark::State& state) {
+  std::vector<char> data = ReadFile(kResourceFork);
+  core::MemoryRegion region(data.data(), data.size());
+  auto file = MUST(rsrc::ResourceFile::LoadRsrcFork(region));
+  auto resources = ListResources(*file);
+
+  size_t index = 0;
+  for (auto _ : state) {
+    const auto& [type, id] = resources[index++ % resources.size()];
+    benchmark::DoNotOptimize(file->FindByTypeAndId(type, id));
+  }
+}
+BENCHMARK(BM_FindByTypeAndId);
+
+// Loads every resource in to a fresh heap (the first GetResource() of each).
+void BM_GetResource(benchmark::State& state) {
+  std::vector<char> data = ReadFile(kResourceFork);
+  core::MemoryRegion region(data.data(), data.size());
+  auto file = MUST(rsrc::ResourceFile::LoadRsrcFork(region));
+  auto resources = ListResources(*file);
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    {
+      Machine machine;
+      Machine::Activation activation(machine);
+      memory::MemoryManager memory_manager;
+      ResourceManager resource_manager(memory_manager, *file,
+                                       /*system_file=*/nullptr);
+      state.ResumeTiming();
+      for (const auto& [type, id] : resources) {
+        benchmark::DoNotOptimize(resource_manager.GetResource(type, id));
+      }
+      state.PauseTiming();
+    }
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * resources.size());
+}
+BENCHMARK(BM_GetResource);
+
+// Looks up resources which have already been loaded (i.e. GetResource() called
+// every frame).
+void BM_GetResourceCached(benchmark::State& state) {
+  std::vector<char> data = ReadFile(kResourceFork);
+  core::MemoryRegion region(data.data(), data.size());
+  auto file = MUST(rsrc::ResourceFile::LoadRsrcFork(region));
+  auto resources = ListResources(*file);
+
+  Machine machine;
+  Machine::Activation activation(machine);
+  memory::MemoryManager memory_manager;
+  ResourceManager resource_manager(memory_manager, *file,
+                                   /*system_file=*/nullptr);
+  for (const auto& [type, id] : resources) {
+    resource_manager.GetResource(type, id);
+  }
+
+  size_t index = 0;
+  for (auto _ : state) {
+    const auto& [type, id] = resources[index++ % resources.size()];
+    benchmark::DoNotOptimize(resource_manager.GetResource(type, id));
+  }
+}
+BENCHMARK(BM_GetResourceCached);
+
+}  // namespace
+}  // namespace cyder
@@ -0,0 +1,47 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+
+#include "emu/memory/memory_map.h"
+#include "emu/trap/stack_helpers.h"
+#include "third_party/musashi/src/m68k.h"
+
+namespace cyder {
+namespace {
+
+// Pushes then pops `T` (as every native trap does with its arguments).
+template <typename T>
+void BM_PushPop(benchmark::State& state) {
+  m68k_set_reg(M68K_REG_SP, memory::StackStart());
+  for (auto _ : state) {
+    trap::Push<T>(T{1});
+    benchmark::DoNotOptimize(trap::Pop<T>());
+  }
+}
+BENCHMARK(BM_PushPop<bool>);
+BENCHMARK(BM_PushPop<uint16_t>);
+BENCHMARK(BM_PushPop<uint32_t>);
+
+// A typical trap: three arguments popped and a result written back.
+void BM_TrapArguments(benchmark::State& state) {
+  m68k_set_reg(M68K_REG_SP, memory::StackStart());
+  for (auto _ : state) {
+    trap::Push<uint32_t>(0);  // Space for the result
+    trap::Push<uint32_t>(0x1234);
+    trap::Push<uint16_t>(42);
+    trap::Push<bool>(true);
+
+    benchmark::DoNotOptimize(trap::Pop<bool>());
+    benchmark::DoNotOptimize(trap::Pop<uint16_t>());
+    benchmark::DoNotOptimize(trap::Pop<uint32_t>());
+    CHECK_OK(trap::TrapReturn<uint32_t>(0xCAFEF00D));
+    benchmark::DoNotOptimize(trap::Pop<uint32_t>());
+  }
+}
+BENCHMARK(BM_TrapArguments);
+
+}  // namespace
+}  // namespace cyder
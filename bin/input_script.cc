@@ -0,0 +1,112 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+// Writes an input log (see emu/input_log.h) from a script so that a replayed
+// workload can be reviewed and edited as text. Each line of the script is:
+//
+//   <tick> move <x> <y>   the mouse is at (x, y) from this tick on
+//   <tick> down <x> <y>   the mouse button is pressed at (x, y)
+//   <tick> up <x> <y>     the mouse button is released at (x, y)
+//   <tick> key            a key is pressed (without a key code, like `emu`)
+//
+// Ticks must not decrease. Blank lines and those starting with '#' are ignored.
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/strings/strip.h"
+#include "core/status_helpers.h"
+#include "core/status_main.h"
+#include "emu/event_manager.h"
+#include "emu/input_log.h"
+
+namespace {
+
+using ::cyder::InputLogEntry;
+
+absl::StatusOr<InputLogEntry> ParseLine(const std::vector<std::string>& words) {
+  InputLogEntry entry;
+  EventRecord& event = entry.event;
+  event.what = cyder::kNullEvent;
+  event.message = 0;
+  event.modifiers = 0;
+  event.where.x = event.where.y = 0;
+
+  if (words.size() < 2 || !absl::SimpleAtoi(words[0], &entry.tick)) {
+    return absl::InvalidArgumentError("Expected '<tick> <action>'");
+  }
+  event.when = entry.tick;
+
+  const std::string& action = words[1];
+  if (action == "key") {
+    if (words.size() != 2)
+      return absl::InvalidArgumentError("Expected '<tick> key'");
+    event.what = cyder::kKeyDown;
+    return entry;
+  }
+
+  if (action == "move") {
+    event.what = cyder::kNullEvent;
+  } else if (action == "down") {
+    event.what = cyder::kMouseDown;
+  } else if (action == "up") {
+    event.what = cyder::kMouseUp;
+  } else {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Unknown action: '", action, "'"));
+  }
+  int x, y;
+  if (words.size() != 4 || !absl::SimpleAtoi(words[2], &x) ||
+      !absl::SimpleAtoi(words[3], &y)) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Expected '<tick> ", action, " <x> <y>'"));
+  }
+  event.where.x = x;
+  event.where.y = y;
+  return entry;
+}
+
+}  // namespace
+
+absl::Status Main(const core::Args& args) {
+  auto script_path = TRY(args.GetArg(1, "SCRIPT"));
+  auto output_path = TRY(args.GetArg(2, "OUTPUT"));
+
+  std::ifstream script(script_path);
+  if (!script) {
+    return absl::NotFoundError(
+        absl::StrCat("Could not open script: ", script_path));
+  }
+
+  std::vector<InputLogEntry> entries;
+  std::string line;
+  for (int line_number = 1; std::getline(script, line); ++line_number) {
+    absl::string_view text = absl::StripAsciiWhitespace(line);
+    if (text.empty() || text.front() == '#')
+      continue;
+
+    std::vector<std::string> words =
+        absl::StrSplit(text, ' ', absl::SkipWhitespace());
+    auto entry = ParseLine(words);
+    if (entry.ok() && !entries.empty() && entry->tick < entries.back().tick) {
+      entry = absl::InvalidArgumentError("Ticks must not decrease");
+    }
+    if (!entry.ok()) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          script_path, ":", line_number, ": ", entry.status().message()));
+    }
+    entries.push_back(*entry);
+  }
+
+  auto log = TRY(cyder::InputLogWriter::Open(output_path));
+  for (const auto& entry : entries) {
+    log->Write(entry);
+  }
+  return absl::OkStatus();
+}
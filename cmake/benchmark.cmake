@@ -0,0 +1,12 @@
+# Copyright (c) 2025, Jordan Werthman
+# SPDX-License-Identifier: BSD-2-Clause
+
+#! benchmark: define a Google Benchmark target in $target_name
+#
+# Expects a .cc file with the same name to be present. The target is added to
+# CYDER_BENCHMARK_TARGETS which is run by `run_benchmarks` (see //benchmarks).
+macro(benchmark target_name)
+  add_executable(${target_name} ${target_name}.cc)
+  target_link_libraries(${target_name} benchmark::benchmark_main)
+  list(APPEND CYDER_BENCHMARK_TARGETS ${target_name})
+endmacro()
@@ -116,12 +116,12 @@ class MemoryRegion final {
                                size_t offset,
                                size_t size) const;
 
-  const std::string name_;
-  uint8_t* const data_;
-  const size_t size_;
+  std::string name_;
+  uint8_t* data_;
+  size_t size_;
 
-  const size_t maximum_size_;
-  const size_t base_offset_;
+  size_t maximum_size_;
+  size_t base_offset_;
   bool is_big_endian_;
 
   std::shared_ptr<SharedData> shared_data_;
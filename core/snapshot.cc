@@ -0,0 +1,71 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "snapshot.h"
+
+#include <cerrno>
+#include <fstream>
+#include <sstream>
+
+#include "absl/strings/str_cat.h"
+#include "status_helpers.h"
+
+namespace core {
+namespace {
+
+absl::Status FileError(const std::string& path) {
+  return absl::InternalError(
+      absl::StrCat("Error accessing: '", path, "': ", strerror(errno)));
+}
+
+}  // namespace
+
+void SnapshotWriter::WriteBytes(const void* data, size_t size) {
+  data_.append(reinterpret_cast<const char*>(data), size);
+}
+
+void SnapshotWriter::WriteString(const std::string& value) {
+  Write<uint32_t>(value.size());
+  WriteBytes(value.data(), value.size());
+}
+
+absl::Status SnapshotWriter::SaveToFile(const std::string& path) const {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file.write(data_.data(), data_.size()))
+    return FileError(path);
+  return absl::OkStatus();
+}
+
+SnapshotReader::SnapshotReader(std::string data) : data_(std::move(data)) {}
+
+// static
+absl::StatusOr<SnapshotReader> SnapshotReader::LoadFromFile(
+    const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file)
+    return FileError(path);
+
+  std::stringstream data;
+  data << file.rdbuf();
+  return SnapshotReader(data.str());
+}
+
+absl::Status SnapshotReader::ReadBytes(void* data, size_t size) {
+  if (size > data_.size() - offset_) {
+    return absl::OutOfRangeError(
+        absl::StrCat("Snapshot truncated reading ", size, " bytes at offset ",
+                     offset_, " (of ", data_.size(), ")"));
+  }
+  memcpy(data, data_.data() + offset_, size);
+  offset_ += size;
+  return absl::OkStatus();
+}
+
+absl::StatusOr<std::string> SnapshotReader::ReadString() {
+  auto size = TRY(Read<uint32_t>());
+  std::string value(size, '\0');
+  RETURN_IF_ERROR(ReadBytes(value.data(), size));
+  return value;
+}
+
+}  // namespace core
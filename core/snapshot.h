@@ -0,0 +1,69 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+
+namespace core {
+
+// Writes a flat stream of values which make up a save-state. Values are
+// stored in host byte order as a snapshot is only ever restored by the same
+// build which saved it.
+class SnapshotWriter final {
+ public:
+  template <typename Type>
+  void Write(const Type& value) {
+    static_assert(std::is_trivially_copyable<Type>::value,
+                  "Only trivially copyable types can be written directly");
+    WriteBytes(&value, sizeof(Type));
+  }
+
+  void WriteBytes(const void* data, size_t size);
+  // Writes the size of `value` followed by its data.
+  void WriteString(const std::string& value);
+
+  const std::string& data() const { return data_; }
+
+  // Saves the stream to the file at `path` (overwriting it).
+  absl::Status SaveToFile(const std::string& path) const;
+
+ private:
+  std::string data_;
+};
+
+// Reads back the stream written by `SnapshotWriter`.
+class SnapshotReader final {
+ public:
+  explicit SnapshotReader(std::string data);
+
+  static absl::StatusOr<SnapshotReader> LoadFromFile(const std::string& path);
+
+  template <typename Type>
+  absl::StatusOr<Type> Read() {
+    static_assert(std::is_trivially_copyable<Type>::value,
+                  "Only trivially copyable types can be read directly");
+    Type value;
+    absl::Status status = ReadBytes(&value, sizeof(Type));
+    if (!status.ok())
+      return status;
+    return value;
+  }
+
+  absl::Status ReadBytes(void* data, size_t size);
+  absl::StatusOr<std::string> ReadString();
+
+  bool at_end() const { return offset_ == data_.size(); }
+
+ private:
+  std::string data_;
+  size_t offset_{0};
+};
+
+}  // namespace core
@@ -20,6 +20,9 @@ class Args {
   absl::StatusOr<std::string> GetArg(size_t index,
                                      const std::string& argument_name) const;
 
+  // The number of arguments (including the program name at index 0).
+  size_t size() const { return args_.size(); }
+
  private:
   const std::vector<char*> args_;
 };
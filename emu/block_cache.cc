@@ -0,0 +1,1110 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/block_cache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+
+#include "core/logging.h"
+#include "core/status_helpers.h"
+#include "emu/machine.h"
+#include "emu/memory/code_pages.h"
+#include "emu/memory/memory_map.h"
+#include "third_party/musashi/src/m68k.h"
+
+namespace cyder {
+namespace {
+
+constexpr bool kVerboseLogging = false;
+
+#define LOG_BLOCK(level) LOG_IF(level, kVerboseLogging)
+
+// Blocks are capped in length so that invalidation only needs to look a short
+// distance before a write for blocks which could overlap it.
+constexpr size_t kMaxBlockInstructions = 64;
+// The longest cached instruction is `MOVE.L #imm,abs.l` at 10 bytes.
+constexpr uint32_t kMaxInstructionSize = 10;
+constexpr uint32_t kMaxBlockSize = kMaxBlockInstructions * kMaxInstructionSize;
+
+// Condition code register (low byte of SR) flags
+constexpr uint16_t kCarry = 1 << 0;
+constexpr uint16_t kOverflow = 1 << 1;
+constexpr uint16_t kZero = 1 << 2;
+constexpr uint16_t kNegative = 1 << 3;
+constexpr uint16_t kExtend = 1 << 4;
+constexpr uint16_t kNZVC = kNegative | kZero | kOverflow | kCarry;
+constexpr uint16_t kXNZVC = kExtend | kNZVC;
+
+constexpr m68k_register_t kDataRegisters[] = {
+    M68K_REG_D0, M68K_REG_D1, M68K_REG_D2, M68K_REG_D3,
+    M68K_REG_D4, M68K_REG_D5, M68K_REG_D6, M68K_REG_D7};
+constexpr m68k_register_t kAddressRegisters[] = {
+    M68K_REG_A0, M68K_REG_A1, M68K_REG_A2, M68K_REG_A3,
+    M68K_REG_A4, M68K_REG_A5, M68K_REG_A6, M68K_REG_A7};
+
+// The registers used by cached blocks. These are copied from Musashi when
+// `BlockCache::Execute()` begins and copied back before it returns.
+struct CpuState {
+  uint32_t d[8];
+  uint32_t a[8];
+  uint32_t pc;
+  uint16_t sr;
+  // Set when an instruction transfers control (or the running block was
+  // invalidated) to stop running the current block.
+  bool end_block;
+};
+
+CpuState cpu;
+
+enum class Mode : uint8_t {
+  kDataRegister,      // Dn
+  kAddressRegister,   // An
+  kIndirect,          // (An)
+  kPostIncrement,     // (An)+
+  kPreDecrement,      // -(An)
+  kDisplacement,      // d16(An)
+  kAbsolute,          // abs.w, abs.l and d16(PC) (resolved when decoded)
+  kImmediate,         // #imm
+};
+
+struct Operand {
+  Mode mode;
+  uint8_t reg;
+  // Displacement, absolute address, immediate value or branch target.
+  uint32_t value;
+};
+
+struct Op {
+  void (*handler)(const Op&);
+  // Address of the following instruction.
+  uint32_t next_pc;
+  Operand src;
+  Operand dst;
+  // Condition for Bcc/DBcc.
+  uint8_t condition;
+};
+
+template <typename T>
+constexpr uint32_t kMostSignificantBit = 1u << (sizeof(T) * 8 - 1);
+
+template <typename T>
+int32_t SignExtend(uint32_t value) {
+  return static_cast<std::make_signed_t<T>>(value);
+}
+
+template <typename T>
+uint32_t ReadMemory(uint32_t address) {
+  if constexpr (sizeof(T) == 1)
+    return m68k_read_memory_8(address);
+  else if constexpr (sizeof(T) == 2)
+    return m68k_read_memory_16(address);
+  else
+    return m68k_read_memory_32(address);
+}
+
+template <typename T>
+void WriteMemory(uint32_t address, uint32_t value) {
+  if constexpr (sizeof(T) == 1)
+    m68k_write_memory_8(address, value);
+  else if constexpr (sizeof(T) == 2)
+    m68k_write_memory_16(address, value);
+  else
+    m68k_write_memory_32(address, value);
+}
+
+// Writes the low `sizeof(T)` bytes of `value` leaving the rest of Dn as is.
+template <typename T>
+void SetDataRegister(uint8_t reg, uint32_t value) {
+  if constexpr (sizeof(T) == 4) {
+    cpu.d[reg] = value;
+  } else {
+    constexpr uint32_t mask = static_cast<T>(~0u);
+    cpu.d[reg] = (cpu.d[reg] & ~mask) | (value & mask);
+  }
+}
+
+// Returns the address of a memory operand applying any increment/decrement.
+template <typename T>
+uint32_t Address(const Operand& operand) {
+  // Byte operations on the stack pointer move it by a word to keep it even.
+  constexpr uint32_t step = sizeof(T);
+  switch (operand.mode) {
+    case Mode::kIndirect:
+      return cpu.a[operand.reg];
+    case Mode::kPostIncrement: {
+      uint32_t address = cpu.a[operand.reg];
+      cpu.a[operand.reg] += (step == 1 && operand.reg == 7) ? 2 : step;
+      return address;
+    }
+    case Mode::kPreDecrement:
+      return cpu.a[operand.reg] -= (step == 1 && operand.reg == 7) ? 2 : step;
+    case Mode::kDisplacement:
+      return cpu.a[operand.reg] + operand.value;
+    case Mode::kAbsolute:
+      return operand.value;
+    default:
+      LOG(FATAL) << "Operand is not in memory";
+      return 0;
+  }
+}
+
+template <typename T>
+uint32_t Read(const Operand& operand) {
+  switch (operand.mode) {
+    case Mode::kDataRegister:
+      return static_cast<T>(cpu.d[operand.reg]);
+    case Mode::kAddressRegister:
+      return static_cast<T>(cpu.a[operand.reg]);
+    case Mode::kImmediate:
+      return operand.value;
+    default:
+      return ReadMemory<T>(Address<T>(operand));
+  }
+}
+
+template <typename T>
+void Write(const Operand& operand, uint32_t value) {
+  if (operand.mode == Mode::kDataRegister)
+    return SetDataRegister<T>(operand.reg, value);
+  WriteMemory<T>(Address<T>(operand), value);
+}
+
+// Replaces the value of `operand` with `func(value)` calculating the effective
+// address only once (so any increment/decrement only happens once).
+template <typename T, typename Func>
+void Modify(const Operand& operand, Func&& func) {
+  if (operand.mode == Mode::kDataRegister) {
+    return SetDataRegister<T>(operand.reg,
+                              func(static_cast<T>(cpu.d[operand.reg])));
+  }
+  uint32_t address = Address<T>(operand);
+  WriteMemory<T>(address, func(ReadMemory<T>(address)));
+}
+
+void SetFlags(uint16_t flags, uint16_t mask) {
+  cpu.sr = (cpu.sr & ~mask) | flags;
+}
+
+template <typename T>
+uint16_t NegativeAndZero(uint32_t result) {
+  return (static_cast<T>(result) == 0 ? kZero : 0) |
+         (result & kMostSignificantBit<T> ? kNegative : 0);
+}
+
+// Sets N and Z based on `result` and clears V and C (X is unchanged).
+template <typename T>
+void SetLogicFlags(uint32_t result) {
+  SetFlags(NegativeAndZero<T>(result), kNZVC);
+}
+
+template <typename T>
+uint32_t Add(uint32_t dst, uint32_t src) {
+  dst = static_cast<T>(dst);
+  src = static_cast<T>(src);
+  uint64_t wide = uint64_t{dst} + src;
+  uint32_t result = static_cast<T>(wide);
+
+  uint16_t flags = NegativeAndZero<T>(result);
+  if ((src ^ result) & (dst ^ result) & kMostSignificantBit<T>)
+    flags |= kOverflow;
+  if (wide >> (sizeof(T) * 8))
+    flags |= kCarry | kExtend;
+  SetFlags(flags, kXNZVC);
+  return result;
+}
+
+// Returns `dst - src`. Comparisons leave X unchanged.
+template <typename T>
+uint32_t Subtract(uint32_t dst, uint32_t src, bool is_compare = false) {
+  dst = static_cast<T>(dst);
+  src = static_cast<T>(src);
+  uint32_t result = static_cast<T>(dst - src);
+
+  uint16_t flags = NegativeAndZero<T>(result);
+  if ((src ^ dst) & (result ^ dst) & kMostSignificantBit<T>)
+    flags |= kOverflow;
+  if (src > dst)
+    flags |= is_compare ? kCarry : kCarry | kExtend;
+  SetFlags(flags, is_compare ? kNZVC : kXNZVC);
+  return result;
+}
+
+bool TestCondition(uint8_t condition) {
+  const bool c = cpu.sr & kCarry;
+  const bool v = cpu.sr & kOverflow;
+  const bool z = cpu.sr & kZero;
+  const bool n = cpu.sr & kNegative;
+  switch (condition) {
+    case 0x0: return true;              // T
+    case 0x1: return false;             // F
+    case 0x2: return !c && !z;          // HI
+    case 0x3: return c || z;            // LS
+    case 0x4: return !c;                // CC
+    case 0x5: return c;                 // CS
+    case 0x6: return !z;                // NE
+    case 0x7: return z;                 // EQ
+    case 0x8: return !v;                // VC
+    case 0x9: return v;                 // VS
+    case 0xA: return !n;                // PL
+    case 0xB: return n;                 // MI
+    case 0xC: return n == v;            // GE
+    case 0xD: return n != v;            // LT
+    case 0xE: return !z && n == v;      // GT
+    default: return z || n != v;        // LE
+  }
+}
+
+// ===================  Instruction Handlers  =======================
+
+void Nop(const Op&) {}
+
+void Moveq(const Op& op) {
+  cpu.d[op.dst.reg] = op.src.value;
+  SetLogicFlags<uint32_t>(op.src.value);
+}
+
+template <typename T>
+void Move(const Op& op) {
+  uint32_t value = Read<T>(op.src);
+  Write<T>(op.dst, value);
+  SetLogicFlags<T>(value);
+}
+
+template <typename T>
+void Movea(const Op& op) {
+  cpu.a[op.dst.reg] = SignExtend<T>(Read<T>(op.src));
+}
+
+void Lea(const Op& op) {
+  cpu.a[op.dst.reg] = Address<uint32_t>(op.src);
+}
+
+template <typename T>
+void Addq(const Op& op) {
+  Modify<T>(op.dst, [&](uint32_t value) { return Add<T>(value, op.src.value); });
+}
+
+template <typename T>
+void Subq(const Op& op) {
+  Modify<T>(op.dst,
+            [&](uint32_t value) { return Subtract<T>(value, op.src.value); });
+}
+
+// ADDQ/SUBQ to An always affect the whole register and leave the CCR as is.
+void AddqAddress(const Op& op) {
+  cpu.a[op.dst.reg] += op.src.value;
+}
+
+void SubqAddress(const Op& op) {
+  cpu.a[op.dst.reg] -= op.src.value;
+}
+
+template <typename T>
+void Tst(const Op& op) {
+  SetLogicFlags<T>(Read<T>(op.dst));
+}
+
+template <typename T>
+void Clr(const Op& op) {
+  Write<T>(op.dst, 0);
+  SetFlags(kZero, kNZVC);
+}
+
+template <typename T>
+void AddToRegister(const Op& op) {
+  SetDataRegister<T>(op.dst.reg, Add<T>(cpu.d[op.dst.reg], Read<T>(op.src)));
+}
+
+template <typename T>
+void AddToMemory(const Op& op) {
+  const uint32_t src = cpu.d[op.src.reg];
+  Modify<T>(op.dst, [&](uint32_t value) { return Add<T>(value, src); });
+}
+
+template <typename T>
+void SubtractFromRegister(const Op& op) {
+  SetDataRegister<T>(op.dst.reg,
+                     Subtract<T>(cpu.d[op.dst.reg], Read<T>(op.src)));
+}
+
+template <typename T>
+void SubtractFromMemory(const Op& op) {
+  const uint32_t src = cpu.d[op.src.reg];
+  Modify<T>(op.dst, [&](uint32_t value) { return Subtract<T>(value, src); });
+}
+
+template <typename T>
+void Cmp(const Op& op) {
+  Subtract<T>(cpu.d[op.dst.reg], Read<T>(op.src), /*is_compare=*/true);
+}
+
+template <typename T>
+void AndToRegister(const Op& op) {
+  uint32_t result = cpu.d[op.dst.reg] & Read<T>(op.src);
+  SetDataRegister<T>(op.dst.reg, result);
+  SetLogicFlags<T>(result);
+}
+
+template <typename T>
+void AndToMemory(const Op& op) {
+  const uint32_t src = cpu.d[op.src.reg];
+  Modify<T>(op.dst, [&](uint32_t value) {
+    SetLogicFlags<T>(value & src);
+    return value & src;
+  });
+}
+
+template <typename T>
+void OrToRegister(const Op& op) {
+  uint32_t result = cpu.d[op.dst.reg] | Read<T>(op.src);
+  SetDataRegister<T>(op.dst.reg, result);
+  SetLogicFlags<T>(result);
+}
+
+template <typename T>
+void OrToMemory(const Op& op) {
+  const uint32_t src = cpu.d[op.src.reg];
+  Modify<T>(op.dst, [&](uint32_t value) {
+    SetLogicFlags<T>(value | src);
+    return value | src;
+  });
+}
+
+// ADDA/SUBA/CMPA sign-extend word sources and always operate on all of An.
+template <typename T>
+void Adda(const Op& op) {
+  cpu.a[op.dst.reg] += SignExtend<T>(Read<T>(op.src));
+}
+
+template <typename T>
+void Suba(const Op& op) {
+  cpu.a[op.dst.reg] -= SignExtend<T>(Read<T>(op.src));
+}
+
+template <typename T>
+void Cmpa(const Op& op) {
+  Subtract<uint32_t>(cpu.a[op.dst.reg], SignExtend<T>(Read<T>(op.src)),
+                     /*is_compare=*/true);
+}
+
+void ExtWord(const Op& op) {
+  uint32_t result = SignExtend<uint8_t>(cpu.d[op.dst.reg]);
+  SetDataRegister<uint16_t>(op.dst.reg, result);
+  SetLogicFlags<uint16_t>(result);
+}
+
+void ExtLong(const Op& op) {
+  cpu.d[op.dst.reg] = SignExtend<uint16_t>(cpu.d[op.dst.reg]);
+  SetLogicFlags<uint32_t>(cpu.d[op.dst.reg]);
+}
+
+void ExtbLong(const Op& op) {
+  cpu.d[op.dst.reg] = SignExtend<uint8_t>(cpu.d[op.dst.reg]);
+  SetLogicFlags<uint32_t>(cpu.d[op.dst.reg]);
+}
+
+void Swap(const Op& op) {
+  uint32_t value = cpu.d[op.dst.reg];
+  cpu.d[op.dst.reg] = (value << 16) | (value >> 16);
+  SetLogicFlags<uint32_t>(cpu.d[op.dst.reg]);
+}
+
+// Shifts by an immediate count (1-8) so the count is never 0.
+template <typename T>
+void LslImmediate(const Op& op) {
+  const uint32_t count = op.src.value;
+  uint64_t shifted = uint64_t{static_cast<T>(cpu.d[op.dst.reg])} << count;
+  uint32_t result = static_cast<T>(shifted);
+  SetDataRegister<T>(op.dst.reg, result);
+  SetFlags(NegativeAndZero<T>(result) |
+               ((shifted >> (sizeof(T) * 8)) & 1 ? kCarry | kExtend : 0),
+           kXNZVC);
+}
+
+template <typename T>
+void LsrImmediate(const Op& op) {
+  const uint32_t count = op.src.value;
+  uint32_t value = static_cast<T>(cpu.d[op.dst.reg]);
+  uint32_t result = value >> count;
+  SetDataRegister<T>(op.dst.reg, result);
+  SetFlags(NegativeAndZero<T>(result) |
+               ((value >> (count - 1)) & 1 ? kCarry | kExtend : 0),
+           kXNZVC);
+}
+
+template <typename T>
+void AsrImmediate(const Op& op) {
+  const uint32_t count = op.src.value;
+  int32_t value = SignExtend<T>(cpu.d[op.dst.reg]);
+  uint32_t result = static_cast<T>(value >> count);
+  SetDataRegister<T>(op.dst.reg, result);
+  SetFlags(NegativeAndZero<T>(result) |
+               ((value >> (count - 1)) & 1 ? kCarry | kExtend : 0),
+           kXNZVC);
+}
+
+// Control flow instructions always end the block (`cpu.pc` is already set to
+// the following instruction so only taken branches need to update it).
+
+void Bcc(const Op& op) {
+  if (TestCondition(op.condition))
+    cpu.pc = op.dst.value;
+  cpu.end_block = true;
+}
+
+void Dbcc(const Op& op) {
+  if (!TestCondition(op.condition)) {
+    uint16_t counter = static_cast<uint16_t>(cpu.d[op.src.reg]) - 1;
+    SetDataRegister<uint16_t>(op.src.reg, counter);
+    if (counter != 0xFFFF)
+      cpu.pc = op.dst.value;
+  }
+  cpu.end_block = true;
+}
+
+void Bsr(const Op& op) {
+  cpu.a[7] -= 4;
+  WriteMemory<uint32_t>(cpu.a[7], op.next_pc);
+  cpu.pc = op.dst.value;
+  cpu.end_block = true;
+}
+
+void Jmp(const Op& op) {
+  cpu.pc = Address<uint32_t>(op.src);
+  cpu.end_block = true;
+}
+
+void Jsr(const Op& op) {
+  uint32_t target = Address<uint32_t>(op.src);
+  cpu.a[7] -= 4;
+  WriteMemory<uint32_t>(cpu.a[7], op.next_pc);
+  cpu.pc = target;
+  cpu.end_block = true;
+}
+
+void Rts(const Op&) {
+  cpu.pc = ReadMemory<uint32_t>(cpu.a[7]);
+  cpu.a[7] += 4;
+  cpu.end_block = true;
+}
+
+// ===================  Decoder  =======================
+
+#define SIZED_HANDLER(handler, size)                     \
+  ((size) == 1   ? &handler<uint8_t>                     \
+   : (size) == 2 ? &handler<uint16_t>                    \
+                 : &handler<uint32_t>)
+
+// Decodes a single instruction (and its extension words) into an `Op`.
+class Decoder {
+ public:
+  explicit Decoder(uint32_t pc) : pc_(pc) {}
+
+  // Returns false if the instruction at the PC can not be cached.
+  bool Decode(Op& op, bool& ends_block);
+
+  uint32_t pc() const { return pc_; }
+  // The approximate number of cycles used by the decoded instruction.
+  int cycles() const { return cycles_; }
+
+ private:
+  bool Next16(uint32_t& value);
+  bool Next32(uint32_t& value);
+
+  // Decodes the effective address `mode` and `reg` fields for an operand of
+  // `size` bytes consuming any extension words. `is_address_only` is set for
+  // operands which are never read (LEA/JMP/JSR).
+  bool DecodeOperand(uint8_t mode,
+                     uint8_t reg,
+                     int size,
+                     Operand& operand,
+                     bool is_address_only = false);
+
+  uint32_t pc_;
+  int cycles_ = 0;
+};
+
+bool Decoder::Next16(uint32_t& value) {
+  auto word = memory::kSystemMemory.Read<uint16_t>(pc_);
+  if (!word.ok())
+    return false;
+  value = *word;
+  pc_ += 2;
+  cycles_ += 4;
+  return true;
+}
+
+bool Decoder::Next32(uint32_t& value) {
+  uint32_t high, low;
+  if (!Next16(high) || !Next16(low))
+    return false;
+  value = (high << 16) | low;
+  return true;
+}
+
+bool Decoder::DecodeOperand(uint8_t mode,
+                            uint8_t reg,
+                            int size,
+                            Operand& operand,
+                            bool is_address_only) {
+  operand.reg = reg;
+  operand.value = 0;
+  // Each memory access costs a bus cycle (two for longs)
+  const int memory_cycles = is_address_only ? 0 : size == 4 ? 8 : 4;
+  switch (mode) {
+    case 0:
+      operand.mode = Mode::kDataRegister;
+      return true;
+    case 1:
+      operand.mode = Mode::kAddressRegister;
+      return true;
+    case 2:
+      operand.mode = Mode::kIndirect;
+      cycles_ += memory_cycles;
+      return true;
+    case 3:
+      operand.mode = Mode::kPostIncrement;
+      cycles_ += memory_cycles;
+      return true;
+    case 4:
+      operand.mode = Mode::kPreDecrement;
+      cycles_ += memory_cycles + 2;
+      return true;
+    case 5: {
+      uint32_t displacement;
+      if (!Next16(displacement))
+        return false;
+      operand.mode = Mode::kDisplacement;
+      operand.value = SignExtend<uint16_t>(displacement);
+      cycles_ += memory_cycles;
+      return true;
+    }
+    case 7:
+      break;
+    default:  // Indexed modes are left to Musashi
+      return false;
+  }
+
+  switch (reg) {
+    case 0: {  // abs.w
+      uint32_t address;
+      if (!Next16(address))
+        return false;
+      operand.mode = Mode::kAbsolute;
+      operand.value = SignExtend<uint16_t>(address);
+      cycles_ += memory_cycles;
+      return true;
+    }
+    case 1: {  // abs.l
+      operand.mode = Mode::kAbsolute;
+      cycles_ += memory_cycles;
+      return Next32(operand.value);
+    }
+    case 2: {  // d16(PC) is relative to the extension word
+      const uint32_t base = pc_;
+      uint32_t displacement;
+      if (!Next16(displacement))
+        return false;
+      operand.mode = Mode::kAbsolute;
+      operand.value = base + SignExtend<uint16_t>(displacement);
+      cycles_ += memory_cycles;
+      return true;
+    }
+    case 4: {  // #imm
+      operand.mode = Mode::kImmediate;
+      if (size == 4)
+        return Next32(operand.value);
+      if (!Next16(operand.value))
+        return false;
+      if (size == 1)
+        operand.value &= 0xFF;
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+// Returns the operand size (in bytes) for the standard size field (bits 7-6).
+int SizeFromField(uint16_t opcode) {
+  switch ((opcode >> 6) & 3) {
+    case 0:
+      return 1;
+    case 1:
+      return 2;
+    case 2:
+      return 4;
+    default:
+      return 0;
+  }
+}
+
+// Data alterable addressing modes (excludes An, d16(PC) and #imm).
+bool IsDataAlterable(uint8_t mode, uint8_t reg) {
+  return mode == 0 || (mode >= 2 && mode <= 6) ||
+         (mode == 7 && (reg == 0 || reg == 1));
+}
+
+bool IsMemoryAlterable(uint8_t mode, uint8_t reg) {
+  return mode != 0 && IsDataAlterable(mode, reg);
+}
+
+// Addressing modes which are valid for LEA/JMP/JSR.
+bool IsControl(uint8_t mode, uint8_t reg) {
+  return mode == 2 || mode == 5 || mode == 6 ||
+         (mode == 7 && (reg == 0 || reg == 1 || reg == 2 || reg == 3));
+}
+
+bool Decoder::Decode(Op& op, bool& ends_block) {
+  const uint32_t pc = pc_;
+  uint32_t opcode;
+  if (!Next16(opcode))
+    return false;
+
+  const uint8_t ea_mode = (opcode >> 3) & 7;
+  const uint8_t ea_reg = opcode & 7;
+  const uint8_t reg = (opcode >> 9) & 7;
+  op.dst = Operand{Mode::kDataRegister, reg, 0};
+  ends_block = false;
+
+  switch (opcode >> 12) {
+    // MOVE/MOVEA
+    case 0x1:
+    case 0x2:
+    case 0x3: {
+      const int size = (opcode >> 12) == 1 ? 1 : (opcode >> 12) == 3 ? 2 : 4;
+      const uint8_t dst_mode = (opcode >> 6) & 7;
+      if (!DecodeOperand(ea_mode, ea_reg, size, op.src))
+        return false;
+      if (size == 1 && ea_mode == 1)
+        return false;
+      if (dst_mode == 1) {
+        if (size == 1)
+          return false;
+        op.handler = size == 2 ? &Movea<uint16_t> : &Movea<uint32_t>;
+        op.dst = Operand{Mode::kAddressRegister, reg, 0};
+        return true;
+      }
+      if (!IsDataAlterable(dst_mode, reg))
+        return false;
+      op.handler = SIZED_HANDLER(Move, size);
+      return DecodeOperand(dst_mode, reg, size, op.dst);
+    }
+
+    case 0x4: {
+      if (opcode == 0x4E71 /* NOP */) {
+        op.handler = &Nop;
+        return true;
+      }
+      if (opcode == 0x4E75 /* RTS */) {
+        op.handler = &Rts;
+        cycles_ += 8;
+        ends_block = true;
+        return true;
+      }
+      if ((opcode & 0xFFB8) == 0x4880 /* EXT */) {
+        op.handler = (opcode & 0x40) ? &ExtLong : &ExtWord;
+        op.dst.reg = ea_reg;
+        return true;
+      }
+      if ((opcode & 0xFFF8) == 0x49C0 /* EXTB.L */) {
+        op.handler = &ExtbLong;
+        op.dst.reg = ea_reg;
+        return true;
+      }
+      if ((opcode & 0xFFF8) == 0x4840 /* SWAP */) {
+        op.handler = &Swap;
+        op.dst.reg = ea_reg;
+        return true;
+      }
+      if ((opcode & 0xF1C0) == 0x41C0 /* LEA */) {
+        if (!IsControl(ea_mode, ea_reg))
+          return false;
+        op.handler = &Lea;
+        op.dst = Operand{Mode::kAddressRegister, reg, 0};
+        return DecodeOperand(ea_mode, ea_reg, 4, op.src,
+                             /*is_address_only=*/true);
+      }
+      if ((opcode & 0xFF80) == 0x4E80 /* JSR/JMP */) {
+        if (!IsControl(ea_mode, ea_reg))
+          return false;
+        op.handler = (opcode & 0x40) ? &Jmp : &Jsr;
+        ends_block = true;
+        return DecodeOperand(ea_mode, ea_reg, 4, op.src,
+                             /*is_address_only=*/true);
+      }
+      const int size = SizeFromField(opcode);
+      if (size == 0 || !IsDataAlterable(ea_mode, ea_reg))
+        return false;
+      if ((opcode & 0xFF00) == 0x4A00 /* TST */) {
+        op.handler = SIZED_HANDLER(Tst, size);
+        return DecodeOperand(ea_mode, ea_reg, size, op.dst);
+      }
+      if ((opcode & 0xFF00) == 0x4200 /* CLR */) {
+        op.handler = SIZED_HANDLER(Clr, size);
+        return DecodeOperand(ea_mode, ea_reg, size, op.dst);
+      }
+      return false;
+    }
+
+    // ADDQ/SUBQ/DBcc (Scc is left to Musashi)
+    case 0x5: {
+      const int size = SizeFromField(opcode);
+      if (size == 0) {
+        if (ea_mode != 1)
+          return false;
+        uint32_t displacement;
+        if (!Next16(displacement))
+          return false;
+        op.handler = &Dbcc;
+        op.condition = (opcode >> 8) & 0xF;
+        op.src = Operand{Mode::kDataRegister, ea_reg, 0};
+        op.dst.value = pc + 2 + SignExtend<uint16_t>(displacement);
+        ends_block = true;
+        return true;
+      }
+
+      const bool is_subtract = opcode & 0x100;
+      op.src = Operand{Mode::kImmediate, 0, reg == 0 ? 8u : reg};
+      if (ea_mode == 1) {
+        if (size == 1)
+          return false;
+        op.handler = is_subtract ? &SubqAddress : &AddqAddress;
+        op.dst = Operand{Mode::kAddressRegister, ea_reg, 0};
+        return true;
+      }
+      if (!IsDataAlterable(ea_mode, ea_reg))
+        return false;
+      op.handler = is_subtract ? SIZED_HANDLER(Subq, size)
+                               : SIZED_HANDLER(Addq, size);
+      // Read-modify-write costs another memory access
+      if (ea_mode != 0)
+        cycles_ += size == 4 ? 8 : 4;
+      return DecodeOperand(ea_mode, ea_reg, size, op.dst);
+    }
+
+    // Bcc/BRA/BSR
+    case 0x6: {
+      uint32_t displacement = opcode & 0xFF;
+      if (displacement == 0) {
+        if (!Next16(displacement))
+          return false;
+        displacement = SignExtend<uint16_t>(displacement);
+      } else if (displacement == 0xFF) {
+        if (!Next32(displacement))
+          return false;
+      } else {
+        displacement = SignExtend<uint8_t>(displacement);
+      }
+      const uint8_t condition = (opcode >> 8) & 0xF;
+      op.handler = condition == 1 ? &Bsr : &Bcc;
+      op.condition = condition;
+      op.dst.value = pc + 2 + displacement;
+      cycles_ += 6;
+      ends_block = true;
+      return true;
+    }
+
+    // MOVEQ
+    case 0x7: {
+      if (opcode & 0x100)
+        return false;
+      op.handler = &Moveq;
+      op.src = Operand{Mode::kImmediate, 0,
+                       static_cast<uint32_t>(SignExtend<uint8_t>(opcode))};
+      return true;
+    }
+
+    // OR/AND/SUB/CMP/ADD (and their address register forms)
+    case 0x8:
+    case 0x9:
+    case 0xB:
+    case 0xC:
+    case 0xD: {
+      const uint8_t family = opcode >> 12;
+      const uint8_t opmode = (opcode >> 6) & 7;
+
+      // ADDA/SUBA/CMPA
+      if (opmode == 3 || opmode == 7) {
+        if (family != 0x9 && family != 0xB && family != 0xD)
+          return false;  // MULU/MULS/DIVU/DIVS
+        const int size = opmode == 3 ? 2 : 4;
+        op.dst = Operand{Mode::kAddressRegister, reg, 0};
+        op.handler = family == 0x9   ? (size == 2 ? &Suba<uint16_t> : &Suba<uint32_t>)
+                     : family == 0xB ? (size == 2 ? &Cmpa<uint16_t> : &Cmpa<uint32_t>)
+                                     : (size == 2 ? &Adda<uint16_t> : &Adda<uint32_t>);
+        return DecodeOperand(ea_mode, ea_reg, size, op.src);
+      }
+
+      const int size = 1 << (opmode & 3);
+      // <ea>,Dn
+      if (opmode < 3) {
+        // OR/AND never take an address register source (and byte sized
+        // SUB/CMP/ADD can't either)
+        if (ea_mode == 1 && (size == 1 || family == 0x8 || family == 0xC))
+          return false;
+        switch (family) {
+          case 0x8:
+            op.handler = SIZED_HANDLER(OrToRegister, size);
+            break;
+          case 0x9:
+            op.handler = SIZED_HANDLER(SubtractFromRegister, size);
+            break;
+          case 0xB:
+            op.handler = SIZED_HANDLER(Cmp, size);
+            break;
+          case 0xC:
+            op.handler = SIZED_HANDLER(AndToRegister, size);
+            break;
+          default:
+            op.handler = SIZED_HANDLER(AddToRegister, size);
+            break;
+        }
+        return DecodeOperand(ea_mode, ea_reg, size, op.src);
+      }
+
+      // Dn,<ea> (register destinations are ADDX/SUBX/SBCD/ABCD/EXG/CMPM and
+      // EOR is not handled)
+      if (family == 0xB || !IsMemoryAlterable(ea_mode, ea_reg))
+        return false;
+      op.src = Operand{Mode::kDataRegister, reg, 0};
+      switch (family) {
+        case 0x8:
+          op.handler = SIZED_HANDLER(OrToMemory, size);
+          break;
+        case 0x9:
+          op.handler = SIZED_HANDLER(SubtractFromMemory, size);
+          break;
+        case 0xC:
+          op.handler = SIZED_HANDLER(AndToMemory, size);
+          break;
+        default:
+          op.handler = SIZED_HANDLER(AddToMemory, size);
+          break;
+      }
+      cycles_ += size == 4 ? 8 : 4;
+      return DecodeOperand(ea_mode, ea_reg, size, op.dst);
+    }
+
+    // LSL/LSR/ASR #imm,Dn
+    case 0xE: {
+      const int size = SizeFromField(opcode);
+      // Only immediate counts (bit 5 clear) with Dn (i.e. not memory shifts)
+      if (size == 0 || (opcode & 0x20))
+        return false;
+      const bool is_left = opcode & 0x100;
+      const uint8_t type = (opcode >> 3) & 3;
+      op.src = Operand{Mode::kImmediate, 0, reg == 0 ? 8u : reg};
+      op.dst.reg = ea_reg;
+      cycles_ += 2 + 2 * op.src.value;
+      if (type == 1) {
+        op.handler = is_left ? SIZED_HANDLER(LslImmediate, size)
+                             : SIZED_HANDLER(LsrImmediate, size);
+        return true;
+      }
+      if (type == 0 && !is_left) {
+        op.handler = SIZED_HANDLER(AsrImmediate, size);
+        return true;
+      }
+      return false;  // ASL (V is set from every bit shifted) and rotates
+    }
+
+    default:
+      return false;
+  }
+}
+
+#undef SIZED_HANDLER
+
+void LoadState() {
+  for (int i = 0; i < 8; ++i) {
+    cpu.d[i] = m68k_get_reg(NULL, kDataRegisters[i]);
+    cpu.a[i] = m68k_get_reg(NULL, kAddressRegisters[i]);
+  }
+  cpu.pc = m68k_get_reg(NULL, M68K_REG_PC);
+  cpu.sr = m68k_get_reg(NULL, M68K_REG_SR);
+}
+
+void StoreState() {
+  for (int i = 0; i < 8; ++i) {
+    m68k_set_reg(kDataRegisters[i], cpu.d[i]);
+    m68k_set_reg(kAddressRegisters[i], cpu.a[i]);
+  }
+  // Only the CCR is changed by cached blocks so the stack pointer in use can
+  // not change when the SR is restored.
+  m68k_set_reg(M68K_REG_SR, cpu.sr);
+  m68k_set_reg(M68K_REG_PC, cpu.pc);
+}
+
+}  // namespace
+
+struct BlockCache::Block {
+  uint32_t start;
+  // The address following the last instruction in the block.
+  uint32_t end;
+  // The approximate number of cycles to run the whole block.
+  int cycles = 0;
+  std::vector<Op> ops;
+};
+
+// static
+BlockCache& BlockCache::Instance() {
+  return Machine::Current().Get<BlockCache>();
+}
+
+BlockCache::BlockCache() {
+  memory::AddCodeWriteListener(
+      [this](uint32_t start, uint32_t end) { Invalidate(start, end); });
+}
+
+BlockCache::~BlockCache() = default;
+
+void BlockCache::AddCodeRange(uint32_t start, uint32_t end) {
+  Invalidate(start, end);
+
+  // Merge with any overlapping or adjacent ranges
+  auto it = code_ranges_.upper_bound(start);
+  if (it != code_ranges_.begin() && std::prev(it)->second >= start) {
+    --it;
+    start = it->first;
+    end = std::max(end, it->second);
+    it = code_ranges_.erase(it);
+  }
+  while (it != code_ranges_.end() && it->first <= end) {
+    end = std::max(end, it->second);
+    it = code_ranges_.erase(it);
+  }
+  code_ranges_[start] = end;
+  memory::MarkCodePages(start, end);
+}
+
+void BlockCache::Invalidate(uint32_t start, uint32_t end) {
+  // Blocks are at most `kMaxBlockSize` bytes so any block overlapping `start`
+  // must begin within that distance before it.
+  auto it = blocks_.lower_bound(start > kMaxBlockSize ? start - kMaxBlockSize
+                                                      : 0);
+  while (it != blocks_.end() && it->first < end) {
+    if (it->second->end <= start) {
+      ++it;
+      continue;
+    }
+    LOG_BLOCK(INFO) << "Invalidate block at 0x" << std::hex << it->first;
+    if (is_executing_) {
+      // The running block may have just been overwritten so stop it after the
+      // current instruction and keep it alive until `Execute()` returns.
+      retired_blocks_.push_back(std::move(it->second));
+      cpu.end_block = true;
+      was_invalidated_ = true;
+    }
+    it = blocks_.erase(it);
+  }
+}
+
+void BlockCache::Reset() {
+  CHECK(!is_executing_);
+  blocks_.clear();
+  code_ranges_.clear();
+  memory::ClearCodePages();
+}
+
+const BlockCache::Block* BlockCache::Lookup(uint32_t pc) {
+  auto it = blocks_.find(pc);
+  if (it != blocks_.end())
+    return it->second->ops.empty() ? nullptr : it->second.get();
+
+  auto range = code_ranges_.upper_bound(pc);
+  if ((pc & 1) || range == code_ranges_.begin())
+    return nullptr;
+  const uint32_t limit = (--range)->second;
+  if (pc >= limit)
+    return nullptr;
+
+  auto block = std::make_unique<Block>();
+  block->start = pc;
+  while (block->ops.size() < kMaxBlockInstructions && pc < limit) {
+    Decoder decoder(pc);
+    Op op{};
+    bool ends_block;
+    if (!decoder.Decode(op, ends_block) || decoder.pc() > limit)
+      break;
+    op.next_pc = pc = decoder.pc();
+    block->cycles += decoder.cycles();
+    block->ops.push_back(op);
+    if (ends_block)
+      break;
+  }
+  // Blocks which could not be decoded still cover the opcode which stopped
+  // them so they are invalidated if it is replaced.
+  block->end = std::max(pc, block->start + 2);
+  // Normally already marked when the segment was loaded but this is the first
+  // time the PC has executed here so make sure stores to it are noticed.
+  memory::MarkCodePages(block->start, block->end);
+
+  LOG_BLOCK(INFO) << "Decoded block at 0x" << std::hex << block->start
+                  << " to 0x" << block->end << " with " << std::dec
+                  << block->ops.size() << " instructions";
+
+  const Block* result = block->ops.empty() ? nullptr : block.get();
+  blocks_[block->start] = std::move(block);
+  return result;
+}
+
+int BlockCache::Execute(int cycles) {
+  const Block* block = Lookup(m68k_get_reg(NULL, M68K_REG_PC));
+  if (block == nullptr)
+    return 0;
+
+  LoadState();
+  is_executing_ = true;
+  int elapsed = 0;
+  while (block != nullptr) {
+    cpu.end_block = false;
+    const Op* op = block->ops.data();
+    const Op* const end = op + block->ops.size();
+    while (op != end) {
+      cpu.pc = op->next_pc;
+      op->handler(*op);
+      ++op;
+      if (cpu.end_block)
+        break;
+    }
+    instructions_run_ += op - block->ops.data();
+    elapsed += block->cycles;
+    if (elapsed >= cycles)
+      break;
+
+    // Tight loops branch back to the start of the same block
+    if (was_invalidated_ || block->start != cpu.pc) {
+      was_invalidated_ = false;
+      block = Lookup(cpu.pc);
+    }
+  }
+  is_executing_ = false;
+  was_invalidated_ = false;
+  retired_blocks_.clear();
+  StoreState();
+  return elapsed;
+}
+
+void BlockCache::SaveState(core::SnapshotWriter& writer) const {
+  writer.Write<uint32_t>(code_ranges_.size());
+  for (const auto& [start, end] : code_ranges_) {
+    writer.Write<uint32_t>(start);
+    writer.Write<uint32_t>(end);
+  }
+}
+
+absl::Status BlockCache::RestoreState(core::SnapshotReader& reader) {
+  Reset();
+  auto count = TRY(reader.Read<uint32_t>());
+  for (uint32_t i = 0; i < count; ++i) {
+    auto start = TRY(reader.Read<uint32_t>());
+    auto end = TRY(reader.Read<uint32_t>());
+    AddCodeRange(start, end);
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace cyder
@@ -0,0 +1,73 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "core/snapshot.h"
+
+namespace cyder {
+
+// Caches straight-line runs of 68k instructions ("blocks") from loaded 'CODE'
+// segments as arrays of pre-decoded handlers so hot code is not re-fetched and
+// re-decoded on every pass. Only a common subset of the instruction set can be
+// cached: a block ends before the first instruction it can not handle and
+// Musashi is expected to run that instruction instead.
+class BlockCache {
+ public:
+  static BlockCache& Instance();
+
+  BlockCache();
+  ~BlockCache();
+
+  // Marks [start, end) as emulated code which may be cached. Any blocks
+  // previously cached within the range are dropped.
+  void AddCodeRange(uint32_t start, uint32_t end);
+
+  // Drops every cached block which overlaps [start, end). Writes to code pages
+  // (see `memory::CheckCodeWrite()`) are forwarded here automatically.
+  void Invalidate(uint32_t start, uint32_t end);
+
+  // Drops every cached block, code range and marked code page.
+  void Reset();
+
+  // Runs cached blocks starting from Musashi's PC until reaching code which can
+  // not be cached or until at least `cycles` (approximately) have elapsed.
+  // Registers are synchronized with Musashi before returning. Returns the
+  // number of cycles run which is 0 if no block could be run at the PC.
+  int Execute(int cycles);
+
+  size_t block_count() const { return blocks_.size(); }
+  // The number of instructions run from cached blocks.
+  uint64_t instructions_run() const { return instructions_run_; }
+
+  // Saves/restores the code ranges. Blocks are not saved and are decoded again
+  // after restoring.
+  void SaveState(core::SnapshotWriter& writer) const;
+  absl::Status RestoreState(core::SnapshotReader& reader);
+
+ private:
+  struct Block;
+
+  // Returns the block starting at `pc` (decoding it if needed) or nullptr if
+  // the instruction at `pc` can not be cached.
+  const Block* Lookup(uint32_t pc);
+
+  // Maps the start of each code range to its end.
+  std::map<uint32_t, uint32_t> code_ranges_;
+  // Maps the start of each block to the block. Blocks for PCs which can not be
+  // cached are kept (with no instructions) so they are only decoded once.
+  std::map<uint32_t, std::unique_ptr<Block>> blocks_;
+  // Blocks invalidated while running which are freed once `Execute()` ends.
+  std::vector<std::unique_ptr<Block>> retired_blocks_;
+  bool is_executing_ = false;
+  bool was_invalidated_ = false;
+  uint64_t instructions_run_ = 0;
+};
+
+}  // namespace cyder
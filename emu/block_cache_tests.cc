@@ -0,0 +1,158 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/block_cache.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <initializer_list>
+
+#include "core/status_helpers.h"
+#include "emu/emulator.h"
+#include "emu/memory/memory_map.h"
+#include "third_party/musashi/src/m68k.h"
+
+namespace cyder {
+namespace {
+
+constexpr uint32_t kCodeStart = 0x3000;
+constexpr uint16_t kIllegal = 0x4AFC;
+
+class BlockCacheTests : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    BlockCache::Instance().Reset();
+    Emulator::Instance().Init(kCodeStart);
+  }
+
+  // Writes `code` at `kCodeStart` and marks it as a code range.
+  void LoadCode(std::initializer_list<uint16_t> code) {
+    uint32_t address = kCodeStart;
+    for (uint16_t word : code) {
+      CHECK_OK(memory::kSystemMemory.Write<uint16_t>(address, word));
+      address += sizeof(uint16_t);
+    }
+    BlockCache::Instance().AddCodeRange(kCodeStart, address);
+  }
+};
+
+TEST_F(BlockCacheTests, RunsLoop) {
+  LoadCode({
+      0x7000,          // MOVEQ #0,D0
+      0x7209,          // MOVEQ #9,D1
+      0x5480,          // ADDQ.L #2,D0
+      0x51C9, 0xFFFC,  // DBF D1,*-2
+      kIllegal,
+  });
+
+  EXPECT_GT(BlockCache::Instance().Execute(1000000), 0);
+
+  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_PC), kCodeStart + 10);
+  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_D0), 20);
+  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_D1) & 0xFFFF, 0xFFFF);
+}
+
+TEST_F(BlockCacheTests, CountsInstructions) {
+  LoadCode({
+      0x7000,          // MOVEQ #0,D0
+      0x7209,          // MOVEQ #9,D1
+      0x5480,          // ADDQ.L #2,D0
+      0x51C9, 0xFFFC,  // DBF D1,*-2
+      kIllegal,
+  });
+  const uint64_t instructions_run = BlockCache::Instance().instructions_run();
+
+  BlockCache::Instance().Execute(1000000);
+
+  // Both MOVEQs then 10 passes through the loop
+  EXPECT_EQ(BlockCache::Instance().instructions_run() - instructions_run, 22);
+}
+
+TEST_F(BlockCacheTests, AccessesMemory) {
+  LoadCode({
+      0x41F8, 0x4000,          // LEA $4000.W,A0
+      0x20FC, 0x1234, 0x5678,  // MOVE.L #$12345678,(A0)+
+      0x3220,                  // MOVE.W -(A0),D1
+      0xB27C, 0x5678,          // CMP.W #$5678,D1
+      kIllegal,
+  });
+
+  BlockCache::Instance().Execute(1000000);
+
+  EXPECT_EQ(MUST(memory::kSystemMemory.Read<uint32_t>(0x4000)), 0x12345678);
+  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_A0), 0x4002);
+  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_D1) & 0xFFFF, 0x5678);
+  EXPECT_TRUE(m68k_get_reg(NULL, M68K_REG_SR) & 0x4);  // Z is set
+}
+
+TEST_F(BlockCacheTests, CallsSubroutine) {
+  LoadCode({
+      0x6104,    // BSR.S *+6
+      kIllegal,  //
+      0x4E71,    // NOP
+      0x7042,    // MOVEQ #$42,D0
+      0x4E75,    // RTS
+  });
+  m68k_set_reg(M68K_REG_SP, memory::StackStart());
+
+  BlockCache::Instance().Execute(1000000);
+
+  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_PC), kCodeStart + 2);
+  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_D0), 0x42);
+  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_SP), memory::StackStart());
+}
+
+TEST_F(BlockCacheTests, InvalidatesOnWrite) {
+  LoadCode({
+      0x7005,  // MOVEQ #5,D0
+      kIllegal,
+  });
+
+  BlockCache::Instance().Execute(1000000);
+  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_D0), 5);
+
+  // Emulated stores go through the same path as Musashi's
+  m68k_write_memory_16(kCodeStart, 0x7007);  // MOVEQ #7,D0
+  m68k_set_reg(M68K_REG_PC, kCodeStart);
+
+  BlockCache::Instance().Execute(1000000);
+  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_D0), 7);
+}
+
+TEST_F(BlockCacheTests, SkipsUncachedCode) {
+  LoadCode({kIllegal});
+
+  // Unsupported instruction
+  EXPECT_EQ(BlockCache::Instance().Execute(1000000), 0);
+
+  // Outside of any code range
+  m68k_set_reg(M68K_REG_PC, kCodeStart + 0x100);
+  EXPECT_EQ(BlockCache::Instance().Execute(1000000), 0);
+}
+
+TEST_F(BlockCacheTests, SkipsAddressRegisterSourceForOrAnd) {
+  // OR/AND with an An source are illegal at every size
+  for (uint16_t opcode : {0x8048,    // OR.W A0,D0
+                          0x8088,    // OR.L A0,D0
+                          0xC048,    // AND.W A0,D0
+                          0xC088}) {  // AND.L A0,D0
+    BlockCache::Instance().Reset();
+    LoadCode({opcode, kIllegal});
+    m68k_set_reg(M68K_REG_PC, kCodeStart);
+    EXPECT_EQ(BlockCache::Instance().Execute(1000000), 0) << std::hex << opcode;
+  }
+
+  // ADD.W A0,D0 is legal
+  BlockCache::Instance().Reset();
+  LoadCode({0xD048, kIllegal});
+  m68k_set_reg(M68K_REG_PC, kCodeStart);
+  m68k_set_reg(M68K_REG_D0, 1);
+  m68k_set_reg(M68K_REG_A0, 2);
+  EXPECT_GT(BlockCache::Instance().Execute(1000000), 0);
+  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_D0), 3);
+}
+
+}  // namespace
+}  // namespace cyder
@@ -1,16 +1,26 @@
 #include "emu/debug/debug_manager.h"
 
+#include <algorithm>
 #include <cstddef>
 #include <iostream>
+#include <iterator>
 #include <string>
+#include <utility>
 #include <vector>
 
-#include "absl/base/no_destructor.h"
 #include "core/logging.h"
+#include "emu/machine.h"
 
 namespace cyder {
 namespace {
 
+// The most writes batched before they are merged into the untagged spans.
+constexpr size_t kMaxPendingWrites = 1 << 16;
+
+// Tags are batched until there are at least this many (or as many as have
+// already been sorted) so that each is only re-sorted O(log n) times.
+constexpr size_t kMinPendingTags = 64;
+
 class DebugManagerImpl : public DebugManager {
  public:
   DebugManagerImpl() = default;
@@ -24,50 +34,63 @@ class DebugManagerImpl : public DebugManager {
   DebugManagerImpl& operator=(DebugManagerImpl&&) = delete;
 
   void TagMemory(size_t start, size_t end, const std::string& tag) override {
-    for (const auto& span : memory_tags_) {
-      if (span == MemorySpan{start, end, tag}) {
-        // If the exact span already exists, do nothing.
-        return;
-      }
-    }
-    memory_tags_.push_back({start, end, tag});
-    std::sort(memory_tags_.begin(), memory_tags_.end());
+    // Typegen re-tags a struct each time it is written so repeats are common
+    MemorySpan span{start, end, tag};
+    if (!pending_tags_.empty() && pending_tags_.back() == span)
+      return;
+    pending_tags_.push_back(std::move(span));
+    if (pending_tags_.size() >= std::max(kMinPendingTags, tags_.size()))
+      MergePendingTags();
   }
 
   void RecordWrite(size_t start, size_t end) override {
-    std::vector<MemorySpan> new_memory_tags;
-
-    MemorySpan new_span{start, end, ""};
-    for (auto it = memory_tags_.begin(); it != memory_tags_.end(); ++it) {
-      const MemorySpan& span = *it;
-      if (!span.tag.empty()) {
-        new_memory_tags.push_back(span);
-        continue;
-      }
-
-      if (span.end < new_span.start || span.start > new_span.end) {
-        new_memory_tags.push_back(span);
-        continue;  // No overlap
+    // Runs of stores (i.e. filling a struct) collapse into a single write
+    if (!pending_writes_.empty()) {
+      PendingWrite& last = pending_writes_.back();
+      if (!(last.end < start || last.start > end)) {
+        last.start = std::min(last.start, start);
+        last.end = std::max(last.end, end);
+        ++last.count;
+        return;
       }
-
-      new_span.start = std::min(new_span.start, span.start);
-      new_span.end = std::max(new_span.end, span.end);
-      new_span.writes += span.writes + 1;  // Increment write count
     }
+    pending_writes_.push_back({start, end, 1});
+    if (pending_writes_.size() >= kMaxPendingWrites)
+      MergePendingWrites();
+  }
 
-    new_memory_tags.push_back(new_span);
-
-    memory_tags_ = std::move(new_memory_tags);
-    std::sort(memory_tags_.begin(), memory_tags_.end());
+  void SetWriteReporter(std::function<void()> reporter) override {
+    write_reporter_ = std::move(reporter);
   }
 
   std::vector<MemorySpan> GetMemoryTags() const override {
-    return memory_tags_;
+    Update();
+    std::vector<MemorySpan> memory_tags;
+    memory_tags.reserve(tags_.size() + write_spans_.size());
+    std::merge(tags_.begin(), tags_.end(), write_spans_.begin(),
+               write_spans_.end(), std::back_inserter(memory_tags));
+    return memory_tags;
+  }
+
+  std::vector<MemorySpan> GetMemoryTagsAt(size_t address) const override {
+    Update();
+    return FindMemoryTagsAt(address);
+  }
+
+  std::vector<std::vector<MemorySpan>> GetMemoryTagsAtEach(
+      const std::vector<size_t>& addresses) const override {
+    Update();
+    std::vector<std::vector<MemorySpan>> memory_tags;
+    memory_tags.reserve(addresses.size());
+    for (size_t address : addresses)
+      memory_tags.push_back(FindMemoryTagsAt(address));
+    return memory_tags;
   }
 
   void PrintMemoryMap() const override {
+    const std::vector<MemorySpan> memory_tags = GetMemoryTags();
     std::vector<MemorySpan> depth;
-    for (const auto& tag : memory_tags_) {
+    for (const auto& tag : memory_tags) {
       while (!depth.empty() && tag.start >= depth.back().end)
         depth.pop_back();
 
@@ -82,20 +105,149 @@ class DebugManagerImpl : public DebugManager {
                 << "), Tag: \"" << tag.tag << "\", Writes: " << std::dec
                 << tag.writes << "\n";
     }
-    std::cout << std::dec << "Tracking " << memory_tags_.size() << " spans";
+    std::cout << std::dec << "Tracking " << memory_tags.size() << " spans";
   }
 
-  void Clear() override { memory_tags_.clear(); }
+  void Clear() override {
+    tags_.clear();
+    max_end_.clear();
+    pending_tags_.clear();
+    write_spans_.clear();
+    pending_writes_.clear();
+  }
 
  private:
-  std::vector<MemorySpan> memory_tags_;
+  struct PendingWrite {
+    size_t start;
+    size_t end;
+    size_t count;
+  };
+
+  void Update() const {
+    if (write_reporter_)
+      write_reporter_();
+    MergePendingWrites();
+    MergePendingTags();
+  }
+
+  // Returns the (tagged and untagged) spans containing `address` in order.
+  std::vector<MemorySpan> FindMemoryTagsAt(size_t address) const {
+    std::vector<MemorySpan> memory_tags;
+    FindTagsAt(address, 0, tags_.size(), memory_tags);
+
+    // Untagged spans never overlap so at most one contains `address`
+    auto write = std::upper_bound(
+        write_spans_.begin(), write_spans_.end(), address,
+        [](size_t address, const MemorySpan& span) {
+          return address < span.start;
+        });
+    if (write != write_spans_.begin() && address < std::prev(write)->end) {
+      memory_tags.insert(
+          std::upper_bound(memory_tags.begin(), memory_tags.end(),
+                           *std::prev(write)),
+          *std::prev(write));
+    }
+    return memory_tags;
+  }
+
+  // Sorts the pending tags into `tags_` (dropping duplicates) and rebuilds
+  // `max_end_` for the new spans.
+  void MergePendingTags() const {
+    if (pending_tags_.empty())
+      return;
+
+    std::sort(pending_tags_.begin(), pending_tags_.end());
+    const size_t first_changed =
+        std::lower_bound(tags_.begin(), tags_.end(), pending_tags_.front()) -
+        tags_.begin();
+    const size_t sorted_size = tags_.size();
+    tags_.insert(tags_.end(), std::make_move_iterator(pending_tags_.begin()),
+                 std::make_move_iterator(pending_tags_.end()));
+    pending_tags_.clear();
+    std::inplace_merge(tags_.begin() + first_changed,
+                       tags_.begin() + sorted_size, tags_.end());
+    tags_.erase(std::unique(tags_.begin() + first_changed, tags_.end()),
+                tags_.end());
+
+    max_end_.resize(tags_.size());
+    BuildMaxEnd(0, tags_.size());
+  }
+
+  // `tags_[lo, hi)` is treated as a balanced tree rooted at the middle span.
+  // Fills in the largest end within each subtree and returns it for this one.
+  size_t BuildMaxEnd(size_t lo, size_t hi) const {
+    if (lo >= hi)
+      return 0;
+    const size_t mid = lo + (hi - lo) / 2;
+    max_end_[mid] = std::max(
+        {tags_[mid].end, BuildMaxEnd(lo, mid), BuildMaxEnd(mid + 1, hi)});
+    return max_end_[mid];
+  }
+
+  // Appends the spans in `tags_[lo, hi)` containing `address` (in order),
+  // skipping subtrees which end before it or start after it.
+  void FindTagsAt(size_t address,
+                  size_t lo,
+                  size_t hi,
+                  std::vector<MemorySpan>& spans) const {
+    if (lo >= hi)
+      return;
+    const size_t mid = lo + (hi - lo) / 2;
+    if (max_end_[mid] <= address)
+      return;
+    FindTagsAt(address, lo, mid, spans);
+    if (tags_[mid].start > address)
+      return;
+    if (address < tags_[mid].end)
+      spans.push_back(tags_[mid]);
+    FindTagsAt(address, mid + 1, hi, spans);
+  }
+
+  // Merges overlapping (or adjacent) writes along with the untagged spans they
+  // touch. An untagged span counts one less write than it was merged from.
+  void MergePendingWrites() const {
+    if (pending_writes_.empty())
+      return;
+
+    std::vector<PendingWrite> writes = std::move(pending_writes_);
+    pending_writes_.clear();
+    for (const auto& span : write_spans_)
+      writes.push_back({span.start, span.end, span.writes + 1});
+    std::sort(writes.begin(), writes.end(),
+              [](const PendingWrite& lhs, const PendingWrite& rhs) {
+                return lhs.start < rhs.start;
+              });
+
+    write_spans_.clear();
+    PendingWrite current = writes.front();
+    for (auto it = writes.begin() + 1; it != writes.end(); ++it) {
+      if (it->start <= current.end) {
+        current.end = std::max(current.end, it->end);
+        current.count += it->count;
+        continue;
+      }
+      write_spans_.push_back(
+          {current.start, current.end, "", current.count - 1});
+      current = *it;
+    }
+    write_spans_.push_back({current.start, current.end, "", current.count - 1});
+  }
+
+  // Tagged spans sorted by `MemorySpan::operator<` and the largest end within
+  // each subtree of the implicit interval tree over them (see `BuildMaxEnd`).
+  // These, and the untagged (disjoint) spans, are updated lazily.
+  mutable std::vector<MemorySpan> tags_;
+  mutable std::vector<size_t> max_end_;
+  mutable std::vector<MemorySpan> pending_tags_;
+  mutable std::vector<MemorySpan> write_spans_;
+  mutable std::vector<PendingWrite> pending_writes_;
+  std::function<void()> write_reporter_;
 };
 
 }  // namespace
 
 DebugManager& DebugManager::Instance() {
-  static absl::NoDestructor<DebugManagerImpl> instance;
-  return *instance;
+  return Machine::Current().Get<DebugManagerImpl>();
 }
 
 std::ostream& operator<<(std::ostream& os, const MemorySpan& span) {
@@ -2,6 +2,7 @@
 
 #include <cstddef>
 #include <deque>
+#include <functional>
 #include <ostream>
 #include <string>
 #include <vector>
@@ -35,14 +36,29 @@ class DebugManager {
 
   virtual ~DebugManager() = default;
 
+  // Writes are batched and only merged into the untagged spans when the memory
+  // tags are next read.
   virtual void RecordWrite(size_t start, size_t end) = 0;
 
+  // Sets a function called before the memory tags are read which reports any
+  // writes tracked elsewhere (i.e. by page) through `RecordWrite()`.
+  virtual void SetWriteReporter(std::function<void()> reporter) = 0;
+
   virtual void TagMemory(size_t address,
                          size_t size,
                          const std::string& tag) = 0;
 
+  // Returns every span sorted by `MemorySpan::operator<`.
   virtual std::vector<MemorySpan> GetMemoryTags() const = 0;
 
+  // Returns the spans which contain `address` (in the same order).
+  virtual std::vector<MemorySpan> GetMemoryTagsAt(size_t address) const = 0;
+
+  // Returns the spans which contain each of `addresses` while only reporting
+  // and merging the pending writes once (i.e. for every frame of a stack).
+  virtual std::vector<std::vector<MemorySpan>> GetMemoryTagsAtEach(
+      const std::vector<size_t>& addresses) const = 0;
+
   virtual void PrintMemoryMap() const = 0;
 
   virtual void Clear() = 0;
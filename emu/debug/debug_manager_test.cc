@@ -4,6 +4,10 @@
 #include <gmock/gmock-matchers.h>
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <string>
+#include <vector>
+
 #include "emu/debug/debug_manager.h"
 
 namespace cyder {
@@ -169,5 +173,117 @@ TEST(DebugManagerTests, OrderPrint2) {
   debug_manager.PrintMemoryMap();
 }
 
+TEST(DebugManagerTests, MergesBatchedWrites) {
+  DebugManager& debug_manager = DebugManager::Instance();
+  debug_manager.Clear();
+
+  debug_manager.RecordWrite(0x0, 0x10);
+  debug_manager.RecordWrite(0x14, 0x20);
+  debug_manager.TagMemory(0x40, 0x50, "Rect");
+  debug_manager.RecordWrite(0x08, 0x16);
+  debug_manager.RecordWrite(0x100, 0x116);
+
+  auto write_count = [](size_t writes) {
+    return testing::Field(&MemorySpan::writes, writes);
+  };
+  EXPECT_THAT(
+      debug_manager.GetMemoryTags(),
+      testing::ElementsAre(
+          testing::AllOf(testing::Eq(MemorySpan{0x0, 0x20, ""}),
+                         write_count(2)),
+          testing::Eq(MemorySpan{0x40, 0x50, "Rect"}),
+          testing::AllOf(testing::Eq(MemorySpan{0x100, 0x116, ""}),
+                         write_count(0))));
+
+  // Writes touching an existing span are merged into it
+  debug_manager.RecordWrite(0x20, 0x24);
+  EXPECT_THAT(debug_manager.GetMemoryTags(),
+              testing::Contains(testing::AllOf(
+                  testing::Eq(MemorySpan{0x0, 0x24, ""}), write_count(3))));
+}
+
+TEST(DebugManagerTests, TagsAreSortedWithoutDuplicates) {
+  DebugManager& debug_manager = DebugManager::Instance();
+  debug_manager.Clear();
+
+  // Enough tags (with repeats) to be merged in several batches
+  std::vector<MemorySpan> expected;
+  for (size_t i = 0; i < 500; ++i) {
+    const size_t start = (i * 7919) % 1000;
+    const MemorySpan span{start, start + 1 + i % 13,
+                          "Tag" + std::to_string(i % 3)};
+    debug_manager.TagMemory(span.start, span.end, span.tag);
+    debug_manager.TagMemory(span.start, span.end, span.tag);
+    if (i % 5 == 0)
+      debug_manager.TagMemory(0x10, 0x20, "Repeated");
+    expected.push_back(span);
+  }
+  expected.push_back({0x10, 0x20, "Repeated"});
+  std::sort(expected.begin(), expected.end());
+  expected.erase(std::unique(expected.begin(), expected.end()),
+                 expected.end());
+
+  EXPECT_THAT(debug_manager.GetMemoryTags(),
+              testing::ElementsAreArray(expected));
+}
+
+TEST(DebugManagerTests, GetMemoryTagsAt) {
+  DebugManager& debug_manager = DebugManager::Instance();
+  debug_manager.Clear();
+
+  debug_manager.TagMemory(0x1000, 0x2000, "CODE1");
+  debug_manager.TagMemory(0x1100, 0x1110, "Rect");
+  debug_manager.TagMemory(0x1200, 0x1208, "Point");
+  debug_manager.TagMemory(0x3000, 0x3010, "Pattern");
+  debug_manager.RecordWrite(0x1204, 0x1210);
+
+  EXPECT_THAT(debug_manager.GetMemoryTagsAt(0x1204),
+              testing::ElementsAre(MemorySpan{0x1000, 0x2000, "CODE1"},
+                                   MemorySpan{0x1200, 0x1208, "Point"},
+                                   MemorySpan{0x1204, 0x1210, ""}));
+  EXPECT_THAT(debug_manager.GetMemoryTagsAt(0x1108),
+              testing::ElementsAre(MemorySpan{0x1000, 0x2000, "CODE1"},
+                                   MemorySpan{0x1100, 0x1110, "Rect"}));
+  EXPECT_THAT(debug_manager.GetMemoryTagsAt(0x2000), testing::ElementsAre());
+  EXPECT_THAT(debug_manager.GetMemoryTagsAt(0x300F),
+              testing::ElementsAre(MemorySpan{0x3000, 0x3010, "Pattern"}));
+}
+
+TEST(DebugManagerTests, ReportsWritesBeforeReadingTags) {
+  DebugManager& debug_manager = DebugManager::Instance();
+  debug_manager.Clear();
+
+  int reports = 0;
+  debug_manager.SetWriteReporter([&]() {
+    ++reports;
+    DebugManager::Instance().RecordWrite(0x200, 0x210);
+  });
+  EXPECT_THAT(debug_manager.GetMemoryTags(),
+              testing::ElementsAre(MemorySpan{0x200, 0x210, ""}));
+  EXPECT_EQ(reports, 1);
+  debug_manager.SetWriteReporter(nullptr);
+}
+
+TEST(DebugManagerTests, GetMemoryTagsAtEachReportsWritesOnce) {
+  DebugManager& debug_manager = DebugManager::Instance();
+  debug_manager.Clear();
+
+  debug_manager.TagMemory(0x1000, 0x2000, "CODE1");
+  int reports = 0;
+  debug_manager.SetWriteReporter([&]() {
+    ++reports;
+    DebugManager::Instance().RecordWrite(0x1204, 0x1210);
+  });
+  EXPECT_THAT(
+      debug_manager.GetMemoryTagsAtEach({0x1204, 0x2000, 0x1000}),
+      testing::ElementsAre(
+          testing::ElementsAre(MemorySpan{0x1000, 0x2000, "CODE1"},
+                               MemorySpan{0x1204, 0x1210, ""}),
+          testing::ElementsAre(),
+          testing::ElementsAre(MemorySpan{0x1000, 0x2000, "CODE1"})));
+  EXPECT_EQ(reports, 1);
+  debug_manager.SetWriteReporter(nullptr);
+}
+
 }  // namespace
 }  // namespace cyder
@@ -4,12 +4,13 @@
 #include <iostream>
 #include <regex>
 
-#include "absl/base/no_destructor.h"
 #include "core/memory_reader.h"
 #include "core/status_helpers.h"
 #include "emu/debug/debug_manager.h"
+#include "emu/debug/stats.h"
 #include "emu/event_manager.tdef.h"
 #include "emu/graphics/grafport_types.tdef.h"
+#include "emu/machine.h"
 #include "emu/memory/memory_map.h"
 #include "emu/window_manager.tdef.h"
 #include "third_party/musashi/src/m68k.h"
@@ -43,6 +44,16 @@ bool ReadTypePrompt(const std::string& line) {
   return true;
 }
 
+bool ReadStatsPrompt(const std::string& line) {
+  std::smatch match;
+  if (!std::regex_match(line, match, std::regex("stats (\\w+)")))
+    return false;
+
+  if (!DumpStats(std::cout, match[1]))
+    std::cout << "Unknown stats: " << match[1] << "\n";
+  return true;
+}
+
 bool ReadBreakTrapPrompt(const std::string& line,
                          std::vector<std::string>& trap_to_break_on) {
   std::smatch match;
@@ -82,8 +93,7 @@ bool ReadBreakEventPrompt(const std::string& line, uint16_t& break_event_mask) {
 
 // static
 Debugger& Debugger::Instance() {
-  static absl::NoDestructor<Debugger> s_instance;
-  return *s_instance;
+  return Machine::Current().Get<Debugger>();
 }
 
 void Debugger::Break() {
@@ -136,11 +146,17 @@ bool Debugger::Prompt() {
     return false;
   }
 
+  if (line == "stats") {
+    DumpStats(std::cout);
+    return false;
+  }
+
   if (line == "stack") {
     uint32_t stack_ptr = m68k_get_reg(NULL, M68K_REG_SP);
     std::cout << "\n"
               << cyder::memory::kSystemMemory.Create(
-                     "stack", stack_ptr, cyder::memory::kStackStart - stack_ptr)
+                     "stack", stack_ptr,
+                     cyder::memory::StackStart() - stack_ptr)
               << std::endl;
     return false;
   }
@@ -163,6 +179,9 @@ bool Debugger::Prompt() {
   if (ReadTypePrompt(line))
     return false;
 
+  if (ReadStatsPrompt(line))
+    return false;
+
   std::cerr << "Unknown command: '" << line << "'" << std::endl;
   return false;
 }
@@ -0,0 +1,320 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/debug/execution_stats.h"
+
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_format.h"
+#include "emu/debug/debug_manager.h"
+#include "emu/debug/profiler.h"
+#include "emu/machine.h"
+#include "emu/memory/memory_map.h"
+
+namespace cyder {
+namespace {
+
+constexpr size_t kOpcodeCount = 0x10000;
+
+// The number of branch targets printed.
+constexpr size_t kMaxBranchTargets = 20;
+
+const char* ClassifyMisc(uint16_t opcode) {
+  switch (opcode) {
+    case 0x4AFC:
+      return "ILLEGAL";
+    case 0x4E70:
+      return "RESET";
+    case 0x4E71:
+      return "NOP";
+    case 0x4E72:
+      return "STOP";
+    case 0x4E73:
+      return "RTE";
+    case 0x4E74:
+      return "RTD";
+    case 0x4E75:
+      return "RTS";
+    case 0x4E76:
+      return "TRAPV";
+    case 0x4E77:
+      return "RTR";
+  }
+  const bool is_register = ((opcode >> 3) & 7) == 0;
+  if ((opcode & 0xFFF0) == 0x4E40)
+    return "TRAP";
+  if ((opcode & 0xFFF8) == 0x4E50)
+    return "LINK";
+  if ((opcode & 0xFFF8) == 0x4E58)
+    return "UNLK";
+  if ((opcode & 0xFFF0) == 0x4E60)
+    return "MOVE USP";
+  if ((opcode & 0xFFC0) == 0x4E80)
+    return "JSR";
+  if ((opcode & 0xFFC0) == 0x4EC0)
+    return "JMP";
+  if ((opcode & 0xF1C0) == 0x41C0)
+    return "LEA";
+  if ((opcode & 0xF140) == 0x4100)
+    return "CHK";
+  if ((opcode & 0xFFC0) == 0x4800)
+    return "NBCD";
+  if ((opcode & 0xFFC0) == 0x4840)
+    return is_register ? "SWAP" : "PEA";
+  if ((opcode & 0xFB80) == 0x4880)
+    return is_register ? "EXT" : "MOVEM";
+  if ((opcode & 0xFF80) == 0x4C00)
+    return (opcode & 0x0040) ? "DIVL" : "MULL";
+
+  const bool is_size_3 = ((opcode >> 6) & 3) == 3;
+  switch (opcode & 0xFF00) {
+    case 0x4000:
+      return is_size_3 ? "MOVE from SR" : "NEGX";
+    case 0x4200:
+      return is_size_3 ? "MOVE from CCR" : "CLR";
+    case 0x4400:
+      return is_size_3 ? "MOVE to CCR" : "NEG";
+    case 0x4600:
+      return is_size_3 ? "MOVE to SR" : "NOT";
+    case 0x4A00:
+      return is_size_3 ? "TAS" : "TST";
+  }
+  return "MISC";
+}
+
+const char* ClassifyImmediate(uint16_t opcode) {
+  static constexpr const char* kBitOps[] = {"BTST", "BCHG", "BCLR", "BSET"};
+  if (opcode & 0x0100)
+    return ((opcode >> 3) & 7) == 1 ? "MOVEP" : kBitOps[(opcode >> 6) & 3];
+
+  static constexpr const char* kOps[] = {
+      "ORI", "ANDI", "SUBI", "ADDI", nullptr, "EORI", "CMPI", "MOVES"};
+  if (((opcode >> 9) & 7) == 4)
+    return kBitOps[(opcode >> 6) & 3];
+  return kOps[(opcode >> 9) & 7];
+}
+
+// Returns whether `opcode` may transfer control and, if it can fall through,
+// the length of the instruction (zero if it always transfers control).
+bool IsControlTransfer(uint16_t opcode, uint32_t& length) {
+  switch (opcode >> 12) {
+    case 0x4:
+      length = 0;
+      return (opcode & 0xFF80) == 0x4E80 /* JSR/JMP */ ||
+             opcode == 0x4E73 /* RTE */ || opcode == 0x4E74 /* RTD */ ||
+             opcode == 0x4E75 /* RTS */ || opcode == 0x4E77 /* RTR */;
+    case 0x5:
+      // DBcc always has a 16-bit displacement
+      length = 4;
+      return (opcode & 0x00F8) == 0x00C8;
+    case 0x6: {
+      const uint8_t displacement = opcode & 0xFF;
+      const uint8_t condition = (opcode >> 8) & 0xF;
+      if (condition <= 1 /* BRA/BSR */)
+        length = 0;
+      else
+        length = displacement == 0 ? 4 : displacement == 0xFF ? 6 : 2;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+const char* ClassifyOpcode(uint16_t opcode) {
+  const bool is_size_3 = ((opcode >> 6) & 3) == 3;
+  const bool is_bit_8 = opcode & 0x0100;
+  const bool is_address_dest = ((opcode >> 6) & 7) == 1;
+  switch (opcode >> 12) {
+    case 0x0:
+      return ClassifyImmediate(opcode);
+    case 0x1:
+      return "MOVE.B";
+    case 0x2:
+      return is_address_dest ? "MOVEA.L" : "MOVE.L";
+    case 0x3:
+      return is_address_dest ? "MOVEA.W" : "MOVE.W";
+    case 0x4:
+      return ClassifyMisc(opcode);
+    case 0x5:
+      if (is_size_3)
+        return ((opcode >> 3) & 7) == 1 ? "DBcc" : "Scc";
+      return is_bit_8 ? "SUBQ" : "ADDQ";
+    case 0x6:
+      switch ((opcode >> 8) & 0xF) {
+        case 0:
+          return "BRA";
+        case 1:
+          return "BSR";
+        default:
+          return "Bcc";
+      }
+    case 0x7:
+      return "MOVEQ";
+    case 0x8:
+      if (is_size_3)
+        return is_bit_8 ? "DIVS" : "DIVU";
+      return (opcode & 0x01F0) == 0x0100 ? "SBCD" : "OR";
+    case 0x9:
+      if (is_size_3)
+        return "SUBA";
+      return (opcode & 0x0130) == 0x0100 ? "SUBX" : "SUB";
+    case 0xA:
+      return "A-LINE";
+    case 0xB:
+      if (is_size_3)
+        return "CMPA";
+      if (!is_bit_8)
+        return "CMP";
+      return (opcode & 0x0038) == 0x0008 ? "CMPM" : "EOR";
+    case 0xC:
+      if (is_size_3)
+        return is_bit_8 ? "MULS" : "MULU";
+      if ((opcode & 0x01F0) == 0x0100)
+        return "ABCD";
+      if ((opcode & 0x01F8) == 0x0140 || (opcode & 0x01F8) == 0x0148 ||
+          (opcode & 0x01F8) == 0x0188)
+        return "EXG";
+      return "AND";
+    case 0xD:
+      if (is_size_3)
+        return "ADDA";
+      return (opcode & 0x0130) == 0x0100 ? "ADDX" : "ADD";
+    case 0xE: {
+      static constexpr const char* kShifts[] = {"ASx", "LSx", "ROXx", "ROx"};
+      if (is_size_3)
+        return (opcode & 0x0800) ? "BFxxx" : kShifts[(opcode >> 9) & 3];
+      return kShifts[(opcode >> 3) & 3];
+    }
+    default:
+      return "F-LINE";
+  }
+}
+
+// static
+ExecutionStats& ExecutionStats::Instance() {
+  return Machine::Current().Get<ExecutionStats>();
+}
+
+ExecutionStats::ExecutionStats()
+    : opcode_counts_(std::make_unique<uint64_t[]>(kOpcodeCount)) {}
+
+// static
+ExecutionStats::Region ExecutionStats::GetRegion(uint32_t address) {
+  using namespace memory;
+  if (address >= SystemMemorySize())
+    return Region::kOutOfRange;
+  if (address >= LastEmulatedSubroutineAddress())
+    return Region::kNative;
+  if (address >= StackStart())
+    return Region::kA5World;
+  if (address >= StackEnd())
+    return Region::kStack;
+  if (address >= kHeapStart)
+    return Region::kApplicationHeap;
+  if (address >= kSystemHeapStart)
+    return Region::kSystemHeap;
+  if (address >= kToolboxTrapTableStart)
+    return Region::kTrapTables;
+  if (address >= kSystemGlobalsHighStart)
+    return Region::kSystemGlobals;
+  if (address >= kSystemTrapTableStart)
+    return Region::kTrapTables;
+  if (address >= kSystemGlobalsLowStart)
+    return Region::kSystemGlobals;
+  return Region::kVectors;
+}
+
+// static
+const char* ExecutionStats::GetRegionName(Region region) {
+  switch (region) {
+    case Region::kVectors:
+      return "Interrupt Vectors";
+    case Region::kSystemGlobals:
+      return "System Globals";
+    case Region::kTrapTables:
+      return "A-Trap Tables";
+    case Region::kSystemHeap:
+      return "System Heap";
+    case Region::kApplicationHeap:
+      return "Application Heap";
+    case Region::kStack:
+      return "Stack";
+    case Region::kA5World:
+      return "A5 World";
+    case Region::kNative:
+      return "Native Functions";
+    case Region::kOutOfRange:
+    case Region::kCount:
+      return "Out of Range";
+  }
+  return "Unknown";
+}
+
+void ExecutionStats::RecordInstruction(uint32_t pc, uint16_t opcode) {
+  ++opcode_counts_[opcode];
+
+  if (is_after_branch_ && pc != fallthrough_pc_)
+    ++branch_targets_[pc];
+
+  uint32_t length = 0;
+  is_after_branch_ = IsControlTransfer(opcode, length);
+  fallthrough_pc_ = length ? pc + length : 0;
+}
+
+void ExecutionStats::Print(std::ostream& os) const {
+  std::map<std::string, uint64_t> classes;
+  uint64_t total = 0;
+  for (size_t opcode = 0; opcode < kOpcodeCount; ++opcode) {
+    if (opcode_counts_[opcode] == 0)
+      continue;
+    classes[ClassifyOpcode(opcode)] += opcode_counts_[opcode];
+    total += opcode_counts_[opcode];
+  }
+  std::vector<std::pair<std::string, uint64_t>> sorted(classes.begin(),
+                                                       classes.end());
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const auto& lhs, const auto& rhs) {
+                     return lhs.second > rhs.second;
+                   });
+
+  os << absl::StreamFormat("%-16s %14s %7s\n", "Instruction", "Count", "%");
+  for (const auto& [name, count] : sorted) {
+    os << absl::StreamFormat("%-16s %14d %6.2f%%\n", name, count,
+                             100.0 * count / std::max<uint64_t>(total, 1));
+  }
+  os << absl::StreamFormat("%d instructions\n\n", total);
+
+  os << absl::StreamFormat("%-18s %14s %14s %14s\n", "Region", "Fetches",
+                           "Reads", "Writes");
+  for (size_t region = 0; region < accesses_.size(); ++region) {
+    os << absl::StreamFormat("%-18s %14d %14d %14d\n",
+                             GetRegionName(static_cast<Region>(region)),
+                             accesses_[region].fetches,
+                             accesses_[region].reads,
+                             accesses_[region].writes);
+  }
+
+  std::vector<std::pair<uint32_t, uint64_t>> targets(branch_targets_.begin(),
+                                                     branch_targets_.end());
+  std::sort(targets.begin(), targets.end(),
+            [](const auto& lhs, const auto& rhs) {
+              return lhs.second != rhs.second ? lhs.second > rhs.second
+                                              : lhs.first < rhs.first;
+            });
+  if (targets.size() > kMaxBranchTargets)
+    targets.resize(kMaxBranchTargets);
+
+  std::vector<MemorySpan> tags = DebugManager::Instance().GetMemoryTags();
+  os << absl::StreamFormat("\n%-10s %14s  %s\n", "Target", "Taken", "Symbol");
+  for (const auto& [address, count] : targets) {
+    os << absl::StreamFormat("0x%08x %14d  %s\n", address, count,
+                             Profiler::Instance().Symbolize(address, tags));
+  }
+}
+
+}  // namespace cyder
@@ -0,0 +1,95 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <unordered_map>
+
+namespace cyder {
+
+// Returns the instruction class (i.e. "MOVE.L", "Bcc", "A-LINE") of `opcode`.
+const char* ClassifyOpcode(uint16_t opcode);
+
+// Collects the opcode mix, memory accesses by region and branch targets of the
+// running application. It is fed by the emulator when enabled (see
+// `Emulator::EnableExecutionStats()`) and is far too slow to be always-on.
+class ExecutionStats {
+ public:
+  static ExecutionStats& Instance();
+
+  ExecutionStats();
+
+  // The regions of the memory map accesses are counted by.
+  enum class Region {
+    kVectors,
+    kSystemGlobals,
+    kTrapTables,
+    kSystemHeap,
+    kApplicationHeap,
+    kStack,
+    kA5World,
+    kNative,
+    kOutOfRange,
+    kCount,
+  };
+  static Region GetRegion(uint32_t address);
+  static const char* GetRegionName(Region region);
+
+  // Records the execution of `opcode` at `pc`. A branch target is recorded
+  // if the previous instruction transferred control (and was taken).
+  void RecordInstruction(uint32_t pc, uint16_t opcode);
+
+  // Instruction fetches (opcodes and extension words) are counted apart from
+  // data reads.
+  void RecordFetch(uint32_t address) {
+    ++accesses_[static_cast<size_t>(GetRegion(address))].fetches;
+  }
+  void RecordRead(uint32_t address) {
+    ++accesses_[static_cast<size_t>(GetRegion(address))].reads;
+  }
+  void RecordWrite(uint32_t address) {
+    ++accesses_[static_cast<size_t>(GetRegion(address))].writes;
+  }
+
+  uint64_t opcode_count(uint16_t opcode) const {
+    return opcode_counts_[opcode];
+  }
+  uint64_t fetches(Region region) const {
+    return accesses_[static_cast<size_t>(region)].fetches;
+  }
+  uint64_t reads(Region region) const {
+    return accesses_[static_cast<size_t>(region)].reads;
+  }
+  uint64_t writes(Region region) const {
+    return accesses_[static_cast<size_t>(region)].writes;
+  }
+  const std::unordered_map<uint32_t, uint64_t>& branch_targets() const {
+    return branch_targets_;
+  }
+
+  // Prints the instruction classes and memory regions by frequency followed by
+  // the hottest branch targets.
+  void Print(std::ostream& os) const;
+
+ private:
+  struct Accesses {
+    uint64_t fetches = 0;
+    uint64_t reads = 0;
+    uint64_t writes = 0;
+  };
+
+  std::unique_ptr<uint64_t[]> opcode_counts_;
+  std::array<Accesses, static_cast<size_t>(Region::kCount)> accesses_;
+  std::unordered_map<uint32_t, uint64_t> branch_targets_;
+
+  // The address at which execution continues if the previous instruction
+  // transferred control but was not taken (zero if it always transfers).
+  uint32_t fallthrough_pc_ = 0;
+  bool is_after_branch_ = false;
+};
+
+}  // namespace cyder
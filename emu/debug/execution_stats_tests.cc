@@ -0,0 +1,79 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/debug/execution_stats.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "emu/memory/memory_map.h"
+
+namespace cyder {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+TEST(ExecutionStatsTests, ClassifyOpcode) {
+  EXPECT_STREQ(ClassifyOpcode(0x2F00), "MOVE.L");   // MOVE.L D0,-(A7)
+  EXPECT_STREQ(ClassifyOpcode(0x2040), "MOVEA.L");  // MOVEA.L D0,A0
+  EXPECT_STREQ(ClassifyOpcode(0x4E75), "RTS");
+  EXPECT_STREQ(ClassifyOpcode(0x4E56), "LINK");
+  EXPECT_STREQ(ClassifyOpcode(0x4EBA), "JSR");      // JSR (d16,PC)
+  EXPECT_STREQ(ClassifyOpcode(0x48E7), "MOVEM");    // MOVEM.L regs,-(A7)
+  EXPECT_STREQ(ClassifyOpcode(0x51C8), "DBcc");     // DBF D0
+  EXPECT_STREQ(ClassifyOpcode(0x6700), "Bcc");      // BEQ.W
+  EXPECT_STREQ(ClassifyOpcode(0x7001), "MOVEQ");
+  EXPECT_STREQ(ClassifyOpcode(0xA970), "A-LINE");
+  EXPECT_STREQ(ClassifyOpcode(0xE348), "LSx");      // LSL.W #1,D0
+  EXPECT_STREQ(ClassifyOpcode(0x0C40), "CMPI");     // CMPI.W #x,D0
+}
+
+TEST(ExecutionStatsTests, CountsTakenBranches) {
+  ExecutionStats stats;
+  // BEQ.S +4 not taken then taken
+  stats.RecordInstruction(0x1000, 0x6704);
+  stats.RecordInstruction(0x1002, 0x4E71);
+  stats.RecordInstruction(0x1004, 0x6704);
+  stats.RecordInstruction(0x100A, 0x4E71);
+  // JSR always transfers control
+  stats.RecordInstruction(0x100C, 0x4EBA);
+  stats.RecordInstruction(0x2000, 0x4E75);
+  stats.RecordInstruction(0x1010, 0x4E71);
+
+  EXPECT_EQ(stats.opcode_count(0x6704), 2u);
+  EXPECT_EQ(stats.opcode_count(0x4E71), 3u);
+  EXPECT_THAT(stats.branch_targets(),
+              UnorderedElementsAre(Pair(0x100A, 1), Pair(0x2000, 1),
+                                   Pair(0x1010, 1)));
+}
+
+TEST(ExecutionStatsTests, CountsAccessesByRegion) {
+  using Region = ExecutionStats::Region;
+  ExecutionStats stats;
+  stats.RecordRead(memory::StackStart() - 4);
+  stats.RecordWrite(memory::StackStart() - 4);
+  stats.RecordRead(memory::kHeapStart);
+  stats.RecordRead(0x0910);
+  stats.RecordFetch(memory::kHeapStart);
+  stats.RecordFetch(memory::kHeapStart + 2);
+
+  EXPECT_EQ(stats.reads(Region::kStack), 1u);
+  EXPECT_EQ(stats.writes(Region::kStack), 1u);
+  EXPECT_EQ(stats.reads(Region::kApplicationHeap), 1u);
+  EXPECT_EQ(stats.fetches(Region::kApplicationHeap), 2u);
+  EXPECT_EQ(stats.fetches(Region::kStack), 0u);
+  EXPECT_EQ(stats.reads(Region::kSystemGlobals), 1u);
+  EXPECT_EQ(ExecutionStats::GetRegion(memory::StackStart()), Region::kA5World);
+  EXPECT_EQ(ExecutionStats::GetRegion(0x0C00), Region::kTrapTables);
+
+  std::stringstream output;
+  stats.Print(output);
+  EXPECT_THAT(output.str(), HasSubstr("Application Heap"));
+}
+
+}  // namespace
+}  // namespace cyder
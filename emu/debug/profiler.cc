@@ -0,0 +1,173 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/debug/profiler.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <optional>
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/str_join.h"
+#include "core/status_helpers.h"
+#include "emu/machine.h"
+#include "emu/memory/memory_map.h"
+#include "third_party/musashi/src/m68k.h"
+
+namespace cyder {
+namespace {
+
+constexpr uint16_t kLinkA6 = 0x4E56;
+constexpr uint16_t kRts = 0x4E75;
+constexpr uint16_t kRtd = 0x4E74;
+
+// The deepest A6 frame chain which will be followed.
+constexpr int kMaxFrames = 64;
+
+uint16_t ReadWord(uint32_t address) {
+  return MUST(memory::kSystemMemory.Read<uint16_t>(address));
+}
+
+// Returns the innermost CODE segment containing `address` if any.
+const MemorySpan* FindSegment(const std::vector<MemorySpan>& tags,
+                              uint32_t address) {
+  const MemorySpan* segment = nullptr;
+  for (const auto& span : tags) {
+    if (span.start > address)
+      break;
+    if (address < span.end && absl::StartsWith(span.tag, "CODE"))
+      segment = &span;
+  }
+  return segment;
+}
+
+// Returns the MacsBug name which follows the end of the procedure containing
+// `address` (the RTS/RTD which ends a procedure is followed by a byte of
+// 0x80 + the length of the name and then the name itself; see bin/disasm.cc).
+std::optional<std::string> FindProcedureName(const MemorySpan& segment,
+                                             uint32_t address) {
+  uint16_t prev_op = 0;
+  for (uint32_t pc = address & ~1u; pc + 2 <= segment.end; pc += 2) {
+    uint16_t op = ReadWord(pc);
+    if ((prev_op == kRts || prev_op == kRtd) && op > 0x8000) {
+      size_t length = (op >> 8) - 0x80;
+      if (length == 0 || pc + 1 + length > segment.end)
+        return std::nullopt;
+
+      std::string name;
+      for (size_t i = 0; i < length; ++i) {
+        char c = MUST(memory::kSystemMemory.Read<uint8_t>(pc + 1 + i));
+        if (!std::isprint(static_cast<unsigned char>(c)) || c == ';')
+          return std::nullopt;
+        name.push_back(c);
+      }
+      return name;
+    }
+    // The start of the next procedure was found (this one has no name)
+    if (op == kLinkA6 && prev_op != 0)
+      return std::nullopt;
+    prev_op = op;
+  }
+  return std::nullopt;
+}
+
+// Returns the address of the LINK A6 starting the procedure containing
+// `address` or `address` itself if it could not be found.
+uint32_t FindProcedureStart(const MemorySpan& segment, uint32_t address) {
+  for (uint32_t pc = address & ~1u; pc >= segment.start; pc -= 2) {
+    if (ReadWord(pc) == kLinkA6)
+      return pc;
+    if (pc < segment.start + 2)
+      break;
+  }
+  return address;
+}
+
+}  // namespace
+
+// static
+Profiler& Profiler::Instance() {
+  return Machine::Current().Get<Profiler>();
+}
+
+void Profiler::Start(int period, bool walk_frames) {
+  CHECK_GT(period, 0) << "The sampling period must be positive";
+  period_ = period;
+  walk_frames_ = walk_frames;
+  cycles_since_sample_ = 0;
+}
+
+void Profiler::Sample() {
+  // Addresses from innermost (the PC) to outermost caller
+  std::vector<size_t> addresses;
+  addresses.push_back(m68k_get_reg(/*context=*/NULL, M68K_REG_PC));
+
+  if (walk_frames_) {
+    // LINK A6 pushes the caller's A6 just below the return address
+    uint32_t frame = m68k_get_reg(/*context=*/NULL, M68K_REG_A6);
+    for (int depth = 0; depth < kMaxFrames; ++depth) {
+      if (frame < memory::StackEnd() || frame + 8 > memory::StackStart())
+        break;
+      uint32_t next = MUST(memory::kSystemMemory.Read<uint32_t>(frame));
+      uint32_t return_address =
+          MUST(memory::kSystemMemory.Read<uint32_t>(frame + 4));
+      // The return address follows the call so step back into the caller
+      addresses.push_back(return_address - 2);
+      if (next <= frame)
+        break;
+      frame = next;
+    }
+  }
+
+  const std::vector<std::vector<MemorySpan>> tags =
+      DebugManager::Instance().GetMemoryTagsAtEach(addresses);
+  std::vector<std::string> frames;
+  for (size_t i = addresses.size(); i-- > 0;)
+    frames.push_back(Symbolize(addresses[i], tags[i]));
+  ++stacks_[absl::StrJoin(frames, ";")];
+  ++sample_count_;
+}
+
+std::string Profiler::Symbolize(uint32_t address,
+                                const std::vector<MemorySpan>& tags) {
+  const MemorySpan* segment = FindSegment(tags, address);
+  if (segment == nullptr)
+    return absl::StrFormat("0x%x", address);
+
+  auto it = labels_.find(address);
+  if (it != labels_.end() && it->second.segment_start == segment->start &&
+      it->second.segment_tag == segment->tag) {
+    return it->second.label;
+  }
+
+  std::string label;
+  if (auto name = FindProcedureName(*segment, address)) {
+    label = absl::StrCat(segment->tag, ":", *name);
+  } else {
+    label = absl::StrFormat("%s+0x%x", segment->tag,
+                            FindProcedureStart(*segment, address) -
+                                static_cast<uint32_t>(segment->start));
+  }
+  labels_[address] = Label{segment->start, segment->tag, label};
+  return label;
+}
+
+void Profiler::WriteCollapsedStacks(std::ostream& os) const {
+  for (const auto& [stack, count] : stacks_) {
+    os << stack << " " << count << "\n";
+  }
+}
+
+absl::Status Profiler::SaveCollapsedStacks(const std::string& path) const {
+  std::ofstream file(path);
+  if (!file.is_open())
+    return absl::InternalError(
+        absl::StrCat("Unable to open profile file: '", path, "'"));
+  WriteCollapsedStacks(file);
+  return absl::OkStatus();
+}
+
+}  // namespace cyder
@@ -0,0 +1,74 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "emu/debug/debug_manager.h"
+
+namespace cyder {
+
+// Samples the m68k PC (and optionally the A6 frame chain) every N cycles and
+// attributes each sample to the CODE segment (tagged by the segment loader)
+// and MacsBug procedure name it falls within. Samples are aggregated as
+// "collapsed stacks" which can be fed directly to flamegraph.pl.
+class Profiler {
+ public:
+  static Profiler& Instance();
+
+  // Starts sampling every `period` cycles. If `walk_frames` then the callers
+  // found by following the A6 (LINK) frame chain are recorded as well.
+  void Start(int period, bool walk_frames);
+
+  bool is_enabled() const { return period_ > 0; }
+  // The number of cycles to run until the next sample is taken.
+  int cycles_until_sample() const { return period_ - cycles_since_sample_; }
+
+  // Called by the emulator as cycles are run; samples once `period` elapses.
+  void AddCycles(int cycles) {
+    cycles_since_sample_ += cycles;
+    if (cycles_since_sample_ >= period_) {
+      cycles_since_sample_ = 0;
+      Sample();
+    }
+  }
+
+  // Records the current stack of the CPU.
+  void Sample();
+
+  // Writes one "outermost;...;innermost count" line per unique stack.
+  void WriteCollapsedStacks(std::ostream& os) const;
+  absl::Status SaveCollapsedStacks(const std::string& path) const;
+
+  uint64_t sample_count() const { return sample_count_; }
+
+  // Returns "CODE<id>:<name>" for addresses within a procedure followed by a
+  // MacsBug name, "CODE<id>+0x<offset>" (of the LINK which starts the
+  // procedure if found) for other code, and the raw address otherwise.
+  std::string Symbolize(uint32_t address,
+                        const std::vector<MemorySpan>& tags);
+
+ private:
+  struct Label {
+    // The segment the address was symbolized within (segments may move).
+    size_t segment_start;
+    std::string segment_tag;
+    std::string label;
+  };
+
+  int period_ = 0;
+  bool walk_frames_ = false;
+  int cycles_since_sample_ = 0;
+  uint64_t sample_count_ = 0;
+  std::map<std::string, uint64_t> stacks_;
+  std::unordered_map<uint32_t, Label> labels_;
+};
+
+}  // namespace cyder
@@ -0,0 +1,79 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/debug/profiler.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "core/status_helpers.h"
+#include "emu/memory/memory_map.h"
+#include "third_party/musashi/src/m68k.h"
+
+namespace cyder {
+namespace {
+
+constexpr uint32_t kSegmentStart = 0x3000;
+
+// Writes two procedures to a "CODE1" segment: "MAIN" (with a MacsBug name)
+// at +0x0 and an unnamed procedure at +0x10.
+void WriteSegment() {
+  const uint16_t code[] = {
+      0x4E56, 0x0000,  // LINK A6,#0
+      0x4E71,          // NOP
+      0x4E5E,          // UNLK A6
+      0x4E75,          // RTS
+      0x844D, 0x4149,  // "\x84MAIN"
+      0x4E00,          //
+      0x4E56, 0x0000,  // LINK A6,#0
+      0x4E71,          // NOP
+      0x4E5E,          // UNLK A6
+      0x4E75,          // RTS
+  };
+  uint32_t address = kSegmentStart;
+  for (uint16_t op : code) {
+    CHECK_OK(memory::kSystemMemory.Write<uint16_t>(address, op));
+    address += sizeof(uint16_t);
+  }
+  DebugManager::Instance().Clear();
+  DebugManager::Instance().TagMemory(kSegmentStart, address, "CODE1");
+}
+
+TEST(ProfilerTests, Symbolize) {
+  WriteSegment();
+  auto tags = DebugManager::Instance().GetMemoryTags();
+
+  Profiler profiler;
+  EXPECT_EQ(profiler.Symbolize(kSegmentStart + 4, tags), "CODE1:MAIN");
+  EXPECT_EQ(profiler.Symbolize(kSegmentStart + 0x14, tags), "CODE1+0x10");
+  EXPECT_EQ(profiler.Symbolize(0x100, tags), "0x100");
+}
+
+TEST(ProfilerTests, SampleWalksFrames) {
+  WriteSegment();
+
+  // MAIN was called from the unnamed procedure
+  const uint32_t frame = memory::StackStart() - 0x100;
+  CHECK_OK(memory::kSystemMemory.Write<uint32_t>(frame, 0));
+  CHECK_OK(
+      memory::kSystemMemory.Write<uint32_t>(frame + 4, kSegmentStart + 0x16));
+  m68k_set_reg(M68K_REG_A6, frame);
+  m68k_set_reg(M68K_REG_PC, kSegmentStart + 4);
+
+  Profiler profiler;
+  profiler.Start(/*period=*/100, /*walk_frames=*/true);
+  profiler.AddCycles(50);
+  EXPECT_EQ(profiler.sample_count(), 0u);
+  EXPECT_EQ(profiler.cycles_until_sample(), 50);
+  profiler.AddCycles(50);
+  profiler.Sample();
+
+  std::stringstream output;
+  profiler.WriteCollapsedStacks(output);
+  EXPECT_EQ(profiler.sample_count(), 2u);
+  EXPECT_EQ(output.str(), "CODE1+0x10;CODE1:MAIN 2\n");
+}
+
+}  // namespace
+}  // namespace cyder
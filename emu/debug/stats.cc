@@ -0,0 +1,66 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/debug/stats.h"
+
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace cyder {
+namespace {
+
+struct Registry {
+  std::mutex mutex;
+  std::vector<std::pair<std::string, StatsPrinter>> printers;
+};
+
+Registry& GetRegistry() {
+  static Registry* registry = new Registry();
+  return *registry;
+}
+
+std::atomic<bool> dump_requested{false};
+
+}  // namespace
+
+void RegisterStats(const std::string& name, StatsPrinter printer) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  registry.printers.emplace_back(name, std::move(printer));
+}
+
+void DumpStats(std::ostream& os) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (const auto& [name, printer] : registry.printers) {
+    os << "== " << name << " ==\n";
+    printer(os);
+  }
+  os.flush();
+}
+
+bool DumpStats(std::ostream& os, const std::string& name) {
+  Registry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  for (const auto& [printer_name, printer] : registry.printers) {
+    if (printer_name == name) {
+      printer(os);
+      os.flush();
+      return true;
+    }
+  }
+  return false;
+}
+
+void RequestStatsDump() {
+  dump_requested.store(true);
+}
+
+void DumpStatsIfRequested(std::ostream& os) {
+  if (dump_requested.exchange(false))
+    DumpStats(os);
+}
+
+}  // namespace cyder
@@ -0,0 +1,29 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#pragma once
+
+#include <functional>
+#include <ostream>
+#include <string>
+
+namespace cyder {
+
+// Collects the printers of the emulator's statistics (i.e. trap counters) so
+// they can all be dumped at once: on exit, on a signal or from the debugger.
+using StatsPrinter = std::function<void(std::ostream&)>;
+
+// Registers a `printer` for the statistics titled `name`.
+void RegisterStats(const std::string& name, StatsPrinter printer);
+
+// Prints every registered statistic to `os`.
+void DumpStats(std::ostream& os);
+// Prints the statistic titled `name` to `os` (returns false if unknown).
+bool DumpStats(std::ostream& os, const std::string& name);
+
+// Requests a dump from a signal handler (it is async-signal-safe). The dump is
+// done by the emulator thread with the next `DumpStatsIfRequested()`.
+void RequestStatsDump();
+void DumpStatsIfRequested(std::ostream& os);
+
+}  // namespace cyder
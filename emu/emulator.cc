@@ -1,21 +1,35 @@
 #include "emu/emulator.h"
 
+#include <algorithm>
+#include <array>
 #include <cstdint>
+#include <cstring>
 #include <functional>
 #include <map>
-#include <stack>
+#include <utility>
 
-#include "absl/base/no_destructor.h"
-#include "absl/types/optional.h"
+#include "absl/base/optimization.h"
+#include "absl/strings/str_cat.h"
+#include "core/endian_helpers.h"
 #include "core/logging.h"
+#include "core/status_helpers.h"
+#include "emu/block_cache.h"
 #include "emu/debug/debugger.h"
+#include "emu/debug/execution_stats.h"
+#include "emu/debug/profiler.h"
+#include "emu/machine.h"
+#include "emu/memory/code_pages.h"
 #include "emu/memory/memory_map.h"
+#include "emu/scheduler.h"
 #include "emu/trap/stack_helpers.h"
+#include "emu/vertical_retrace.h"
 #include "third_party/musashi/src/m68k.h"
 
 extern "C" {
 
 void cpu_instr_callback(unsigned int pc);
+void cpu_count_instr_callback(unsigned int pc);
+int cpu_illegal_instr_callback(int opcode);
 
 }  // extern "C"
 
@@ -23,7 +37,124 @@ namespace cyder {
 namespace {
 
 constexpr unsigned int kCpuType = M68K_CPU_TYPE_68030;
-constexpr bool kDisassembleInstructions = false;
+
+// Runs until a native function ends the timeslice (in practice).
+constexpr int kTimesliceCycles = 100000000;
+// The number of cycles Musashi runs for when no cached block can be run at the
+// PC before checking the `BlockCache` again.
+constexpr int kFallbackCycles = 128;
+
+// The VBL interrupt is autovectored (vector 25) at interrupt level 1.
+constexpr unsigned int kVblInterruptLevel = 1;
+constexpr uint32_t kVblInterruptVector = 0x64;
+
+// Native functions are marked with `ILLEGAL` which Motorola reserves to always
+// raise an illegal instruction exception. Musashi reports these through the
+// illegal instruction callback so they cost nothing until they are reached.
+constexpr uint16_t kNativeFunctionOpcode = 0x4AFC /* ILLEGAL */;
+
+// Native functions in the stub region at the top of memory (trap stubs and the
+// emulator's own entry points) are looked up by address in a fixed table.
+constexpr size_t kStubCount = memory::kStubRegionSize / sizeof(uint16_t);
+
+// The cycles charged for an A-Trap dispatched directly (the line 1010
+// exception it replaces takes 34 cycles on the 68000).
+constexpr int kDirectTrapCycles = 34;
+
+// The registers in a save-state. SR goes first so that the mode (and hence
+// which stack pointer A7 refers to) is set before the stack pointers are.
+constexpr m68k_register_t kSavedRegisters[] = {
+    M68K_REG_SR, M68K_REG_USP, M68K_REG_ISP, M68K_REG_D0, M68K_REG_D1,
+    M68K_REG_D2, M68K_REG_D3,  M68K_REG_D4,  M68K_REG_D5, M68K_REG_D6,
+    M68K_REG_D7, M68K_REG_A0,  M68K_REG_A1,  M68K_REG_A2, M68K_REG_A3,
+    M68K_REG_A4, M68K_REG_A5,  M68K_REG_A6,  M68K_REG_A7, M68K_REG_PC,
+};
+
+// The deepest nesting of `CallFunction<>()` supported.
+constexpr size_t kMaxExitFrames = 64;
+
+// The fast memory path wraps addresses to the (power of two) memory size.
+inline uint32_t AddressMask() {
+  return memory::SystemMemorySize() - 1;
+}
+
+// Whether emulated memory accesses take the slow path which checks them (see
+// `MemoryAccess`) and/or counts them for `ExecutionStats`.
+bool use_slow_memory = true;
+bool use_checked_memory = true;
+ExecutionStats* execution_stats = nullptr;
+// The instruction count of the running emulator (see `Run()`).
+uint64_t* instruction_count = nullptr;
+// Set by every store outside of the stack (see `RecordStore()`).
+bool has_non_stack_writes = false;
+
+template <typename T>
+inline T FastRead(uint32_t address) {
+  T value;
+  memcpy(&value, memory::kSystemMemoryRaw + (address & AddressMask()),
+         sizeof(T));
+  return betoh<T>(value);
+}
+
+template <typename T>
+inline void FastWrite(uint32_t address, T value) {
+  // Checked writes go through `kSystemMemory` which publishes code writes
+  memory::CheckCodeWrite(address, sizeof(T));
+  value = htobe<T>(value);
+  memcpy(memory::kSystemMemoryRaw + (address & AddressMask()), &value,
+         sizeof(T));
+}
+
+// Notes stores outside of the stack. The subtraction wraps addresses below the
+// stack so this is a single comparison (and no branch) per store.
+inline void RecordStore(uint32_t address) {
+  has_non_stack_writes |=
+      address - memory::StackEnd() >= memory::StackSize();
+}
+
+// Emulates `RTE` for the four word (format $0) frame pushed by A-Traps.
+void ReturnFromException() {
+  uint16_t sr = trap::Pop<uint16_t>();
+  uint32_t pc = trap::Pop<uint32_t>();
+  uint16_t format_and_offset = trap::Pop<uint16_t>();
+  CHECK_EQ(format_and_offset >> 12, 0)
+      << "Unexpected exception frame format: 0x" << std::hex
+      << format_and_offset;
+
+  m68k_set_reg(M68K_REG_PC, pc);
+  m68k_set_reg(M68K_REG_SR, sr);
+}
+
+template <typename T>
+T SlowRead(uint32_t address) {
+  if (execution_stats)
+    execution_stats->RecordRead(address);
+  if (!use_checked_memory)
+    return FastRead<T>(address);
+  // memory::CheckReadAccess(address);
+  return MUST(memory::kSystemMemory.Read<T>(address));
+}
+
+// Reads opcodes and their extension words (including immediate data).
+template <typename T>
+T SlowFetch(uint32_t address) {
+  if (execution_stats)
+    execution_stats->RecordFetch(address);
+  if (!use_checked_memory)
+    return FastRead<T>(address);
+  return MUST(memory::kSystemMemory.Read<T>(address));
+}
+
+template <typename T>
+void SlowWrite(uint32_t address, T value) {
+  if (execution_stats)
+    execution_stats->RecordWrite(address);
+  if (!use_checked_memory)
+    return FastWrite<T>(address, value);
+  memory::CheckWriteAccess(address, value);
+  CHECK_OK(memory::kSystemMemory.Write<T>(address, value))
+      << " unable to write " << std::hex << value << " to " << address;
+}
 
 }  // namespace
 
@@ -31,85 +162,236 @@ class EmulatorImpl : public Emulator {
  public:
   EmulatorImpl() {
     m68k_init();
-    m68k_set_instr_hook_callback(cpu_instr_callback);
+    m68k_set_illg_instr_callback(cpu_illegal_instr_callback);
     m68k_set_cpu_type(kCpuType);
+    // Musashi calls the hook for every instruction regardless so counting in
+    // it is nearly free (compared to `HandleInstruction()`).
+    if (kHasInstructionHook)
+      m68k_set_instr_hook_callback(cpu_count_instr_callback);
+
+    RegisterNativeFunction(memory::EndFunctionCallAddress(), [this]() {
+      CHECK_GT(exit_frame_count_, 0u) << "Returned from an unknown function";
+      *exit_frames_[--exit_frame_count_] = true;
+    });
   }
+  ~EmulatorImpl() override = default;
 
   void Init(unsigned int pc) override {
     m68k_set_reg(M68K_REG_PC, pc);
     m68k_set_reg(M68K_REG_A5, memory::GetA5WorldPosition());
-    m68k_set_reg(M68K_REG_SP, memory::kStackStart);
+    m68k_set_reg(M68K_REG_SP, memory::StackStart());
 
-    // Mac OS _always_ runs in supervisor mode so set the SR
+    // Mac OS _always_ runs in supervisor mode so set the SR. The interrupt
+    // mask is cleared as a reset CPU (i.e. a new machine's) masks every level
+    // which would hold off the VBL interrupt.
     // Link: https://en.wikibooks.org/wiki/68000_Assembly/Registers
-    uint32_t sr = m68k_get_reg(NULL, M68K_REG_SR);
-    m68k_set_reg(M68K_REG_SR, sr | (1 << 13));
+    m68k_set_reg(M68K_REG_SR, 1 << 13);
   }
 
   void Run() override {
-    m68k_execute(100000000);
+    Scheduler& scheduler = Scheduler::Instance();
+    Profiler& profiler = Profiler::Instance();
+    instruction_count = &instructions_run_;
+    ApplyMemoryAccess();
+    int cycles = kTimesliceCycles;
+    while (cycles > 0 && native_func_ == nullptr) {
+      int quantum = std::min(cycles, scheduler.quantum());
+      if (ABSL_PREDICT_FALSE(profiler.is_enabled()))
+        quantum = std::min(quantum, profiler.cycles_until_sample());
+      const int elapsed =
+          use_block_cache_ ? RunWithBlockCache(quantum) : Execute(quantum);
+      scheduler.AddCycles(elapsed);
+      if (ABSL_PREDICT_FALSE(profiler.is_enabled()))
+        profiler.AddCycles(elapsed);
+      cycles -= elapsed;
+
+      // The interrupt is taken immediately so it must not be raised while a
+      // native function is pending (which may need to pop its own frame) or
+      // while the last one is still being handled (see `EnableVblInterrupt()`).
+      if (use_vbl_interrupt_ && native_func_ == nullptr &&
+          !in_vertical_blank_ && scheduler.ShouldRaiseVbl()) {
+        SetIrqLevel(kVblInterruptLevel);
+      }
+    }
 
-    if (!native_func_.has_value())
+    if (native_func_ == nullptr)
       return;
 
     // Ensure reset BEFORE calling the function so it is ready for a nested call
-    auto func = std::move(native_func_.value());
-    native_func_.reset();
-    std::move(func)();
+    const NativeFunc* func = native_func_;
+    native_func_ = nullptr;
+    (*func)();
   }
 
   void RegisterNativeFunction(uint32_t address, NativeFunc func) override {
-    CHECK_OK(memory::kSystemMemory.Write<uint16_t>(address, 0x4E71 /*NOP*/))
-        << "Unable to write NOP to address 0x" << std::hex << address;
-    native_functions_[address] = std::move(func);
+    CHECK_OK(memory::kSystemMemory.Write<uint16_t>(address,
+                                                   kNativeFunctionOpcode))
+        << "Unable to write ILLEGAL to address 0x" << std::hex << address;
+    if (address >= memory::LastEmulatedSubroutineAddress() &&
+        address < memory::SystemMemorySize()) {
+      stub_functions_[StubIndex(address)] = std::move(func);
+    } else {
+      native_functions_[address] = std::move(func);
+    }
   }
 
   void RegisterATrapHandler(NativeFunc handler) override {
-    // Sets up the A-Trap exception handler to call a subroutine containing RTE.
-    // AFTER this subroutine is called, the emulator will end the current
-    // timeslice and call the native TrapManager::PerformTrapEntry().
+    // Points the A-Trap exception vector at a native function which restores
+    // the PC and SR (emulating `RTE`) before calling the native handler i.e.
+    // TrapManager::PerformTrapEntry().
     // NOTE: The stack will be different than on a real machine since the RTE
     //       is executed BEFORE the A-Trap handler is called.
-    RegisterNativeFunction(memory::kTrapManagerEntryAddress,
-                           std::move(handler));
+    a_trap_handler_ = std::move(handler);
+    RegisterNativeFunction(memory::TrapManagerEntryAddress(), [this]() {
+      ReturnFromException();
+      a_trap_handler_();
+    });
     CHECK_OK(memory::kSystemMemory.Write<uint32_t>(
-        0x28, memory::kTrapManagerEntryAddress));
-    // Overwrite the native function `NOP` with an `RTE` instruction to restore
-    // the PC and SR registers correctly.
-    CHECK_OK(memory::kSystemMemory.Write<uint16_t>(
-        memory::kTrapManagerEntryAddress, 0x4E73 /* RTE */));
+        0x28, memory::TrapManagerEntryAddress()));
   }
 
-  void RegisterExitFunction(NativeFunc func) override {
-    exit_funcs_.push(std::move(func));
-    RegisterNativeFunction(memory::kEndFunctionCallAddress,
-                           [exit_funcs = &exit_funcs_]() {
-                             NativeFunc func = std::move(exit_funcs->top());
-                             exit_funcs->pop();
-                             return std::move(func)();
-                           });
+  void PushExitFrame(bool* has_returned) override {
+    CHECK_LT(exit_frame_count_, kMaxExitFrames)
+        << "Too many nested calls to emulated functions";
+    exit_frames_[exit_frame_count_++] = has_returned;
   }
 
-  void HandleInstruction(unsigned int address) {
-    CHECK_NE(address, 0) << "Reset";
+  void EnableInstructionHook(bool trace) override {
+    if (!kHasInstructionHook) {
+      LOG(WARNING) << "Musashi was built without the instruction hook "
+                      "(CYDER_INSTRUCTION_HOOK=OFF) so single-stepping and "
+                      "tracing are unavailable";
+      return;
+    }
+    trace_instructions_ = trace;
+    m68k_set_instr_hook_callback(cpu_instr_callback);
+  }
 
-    // Check that the stack pointer is within the bounds of the stack.
-    CHECK(m68k_get_reg(NULL, M68K_REG_ISP) <= cyder::memory::kStackStart);
-    CHECK(m68k_get_reg(NULL, M68K_REG_ISP) > cyder::memory::kStackEnd);
+  uint64_t instructions_run() const override {
+    return instructions_run_ + BlockCache::Instance().instructions_run();
+  }
+
+  void SetMemoryAccess(MemoryAccess access) override {
+    memory_access_ = access;
+    ApplyMemoryAccess();
+  }
+
+  void EnableExecutionStats() override {
+    execution_stats_ = &ExecutionStats::Instance();
+    ApplyMemoryAccess();
+  }
+
+  void EnableBlockCache(bool enable) override { use_block_cache_ = enable; }
+
+  void EnableDirectTraps(bool enable) override { use_direct_traps_ = enable; }
+
+  void EnableVblInterrupt() override {
+    RegisterNativeFunction(memory::VblInterruptAddress(), [this]() {
+      // The IRQ line must be lowered before `RTE` restores the interrupt mask
+      // or the interrupt would immediately be taken again.
+      SetIrqLevel(0);
+      ReturnFromException();
+      // VBL tasks are emulated functions (which run the emulator) so the next
+      // interrupt is held off until they return rather than nesting in them.
+      CHECK(!in_vertical_blank_) << "Nested VBL interrupt";
+      in_vertical_blank_ = true;
+      CHECK_OK(VerticalRetraceManager::Instance().OnVerticalBlank(
+          Scheduler::Instance().NowTicks()));
+      in_vertical_blank_ = false;
+    });
+    CHECK_OK(memory::kSystemMemory.Write<uint32_t>(
+        kVblInterruptVector, memory::VblInterruptAddress()));
+    use_vbl_interrupt_ = true;
+  }
+
+  bool ConsumeNonStackWrites() override {
+    return std::exchange(has_non_stack_writes, false);
+  }
+
+  void SaveState(core::SnapshotWriter& writer) const override {
+    for (m68k_register_t reg : kSavedRegisters)
+      writer.Write<uint32_t>(m68k_get_reg(NULL, reg));
+    writer.Write<uint32_t>(irq_level_);
+  }
+
+  absl::Status RestoreState(core::SnapshotReader& reader) override {
+    for (m68k_register_t reg : kSavedRegisters)
+      m68k_set_reg(reg, TRY(reader.Read<uint32_t>()));
+    auto irq_level = TRY(reader.Read<uint32_t>());
+    if (irq_level > 7) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid interrupt level: ", irq_level));
+    }
+    SetIrqLevel(irq_level);
+    return absl::OkStatus();
+  }
+
+  // Runs Musashi for (at least) `cycles` and returns the cycles run.
+  int Execute(int cycles) {
+    int elapsed = m68k_execute(cycles);
+    // Musashi loses track of the cycles run when a native function ends the
+    // timeslice early so they are recorded when it is reached instead.
+    return native_func_ != nullptr ? native_func_cycles_ : elapsed;
+  }
+
+  // Runs cached blocks where possible falling back to Musashi for everything
+  // else (including native functions which end the timeslice).
+  int RunWithBlockCache(int cycles) {
+    int elapsed = 0;
+    while (elapsed < cycles && native_func_ == nullptr) {
+      int block_cycles = BlockCache::Instance().Execute(cycles - elapsed);
+      if (block_cycles == 0 && use_direct_traps_ && QueueDirectTrap())
+        return elapsed + kDirectTrapCycles;
+      elapsed += block_cycles != 0 ? block_cycles : Execute(kFallbackCycles);
+    }
+    return elapsed;
+  }
+
+  // Queues the A-Trap handler to run (as a native function) if there is an
+  // A-Trap at the PC. The handler expects the PC to be at the A-Trap (as it is
+  // after `RTE`) so the CPU is left as-is.
+  bool QueueDirectTrap() {
+    const uint32_t pc = m68k_get_reg(NULL, M68K_REG_PC);
+    if ((FastRead<uint16_t>(pc) & 0xF000) != 0xA000 || !a_trap_handler_)
+      return false;
+    native_func_ = &a_trap_handler_;
+    return true;
+  }
 
-    uint16_t instruction = MUST(memory::kSystemMemory.Read<uint16_t>(address));
+  // Called by Musashi for `ILLEGAL` (and other unknown) opcodes. Returns true
+  // if `opcode` marks a native function which should run once the timeslice
+  // ends; otherwise the exception is raised in the emulator as usual.
+  bool HandleIllegalInstruction(uint16_t opcode) {
+    if (opcode != kNativeFunctionOpcode)
+      return false;
+
+    // The PC has already been advanced past the instruction at this point.
+    const NativeFunc* func =
+        FindNativeFunction(m68k_get_reg(NULL, M68K_REG_PPC));
+    if (func == nullptr)
+      return false;
 
     // Only one native function should be queued at a time since one being
     // encountered MUST end the timeslice.
-    CHECK(!native_func_.has_value());
-    if ((instruction == 0x4E73 || 0x4E71) &&
-        native_functions_.find(address) != native_functions_.end()) {
-      native_func_ = native_functions_[address];
-      m68k_end_timeslice();
-    }
+    CHECK(native_func_ == nullptr);
+    native_func_ = func;
+    native_func_cycles_ = m68k_cycles_run();
+    m68k_end_timeslice();
+    return true;
+  }
+
+  void HandleInstruction(unsigned int address) {
+    CHECK_NE(address, 0) << "Reset";
+    ++instructions_run_;
+    if (execution_stats)
+      execution_stats->RecordInstruction(address, FastRead<uint16_t>(address));
+
+    // Check that the stack pointer is within the bounds of the stack.
+    CHECK(m68k_get_reg(NULL, M68K_REG_ISP) <= cyder::memory::StackStart());
+    CHECK(m68k_get_reg(NULL, M68K_REG_ISP) > cyder::memory::StackEnd());
 
     bool should_disasseble = ::cyder::Debugger::Instance().OnInstruction();
-    if (kDisassembleInstructions || should_disasseble) {
+    if (trace_instructions_ || should_disasseble) {
       char buffer[255];
       m68k_disassemble(buffer, address, kCpuType);
       printf("0x%x: %s\n", address, buffer);
@@ -117,18 +399,63 @@ class EmulatorImpl : public Emulator {
   }
 
  private:
-  ~EmulatorImpl() override = default;
+  // The memory access globals are process-wide so they are set again for the
+  // machine which is about to run (see `Machine`).
+  void ApplyMemoryAccess() {
+    use_checked_memory = memory_access_ == MemoryAccess::kChecked;
+    execution_stats = execution_stats_;
+    use_slow_memory = use_checked_memory || execution_stats != nullptr;
+  }
 
-  std::map<uint32_t, NativeFunc> native_functions_;
-  absl::optional<NativeFunc> native_func_;
+  // Musashi does not expose the pending interrupt level so it is tracked here.
+  void SetIrqLevel(unsigned int level) {
+    irq_level_ = level;
+    m68k_set_irq(level);
+  }
+
+  static size_t StubIndex(uint32_t address) {
+    return (address - memory::LastEmulatedSubroutineAddress()) /
+           sizeof(uint16_t);
+  }
 
-  std::stack<NativeFunc> exit_funcs_;
+  const NativeFunc* FindNativeFunction(uint32_t address) const {
+    if (address >= memory::LastEmulatedSubroutineAddress() &&
+        address < memory::SystemMemorySize()) {
+      const NativeFunc& func = stub_functions_[StubIndex(address)];
+      return func ? &func : nullptr;
+    }
+    auto entry = native_functions_.find(address);
+    return entry != native_functions_.end() ? &entry->second : nullptr;
+  }
+
+  // Native functions in the stub region (indexed by `StubIndex()`) and those
+  // registered anywhere else (i.e. by tests).
+  std::array<NativeFunc, kStubCount> stub_functions_;
+  std::map<uint32_t, NativeFunc> native_functions_;
+  // The native function to call once the timeslice ends (if any).
+  const NativeFunc* native_func_ = nullptr;
+  int native_func_cycles_ = 0;
+  bool trace_instructions_ = false;
+  uint64_t instructions_run_ = 0;
+  MemoryAccess memory_access_ = MemoryAccess::kChecked;
+  ExecutionStats* execution_stats_ = nullptr;
+  bool use_block_cache_ = false;
+  bool use_direct_traps_ = false;
+  bool use_vbl_interrupt_ = false;
+  // Set while the VBL interrupt is handled (and its tasks run).
+  bool in_vertical_blank_ = false;
+  unsigned int irq_level_ = 0;
+  // The handler registered with `RegisterATrapHandler()` (if any).
+  NativeFunc a_trap_handler_;
+
+  // Set (and popped) when an emulated function returns to native code.
+  std::array<bool*, kMaxExitFrames> exit_frames_;
+  size_t exit_frame_count_ = 0;
 };
 
 // static
 Emulator& Emulator::Instance() {
-  static absl::NoDestructor<EmulatorImpl> instance;
-  return *instance;
+  return Machine::Current().Get<EmulatorImpl>();
 }
 
 void ReturnSubroutine() {
@@ -138,6 +465,13 @@ void ReturnSubroutine() {
 
 }  // namespace cyder
 
+using ::cyder::FastRead;
+using ::cyder::FastWrite;
+using ::cyder::SlowFetch;
+using ::cyder::SlowRead;
+using ::cyder::SlowWrite;
+using ::cyder::instruction_count;
+using ::cyder::use_slow_memory;
 using ::cyder::memory::kSystemMemory;
 
 extern "C" {
@@ -153,35 +487,68 @@ unsigned int m68k_read_disassembler_32(unsigned int address) {
   return MUST(kSystemMemory.Read<uint32_t>(address));
 }
 unsigned int m68k_read_memory_8(unsigned int address) {
-  // cyder::memory::CheckReadAccess(address);
-  return MUST(kSystemMemory.Read<uint8_t>(address));
+  if (ABSL_PREDICT_TRUE(!use_slow_memory))
+    return FastRead<uint8_t>(address);
+  return SlowRead<uint8_t>(address);
 }
 unsigned int m68k_read_memory_16(unsigned int address) {
-  // cyder::memory::CheckReadAccess(address);
-  return MUST(kSystemMemory.Read<uint16_t>(address));
+  if (ABSL_PREDICT_TRUE(!use_slow_memory))
+    return FastRead<uint16_t>(address);
+  return SlowRead<uint16_t>(address);
 }
 unsigned int m68k_read_memory_32(unsigned int address) {
-  // cyder::memory::CheckReadAccess(address);
-  return MUST(kSystemMemory.Read<uint32_t>(address));
+  if (ABSL_PREDICT_TRUE(!use_slow_memory))
+    return FastRead<uint32_t>(address);
+  return SlowRead<uint32_t>(address);
+}
+unsigned int m68k_read_immediate_16(unsigned int address) {
+  if (ABSL_PREDICT_TRUE(!use_slow_memory))
+    return FastRead<uint16_t>(address);
+  return SlowFetch<uint16_t>(address);
+}
+unsigned int m68k_read_immediate_32(unsigned int address) {
+  if (ABSL_PREDICT_TRUE(!use_slow_memory))
+    return FastRead<uint32_t>(address);
+  return SlowFetch<uint32_t>(address);
+}
+// PC-relative operands are data which happens to live alongside the code.
+unsigned int m68k_read_pcrelative_8(unsigned int address) {
+  return m68k_read_memory_8(address);
+}
+unsigned int m68k_read_pcrelative_16(unsigned int address) {
+  return m68k_read_memory_16(address);
+}
+unsigned int m68k_read_pcrelative_32(unsigned int address) {
+  return m68k_read_memory_32(address);
 }
 void m68k_write_memory_8(unsigned int address, unsigned int value) {
-  cyder::memory::CheckWriteAccess(address, value);
-  CHECK_OK(kSystemMemory.Write<uint8_t>(address, value))
-      << " unable to write " << std::hex << value << " to " << address;
+  cyder::RecordStore(address);
+  if (ABSL_PREDICT_TRUE(!use_slow_memory))
+    return FastWrite<uint8_t>(address, value);
+  SlowWrite<uint8_t>(address, value);
 }
 void m68k_write_memory_16(unsigned int address, unsigned int value) {
-  cyder::memory::CheckWriteAccess(address, value);
-  CHECK_OK(kSystemMemory.Write<uint16_t>(address, value))
-      << " unable to write " << std::hex << value << " to " << address;
+  cyder::RecordStore(address);
+  if (ABSL_PREDICT_TRUE(!use_slow_memory))
+    return FastWrite<uint16_t>(address, value);
+  SlowWrite<uint16_t>(address, value);
 }
 void m68k_write_memory_32(unsigned int address, unsigned int value) {
-  cyder::memory::CheckWriteAccess(address, value);
-  CHECK_OK(kSystemMemory.Write<uint32_t>(address, value))
-      << " unable to write " << std::hex << value << " to " << address;
+  cyder::RecordStore(address);
+  if (ABSL_PREDICT_TRUE(!use_slow_memory))
+    return FastWrite<uint32_t>(address, value);
+  SlowWrite<uint32_t>(address, value);
+}
+void cpu_count_instr_callback(unsigned int pc) {
+  ++*instruction_count;
 }
 void cpu_instr_callback(unsigned int pc) {
   static_cast<cyder::EmulatorImpl&>(cyder::Emulator::Instance())
       .HandleInstruction(pc);
 }
+int cpu_illegal_instr_callback(int opcode) {
+  return static_cast<cyder::EmulatorImpl&>(cyder::Emulator::Instance())
+      .HandleIllegalInstruction(opcode);
+}
 
 }  // extern "C"
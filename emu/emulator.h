@@ -2,16 +2,39 @@
 
 #include <cstdint>
 #include <functional>
+#include <type_traits>
 
+#include "absl/status/status.h"
+#include "core/snapshot.h"
 #include "emu/memory/memory_map.h"
 #include "emu/trap/stack_helpers.h"
 
 namespace cyder {
 
+// Whether Musashi is built with the instruction hook (see
+// `Emulator::EnableInstructionHook()`) which is also what counts the
+// instructions Musashi runs. Without it only instructions run from cached
+// blocks are counted so `Emulator::instructions_run()` is a partial count.
+#ifdef CYDER_NO_INSTRUCTION_HOOK
+constexpr bool kHasInstructionHook = false;
+#else
+constexpr bool kHasInstructionHook = true;
+#endif  // CYDER_NO_INSTRUCTION_HOOK
+
 class Emulator {
  public:
   using NativeFunc = std::function<void()>;
 
+  enum class MemoryAccess {
+    // Emulated reads/writes go through `memory::kSystemMemory` so they are
+    // bounds checked, reported to the `MemoryWatcher`, and writes are
+    // validated by `memory::CheckWriteAccess()`.
+    kChecked,
+    // Emulated reads/writes go directly to `memory::kSystemMemoryRaw` with
+    // addresses wrapped to the size of system memory.
+    kFast,
+  };
+
   static Emulator& Instance();
   virtual ~Emulator() = default;
 
@@ -20,14 +43,16 @@ class Emulator {
   // determined the initial program counter (PC) and A5 world position.
   virtual void Init(unsigned int pc) = 0;
 
-  // Runs the emulator for a single timeslice (1000 cycles) or until a native
-  // function is encountered (ending the in-progress timeslice).
+  // Runs the emulator for a single timeslice or until a native function is
+  // encountered (ending the in-progress timeslice). The timeslice is split in
+  // to quanta (see `Scheduler`) between which the VBL interrupt is raised.
   virtual void Run() = 0;
 
-  // Writes `NOP` to the given address and registers a native function
+  // Writes `ILLEGAL` to the given address and registers a native function
   // to be called when the emulator reaches that address during execution.
   // Native functions are expected to perform an `RTS` (return from subroutine)
   // before returning control to the emulator (see `ReturnSubroutine()`).
+  // Functions are called in place so one must not be replaced while it runs.
   virtual void RegisterNativeFunction(uint32_t address, NativeFunc func) = 0;
 
   // Specialized form of `RegisterNativeFunction()` that registers a handler
@@ -36,10 +61,57 @@ class Emulator {
   // necessary trap handling and return control to the emulator.
   virtual void RegisterATrapHandler(NativeFunc handler) = 0;
 
-  // Registers `func` to run when `memory::kEndFunctionCallAddress` is invoked.
-  // Multiple `func`s can be registered and run in FILO (stack) ordering. This
-  // is used by `CallFunction<>()` to end functions (accounts for nesting).
-  virtual void RegisterExitFunction(NativeFunc func) = 0;
+  // Installs the per-instruction hook which is needed to single-step in the
+  // debugger and, if `trace` is set, to disassemble every instruction. The
+  // hook is off by default and is unavailable when Musashi is built without
+  // it (`-DCYDER_INSTRUCTION_HOOK=OFF`).
+  virtual void EnableInstructionHook(bool trace) = 0;
+
+  // The number of instructions executed (by Musashi or from cached blocks).
+  // Musashi only counts instructions when built with the instruction hook so
+  // this is partial unless `kHasInstructionHook`.
+  virtual uint64_t instructions_run() const = 0;
+
+  // Selects how the emulated CPU accesses memory (defaults to `kChecked`).
+  virtual void SetMemoryAccess(MemoryAccess access) = 0;
+
+  // Feeds every memory access and (while the instruction hook is installed)
+  // every instruction to `ExecutionStats`. This takes the slow memory path.
+  virtual void EnableExecutionStats() = 0;
+
+  // Runs straight-line code from the `BlockCache` where possible (Musashi runs
+  // everything else). Cached code is not seen by the instruction hook so this
+  // should not be enabled while debugging or tracing. Off by default.
+  virtual void EnableBlockCache(bool enable) = 0;
+
+  // Calls the A-Trap handler (see `RegisterATrapHandler()`) directly for
+  // A-Traps reached at the PC between cached blocks instead of letting Musashi
+  // raise the line 1010 exception, vector through $28 and `RTE` back. Handlers
+  // see the same registers and stack either way. Needs the block cache (traps
+  // reached while Musashi is running still raise the exception). Off by
+  // default.
+  virtual void EnableDirectTraps(bool enable) = 0;
+
+  // Installs the level 1 (VBL) interrupt handler which is raised every tick
+  // to run the `VerticalRetraceManager`. Off by default.
+  virtual void EnableVblInterrupt() = 0;
+
+  // Returns whether the emulated CPU has stored anywhere outside of the stack
+  // since this was last called (used to detect idle applications).
+  virtual bool ConsumeNonStackWrites() = 0;
+
+  // Pushes a frame which sets `*has_returned` once the emulated function
+  // returns to `memory::EndFunctionCallAddress()`. Frames are popped in FILO
+  // (stack) order. This is used by `CallFunction<>()` to end functions
+  // (accounts for nesting) without allocating or registering anything.
+  virtual void PushExitFrame(bool* has_returned) = 0;
+
+  // Saves/restores the architectural registers (D0-D7, A0-A7, PC, SR, USP and
+  // ISP) and the pending interrupt level. Musashi's own context holds host
+  // pointers (callbacks, opcode tables) so it is never saved; registers are
+  // restored into whatever CPU is active (which may be freshly reset).
+  virtual void SaveState(core::SnapshotWriter& writer) const = 0;
+  virtual absl::Status RestoreState(core::SnapshotReader& reader) = 0;
 };
 
 // Emulates the `RTS` (return from subroutine) instruction for native code.
@@ -53,24 +125,28 @@ ReturnType CallFunction(uint32_t func_entry, Args&&... args) {
 
   // The emulated function should end with `RTS` which will pop the address of
   // the "calling" function off the stack and jump to it. We want to "jump" back
-  // to native code so we push `memory::kEndFunctionCallAddress` to `RTS` to
+  // to native code so we push `memory::EndFunctionCallAddress()` to `RTS` to
   // which ends the current emulator timeslice and allows us to grab the return
   // value off the stack and restore the actual `PC` saved above.
   bool function_has_returned = false;
-  Emulator::Instance().RegisterExitFunction(
-      [&function_has_returned]() { function_has_returned = true; });
+  Emulator::Instance().PushExitFrame(&function_has_returned);
 
-  trap::Push<ReturnType>(0);  // Placeholder for return value
+  if constexpr (!std::is_void_v<ReturnType>)
+    trap::Push<ReturnType>(0);  // Placeholder for return value
   (trap::Push(std::forward<Args>(args)), ...);
-  trap::Push<uint32_t>(memory::kEndFunctionCallAddress);
+  trap::Push<uint32_t>(memory::EndFunctionCallAddress());
   m68k_set_reg(M68K_REG_PC, func_entry);
 
   while (!function_has_returned) {
     Emulator::Instance().Run();
   }
-  auto return_type = trap::Pop<ReturnType>();
-  ReturnSubroutine();
-  return return_type;
+  if constexpr (std::is_void_v<ReturnType>) {
+    ReturnSubroutine();
+  } else {
+    auto return_type = trap::Pop<ReturnType>();
+    ReturnSubroutine();
+    return return_type;
+  }
 }
 
 }  // namespace cyder
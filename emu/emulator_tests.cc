@@ -9,11 +9,17 @@
 
 #include "absl/status/status.h"
 #include "core/literal_helpers.h"
+#include "core/snapshot.h"
+#include "core/status_helpers.h"
 #include "emu/emulator.h"
+#include "emu/machine.h"
 #include "emu/memory/memory_map.h"
+#include "emu/scheduler.h"
 #include "emu/trap/stack_helpers.h"
 #include "emu/trap/trap_dispatcher.h"
 #include "emu/trap/trap_manager.h"
+#include "emu/vertical_retrace.h"
+#include "gen/typegen/generated_types.tdef.h"
 #include "third_party/musashi/src/m68k.h"
 
 namespace cyder {
@@ -47,6 +53,69 @@ class EmulatorTests : public ::testing::Test {
   trap::TrapManager trap_manager;
 };
 
+TEST_F(EmulatorTests, RegisterNativeFunction) {
+  auto& emulator = Emulator::Instance();
+  emulator.Init(0x3000);
+
+  bool was_called = false;
+  emulator.RegisterNativeFunction(0x3000,
+                                  [&was_called]() { was_called = true; });
+
+  emulator.Run();
+
+  EXPECT_TRUE(was_called);
+  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_PC), 0x3002);  // Advanced past stub
+}
+
+TEST_F(EmulatorTests, ReplaceNativeFunctionInStubRegion) {
+  auto& emulator = Emulator::Instance();
+  const uint32_t stub_address = memory::LastEmulatedSubroutineAddress();
+
+  int called = 0;
+  emulator.RegisterNativeFunction(stub_address, [&called]() { called = 1; });
+  emulator.RegisterNativeFunction(stub_address, [&called]() { called = 2; });
+
+  emulator.Init(stub_address);
+  emulator.Run();
+
+  EXPECT_EQ(called, 2);
+}
+
+TEST_F(EmulatorTests, FastMemoryAccess) {
+  auto& emulator = Emulator::Instance();
+  emulator.SetMemoryAccess(Emulator::MemoryAccess::kFast);
+
+  m68k_write_memory_32(0x2000, 0x12345678);
+  EXPECT_EQ(MUST(memory::kSystemMemory.Read<uint32_t>(0x2000)), 0x12345678);
+  EXPECT_EQ(m68k_read_memory_16(0x2002), 0x5678);
+  EXPECT_EQ(m68k_read_memory_8(0x2001), 0x34);
+
+  // Addresses wrap to the size of system memory.
+  EXPECT_EQ(m68k_read_memory_32(memory::SystemMemorySize() + 0x2000),
+            0x12345678);
+
+  emulator.SetMemoryAccess(Emulator::MemoryAccess::kChecked);
+}
+
+TEST_F(EmulatorTests, ConsumeNonStackWrites) {
+  auto& emulator = Emulator::Instance();
+  emulator.SetMemoryAccess(Emulator::MemoryAccess::kFast);
+  emulator.ConsumeNonStackWrites();
+
+  m68k_write_memory_32(memory::StackEnd(), 0x12345678);
+  m68k_write_memory_16(memory::StackStart() - 2, 0x1234);
+  EXPECT_FALSE(emulator.ConsumeNonStackWrites());
+
+  m68k_write_memory_8(memory::kHeapStart, 0x12);
+  EXPECT_TRUE(emulator.ConsumeNonStackWrites());
+  EXPECT_FALSE(emulator.ConsumeNonStackWrites());
+
+  m68k_write_memory_8(memory::StackStart(), 0x12);
+  EXPECT_TRUE(emulator.ConsumeNonStackWrites());
+
+  emulator.SetMemoryAccess(Emulator::MemoryAccess::kChecked);
+}
+
 TEST_F(EmulatorTests, CallNativeToolboxTrap) {
   auto& emulator = Emulator::Instance();
   emulator.Init(0x1000);
@@ -60,7 +129,7 @@ TEST_F(EmulatorTests, CallNativeToolboxTrap) {
   emulator.Run();
 
   EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_PC), 0x1002);  // Advanced past A-Trap
-  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_SP), memory::kStackStart);
+  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_SP), memory::StackStart());
 }
 
 TEST_F(EmulatorTests, CallNativeSystemTrap) {
@@ -75,13 +144,34 @@ TEST_F(EmulatorTests, CallNativeSystemTrap) {
 
   emulator.Run();
 
-  // The routine at `kTrapManagerExitAddress` MUST be executed for system traps.
-  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_PC), memory::kTrapManagerExitAddress);
+  // The routine at `TrapManagerExitAddress()` MUST run for system traps.
+  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_PC), memory::TrapManagerExitAddress());
+
+  emulator.Run();
+
+  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_PC), 0x1002);  // Advanced past A-Trap
+  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_SP), memory::StackStart());
+}
+
+TEST_F(EmulatorTests, CallNativeTrapDirectly) {
+  auto& emulator = Emulator::Instance();
+  emulator.Init(0x1000);
+  emulator.EnableBlockCache(true);
+  emulator.EnableDirectTraps(true);
+
+  EXPECT_CALL(mock_trap_dispatcher_, Dispatch(Trap::EraseOval))
+      .WillOnce(Return(absl::OkStatus()));
+
+  // Musashi never runs the A-Trap (it would raise the line 1010 exception)
+  CHECK_OK(memory::kSystemMemory.Write<uint16_t>(0x1000, Trap::EraseOval));
 
   emulator.Run();
 
   EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_PC), 0x1002);  // Advanced past A-Trap
-  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_SP), memory::kStackStart);
+  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_SP), memory::StackStart());
+
+  emulator.EnableDirectTraps(false);
+  emulator.EnableBlockCache(false);
 }
 
 TEST_F(EmulatorTests, CallFunction) {
@@ -120,13 +210,13 @@ TEST_F(EmulatorTests, CallFunction) {
     auto result = CallFunction<uint16_t>(0x1000, true, 24_u16, 13_u16);
     EXPECT_EQ(result, 37_u16);
     EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_PC), 0xDEADBEEF);
-    EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_SP), memory::kStackStart);
+    EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_SP), memory::StackStart());
   }
   {
     auto result = CallFunction<uint16_t>(0x1000, false, 24_u16, 13_u16);
     EXPECT_EQ(result, 11_u16);
     EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_PC), 0xDEADBEEF);
-    EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_SP), memory::kStackStart);
+    EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_SP), memory::StackStart());
   }
 }
 
@@ -213,5 +303,77 @@ TEST_F(EmulatorTests, CallFunctionNested) {
   emulator.Run();
 }
 
+TEST_F(EmulatorTests, RestoreStateIntoResetCpu) {
+  auto& emulator = Emulator::Instance();
+  emulator.Init(0x1000);
+  for (int i = 0; i < 8; ++i) {
+    m68k_set_reg(static_cast<m68k_register_t>(M68K_REG_D0 + i), 0x100 + i);
+    m68k_set_reg(static_cast<m68k_register_t>(M68K_REG_A0 + i), 0x200 + i);
+  }
+  m68k_set_reg(M68K_REG_USP, 0x3000);
+
+  core::SnapshotWriter writer;
+  emulator.SaveState(writer);
+  // Only registers are saved (no host pointers from Musashi's context).
+  EXPECT_EQ(writer.data().size(), 21 * sizeof(uint32_t));
+
+  Machine machine;
+  Machine::Activation activation(machine);
+  m68k_pulse_reset();
+  ASSERT_NE(m68k_get_reg(NULL, M68K_REG_PC), 0x1000);
+
+  core::SnapshotReader reader(writer.data());
+  CHECK_OK(Emulator::Instance().RestoreState(reader));
+  EXPECT_TRUE(reader.at_end());
+
+  for (int i = 0; i < 8; ++i) {
+    EXPECT_EQ(
+        m68k_get_reg(NULL, static_cast<m68k_register_t>(M68K_REG_D0 + i)),
+        0x100u + i);
+    EXPECT_EQ(
+        m68k_get_reg(NULL, static_cast<m68k_register_t>(M68K_REG_A0 + i)),
+        0x200u + i);
+  }
+  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_USP), 0x3000u);
+  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_PC), 0x1000u);
+  EXPECT_TRUE(m68k_get_reg(NULL, M68K_REG_SR) & (1 << 13));
+
+  core::SnapshotWriter restored;
+  Emulator::Instance().SaveState(restored);
+  EXPECT_EQ(restored.data(), writer.data());
+}
+
+TEST(EmulatorMachineTests, RunsVblTasksOnNewMachine) {
+  // A new machine starts from a reset CPU which masks every interrupt level
+  Machine machine;
+  Machine::Activation activation(machine);
+  Scheduler::Instance().SetClockMode(Scheduler::ClockMode::kVirtual);
+  auto& emulator = Emulator::Instance();
+  emulator.Init(0x1000);
+  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_SR), 0x2000u);
+  emulator.EnableVblInterrupt();
+
+  constexpr uint32_t kCounter = 0x2100;
+  constexpr uint32_t kTask = 0x3000;
+  CHECK_OK(memory::kSystemMemory.Write<uint16_t>(0x1000, 0x60FE));  // bra.s *
+  CHECK_OK(memory::kSystemMemory.Write<uint16_t>(kCounter, 0));
+  CHECK_OK(memory::kSystemMemory.Write<uint16_t>(0x2000, 0x5278));  // addq.w
+  CHECK_OK(memory::kSystemMemory.Write<uint16_t>(0x2002, kCounter));  // #1,$.w
+  CHECK_OK(memory::kSystemMemory.Write<uint16_t>(0x2004, 0x4E75));    // rts
+
+  VBLTask task;
+  task.qLink = 0;
+  task.qType = 1;  // vType
+  task.vblAddr = 0x2000;
+  task.vblCount = 1;
+  task.vblPhase = 0;
+  CHECK_OK(WriteType<VBLTask>(task, memory::kSystemMemory, kTask));
+  EXPECT_EQ(MUST(VerticalRetraceManager::Instance().Install(kTask)), 0);
+
+  for (int i = 0; i < 4; ++i)
+    emulator.Run();
+  EXPECT_EQ(MUST(memory::kSystemMemory.Read<uint16_t>(kCounter)), 1u);
+}
+
 }  // namespace
 }  // namespace cyder
@@ -4,20 +4,25 @@
 #include <mutex>
 
 #include "emu/event_manager.h"
+#include "emu/machine.h"
+#include "emu/scheduler.h"
 
 extern bool single_step;
 
 namespace cyder {
 namespace {
 
+bool HasMouseLocation(const EventRecord& event) {
+  return event.what == kMouseDown || event.what == kMouseUp ||
+         event.what == kMouseMove;
+}
+
 EventRecord NullEvent() {
   static EventRecord null_event;
   null_event.what = 0 /* nullEvent */;
   return null_event;
 }
 
-EventManager* s_instance;
-
 }  // namespace
 
 class EventManager::MouseMoveEnablerImpl
@@ -32,13 +37,17 @@ class EventManager::MouseMoveEnablerImpl
   EventManager& manager_;
 };
 
-EventManager::EventManager() {
-  s_instance = this;
+EventManager::EventManager() : machine_(Machine::Current()) {
+  machine_.Register(this);
+}
+
+EventManager::~EventManager() {
+  machine_.Unregister(this);
 }
 
 // static
 EventManager& EventManager::the() {
-  return *s_instance;
+  return Machine::Current().GetRegistered<EventManager>();
 }
 
 void EventManager::QueueWindowActivate(Ptr window, ActivateState state) {
@@ -69,6 +78,8 @@ void EventManager::QueueWindowUpdate(Ptr window) {
 }
 
 void EventManager::QueueMouseDown(int x, int y) {
+  SetHostMouseLocation(x, y);
+
   Point where;
   where.x = x;
   where.y = y;
@@ -77,13 +88,12 @@ void EventManager::QueueMouseDown(int x, int y) {
   record.what = kMouseDown;
   record.where = where;
   record.when = NowTicks();
-
-  std::lock_guard<std::mutex> lock(event_mutex_);
-  input_events_.push_back(std::move(record));
-  event_condition_.notify_all();
+  QueueHostEvent(std::move(record));
 }
 
 void EventManager::QueueMouseUp(int x, int y) {
+  SetHostMouseLocation(x, y);
+
   Point where;
   where.x = x;
   where.y = y;
@@ -92,10 +102,7 @@ void EventManager::QueueMouseUp(int x, int y) {
   record.what = kMouseUp;
   record.where = where;
   record.when = NowTicks();
-
-  std::lock_guard<std::mutex> lock(event_mutex_);
-  input_events_.push_back(std::move(record));
-  event_condition_.notify_all();
+  QueueHostEvent(std::move(record));
 }
 
 void EventManager::QueueKeyDown() {
@@ -103,10 +110,7 @@ void EventManager::QueueKeyDown() {
   record.what = kKeyDown;
   record.when = NowTicks();
   // FIXME: Add keycode information in EventRecord::message
-
-  std::lock_guard<std::mutex> lock(event_mutex_);
-  input_events_.push_back(std::move(record));
-  event_condition_.notify_all();
+  QueueHostEvent(std::move(record));
 }
 
 void EventManager::QueueRawEvent(uint16_t raw_event_type, uint32_t message) {
@@ -139,6 +143,8 @@ EventRecord EventManager::WaitNextEvent(uint16_t event_mask, uint32_t timeout) {
       if (is_shutting_down_)
         return true;
 
+      AcceptInputEvents();
+
       // Check if any event matching the mask is available
       if (!activate_events_.empty() && (event_mask & 256 /*activMask*/)) {
         return true;
@@ -163,11 +169,20 @@ EventRecord EventManager::WaitNextEvent(uint16_t event_mask, uint32_t timeout) {
     if (is_shutting_down_)
       return NullEvent();
 
+    Scheduler& scheduler = Scheduler::Instance();
+    // Nothing is waited on when fast-forwarding (or replaying): the timeout is
+    // assumed to have passed and the (virtual) clock skips ahead instead.
+    if ((scheduler.fast_forward() || is_replaying_) && !has_event_pred()) {
+      scheduler.SkipTicks(timeout);
+      return NullEvent();
+    }
+
 #if true
     bool event_available =
         event_condition_.wait_for(lock, std::chrono::milliseconds(timeout * 16),
                                   std::move(has_event_pred));
     if (!event_available) {
+      scheduler.SkipTicks(timeout);
       return NullEvent();
     }
 #else
@@ -199,6 +214,8 @@ EventRecord EventManager::GetNextEvent(uint16_t event_mask) {
   // Event masks can be calculated from the type and are documented here:
   // http://0.0.0.0:8000/docs/mac/Toolbox/Toolbox-38.html#MARKER-9-112
   std::lock_guard<std::mutex> lock(event_mutex_);
+  has_polled_events_ = true;
+  AcceptInputEvents();
 
   if (!activate_events_.empty() && (event_mask & 256 /*activMask*/)) {
     auto event = activate_events_.front();
@@ -232,28 +249,44 @@ EventRecord EventManager::GetNextEvent(uint16_t event_mask) {
 }
 
 uint32_t EventManager::NowTicks() const {
-  // TODO: Read from GlobalVar::Ticks which should be set every 1/60th secs
-  static absl::Time boot_time = absl::Now();
-  auto elapsed_time_ms = absl::ToInt64Milliseconds(absl::Now() - boot_time);
-  return elapsed_time_ms / 16;
+  return Scheduler::Instance().NowTicks();
 }
 
-bool EventManager::HasMouseEvent(EventType type) const {
+bool EventManager::HasMouseEvent(EventType type) {
   CHECK(type == kMouseDown || type == kMouseUp);
 
   std::lock_guard<std::mutex> lock(event_mutex_);
+  AcceptInputEvents();
   return std::find_if(input_events_.begin(), input_events_.end(),
                       [type](const EventRecord& event) {
                         return event.what == type;
                       }) != input_events_.end();
 }
 
+Point EventManager::GetMouseLocation() {
+  std::lock_guard<std::mutex> lock(event_mutex_);
+  AcceptInputEvents();
+  return mouse_location_;
+}
+
+void EventManager::WaitForInput(absl::Duration timeout) {
+  std::unique_lock<std::mutex> lock(event_mutex_);
+  if (is_replaying_)
+    return;
+  event_condition_.wait_for(lock, absl::ToChronoNanoseconds(timeout), [this]() {
+    return is_shutting_down_ || !host_events_.empty() ||
+           !activate_events_.empty() || !update_events_.empty();
+  });
+}
+
 std::unique_ptr<EventManager::MouseMoveEnabler>
 EventManager::EnableMouseMove() {
   return std::make_unique<MouseMoveEnablerImpl>(*this);
 }
 
 void EventManager::OnMouseMove(int x, int y) {
+  SetHostMouseLocation(x, y);
+
   Point where;
   where.x = x;
   where.y = y;
@@ -263,10 +296,79 @@ void EventManager::OnMouseMove(int x, int y) {
   record.where = where;
   record.when = NowTicks();
 
+  {
+    std::lock_guard<std::mutex> lock(event_mutex_);
+    if (!mouse_move_enabled_)
+      return;
+  }
+  QueueHostEvent(std::move(record));
+}
+
+void EventManager::StartRecording(std::unique_ptr<InputLogWriter> log) {
+  std::lock_guard<std::mutex> lock(event_mutex_);
+  input_log_ = std::move(log);
+}
+
+void EventManager::StartReplay(std::vector<InputLogEntry> entries) {
+  std::lock_guard<std::mutex> lock(event_mutex_);
+  replay_entries_.assign(entries.begin(), entries.end());
+  is_replaying_ = true;
+}
+
+void EventManager::QueueHostEvent(EventRecord record) {
   std::lock_guard<std::mutex> lock(event_mutex_);
-  if (mouse_move_enabled_) {
+  if (is_replaying_)
+    return;
+  host_events_.push_back(std::move(record));
+  event_condition_.notify_all();
+}
+
+void EventManager::SetHostMouseLocation(int x, int y) {
+  std::lock_guard<std::mutex> lock(event_mutex_);
+  host_mouse_location_.x = x;
+  host_mouse_location_.y = y;
+}
+
+void EventManager::AcceptInputEvents() {
+  if (is_replaying_) {
+    const uint32_t now = NowTicks();
+    while (!replay_entries_.empty() && replay_entries_.front().tick <= now) {
+      const EventRecord& event = replay_entries_.front().event;
+      if (event.what == kNullEvent || HasMouseLocation(event))
+        mouse_location_ = event.where;
+      // Null events only record the location of the mouse
+      if (event.what != kNullEvent)
+        input_events_.push_back(event);
+      replay_entries_.pop_front();
+    }
+    return;
+  }
+
+  for (auto& record : host_events_) {
+    if (input_log_)
+      input_log_->Write({NowTicks(), record});
+    if (HasMouseLocation(record))
+      mouse_location_ = record.where;
     input_events_.push_back(std::move(record));
   }
+  host_events_.clear();
+
+  // Sampling once per tick keeps the location constant within a tick which is
+  // the granularity at which replays can reproduce it.
+  const uint32_t now = NowTicks();
+  if (mouse_location_tick_ == now)
+    return;
+  mouse_location_tick_ = now;
+  if (host_mouse_location_.x == mouse_location_.x &&
+      host_mouse_location_.y == mouse_location_.y) {
+    return;
+  }
+  mouse_location_ = host_mouse_location_;
+  if (input_log_) {
+    EventRecord record = NullEvent();
+    record.where = mouse_location_;
+    input_log_->Write({now, record});
+  }
 }
 
 void EventManager::PrintEvents() const {
@@ -4,10 +4,17 @@
 #pragma once
 
 #include <condition_variable>
+#include <deque>
 #include <list>
+#include <memory>
 #include <mutex>
+#include <optional>
+#include <vector>
 
+#include "absl/time/time.h"
 #include "emu/event_manager.tdef.h"
+#include "emu/input_log.h"
+#include "emu/machine.h"
 
 namespace cyder {
 
@@ -34,6 +41,7 @@ constexpr Integer kMouseMove = 10;
 class EventManager final {
  public:
   explicit EventManager();
+  ~EventManager();
 
   static EventManager& the();
 
@@ -49,7 +57,16 @@ class EventManager final {
   EventRecord GetNextEvent(uint16_t event_mask);
   uint32_t NowTicks() const;
 
-  bool HasMouseEvent(EventType type) const;
+  bool HasMouseEvent(EventType type);
+
+  // Returns the location of the mouse in global coordinates. The host location
+  // is sampled at most once per tick and is recorded to (and replayed from) the
+  // input log so that replays see the same location at the same tick.
+  Point GetMouseLocation();
+
+  // Blocks the (emulator) thread for up to `timeout` or until there is input
+  // or a window event to handle. Returns immediately while replaying.
+  void WaitForInput(absl::Duration timeout);
 
   class MouseMoveEnabler {
    public:
@@ -62,6 +79,22 @@ class EventManager final {
   bool has_window_events() const {
     return !activate_events_.empty() || !update_events_.empty();
   }
+  // Whether the application has asked for an event yet (it has initialized).
+  bool has_polled_events() const { return has_polled_events_; }
+
+  // Host input (mouse and keyboard events) is accepted into the event queue
+  // the next time the emulator looks at it. The tick at which each event is
+  // accepted is written to `log` so that it can be replayed.
+  void StartRecording(std::unique_ptr<InputLogWriter> log);
+  // Accepts the recorded `entries` (instead of host input) once the tick they
+  // were recorded at is reached. Waiting for an event skips ticks instead of
+  // sleeping so replays run with the virtual clock are deterministic.
+  void StartReplay(std::vector<InputLogEntry> entries);
+  // Whether there are entries still to be replayed.
+  bool has_pending_replay() const {
+    std::lock_guard<std::mutex> lock(event_mutex_);
+    return !replay_entries_.empty();
+  }
 
   void PrintEvents() const;
   void Shutdown() {
@@ -81,13 +114,33 @@ class EventManager final {
     mouse_move_enabled_ = false;
   }
 
+  // Queues an event from the host (ignored while replaying).
+  void QueueHostEvent(EventRecord record);
+  void SetHostMouseLocation(int x, int y);
+  // Moves host (or replayed) events into `input_events_`. Must be called by
+  // the emulator thread with `event_mutex_` held.
+  void AcceptInputEvents();
+
   mutable std::mutex event_mutex_;  // Protects member variables below.
   std::condition_variable event_condition_;
   std::list<EventRecord> activate_events_;
   std::list<EventRecord> input_events_;
   std::list<EventRecord> update_events_;
+  std::list<EventRecord> host_events_;
+  std::unique_ptr<InputLogWriter> input_log_;
+  std::deque<InputLogEntry> replay_entries_;
+  // The latest location reported by the host and the location last accepted
+  // (at `mouse_location_tick_`) which is what the application sees.
+  Point host_mouse_location_;
+  Point mouse_location_;
+  std::optional<uint32_t> mouse_location_tick_;
+  bool is_replaying_ = false;
   bool mouse_move_enabled_ = false;
   bool is_shutting_down_ = false;
+  bool has_polled_events_ = false;
+
+  // The machine this is registered with (until it is destroyed).
+  Machine& machine_;
 };
 
 }  // namespace cyder
\ No newline at end of file
@@ -4,8 +4,16 @@
 #include <gmock/gmock-matchers.h>
 #include <gtest/gtest.h>
 
+#include <thread>
+
 #include "emu/event_manager.h"
 
+#include "absl/time/clock.h"
+#include "core/status_helpers.h"
+#include "emu/input_log.h"
+#include "emu/machine.h"
+#include "emu/scheduler.h"
+
 namespace cyder {
 namespace {
 
@@ -107,4 +115,113 @@ TEST(EventManagerTests, WindowActivate) {
   EXPECT_EQ(second.modifiers, 0 /*deactivated*/);
 }
 
+TEST(EventManagerTests, WaitForInput) {
+  EventManager event_manager;
+
+  // Times out without input
+  event_manager.WaitForInput(absl::Milliseconds(1));
+
+  std::thread input([&event_manager]() {
+    absl::SleepFor(absl::Milliseconds(10));
+    event_manager.QueueMouseDown(1, 2);
+  });
+  event_manager.WaitForInput(absl::InfiniteDuration());
+  input.join();
+  EXPECT_EQ(event_manager.GetNextEvent(kEventEventMask).what, kMouseDown);
+}
+
+TEST(EventManagerTests, RecordAndReplayInput) {
+  const std::string path = testing::TempDir() + "/input.log";
+  {
+    Machine machine;
+    Machine::Activation activation(machine);
+    Scheduler::Instance().SetClockMode(Scheduler::ClockMode::kVirtual);
+
+    EventManager event_manager;
+    event_manager.StartRecording(MUST(InputLogWriter::Open(path)));
+    event_manager.QueueMouseDown(1, 2);
+    Scheduler::Instance().SkipTicks(5);
+    EXPECT_EQ(event_manager.GetNextEvent(kEventEventMask).what, kMouseDown);
+    event_manager.QueueKeyDown();
+    Scheduler::Instance().SkipTicks(3);
+    EXPECT_EQ(event_manager.GetNextEvent(kEventEventMask).what, kKeyDown);
+  }
+
+  auto entries = MUST(ReadInputLog(path));
+  ASSERT_EQ(entries.size(), 2u);
+  EXPECT_EQ(entries[0].tick, 5u);
+  EXPECT_EQ(entries[0].event.what, kMouseDown);
+  EXPECT_EQ(entries[0].event.where.x, 1);
+  EXPECT_EQ(entries[0].event.where.y, 2);
+  EXPECT_EQ(entries[1].tick, 8u);
+  EXPECT_EQ(entries[1].event.what, kKeyDown);
+
+  Machine machine;
+  Machine::Activation activation(machine);
+  Scheduler::Instance().SetClockMode(Scheduler::ClockMode::kVirtual);
+
+  EventManager event_manager;
+  event_manager.StartReplay(std::move(entries));
+  // Host input is ignored while replaying
+  event_manager.QueueMouseUp(0, 0);
+  EXPECT_EQ(event_manager.GetNextEvent(kEventEventMask).what, kNullEvent);
+  EXPECT_TRUE(event_manager.has_pending_replay());
+
+  Scheduler::Instance().SkipTicks(5);
+  EXPECT_TRUE(event_manager.HasMouseEvent(kMouseDown));
+  EXPECT_EQ(event_manager.GetNextEvent(kEventEventMask).what, kMouseDown);
+  // Waiting skips ahead (rather than sleeping) past the next recorded event
+  EXPECT_EQ(event_manager.WaitNextEvent(kEventEventMask, /*timeout=*/10).what,
+            kNullEvent);
+  EXPECT_EQ(event_manager.GetNextEvent(kEventEventMask).what, kKeyDown);
+  EXPECT_FALSE(event_manager.has_pending_replay());
+}
+
+TEST(EventManagerTests, RecordAndReplayMouseLocation) {
+  const std::string path = testing::TempDir() + "/mouse.log";
+  {
+    Machine machine;
+    Machine::Activation activation(machine);
+    Scheduler::Instance().SetClockMode(Scheduler::ClockMode::kVirtual);
+
+    EventManager event_manager;
+    event_manager.StartRecording(MUST(InputLogWriter::Open(path)));
+    event_manager.OnMouseMove(10, 20);
+    Scheduler::Instance().SkipTicks(2);
+    EXPECT_EQ(event_manager.GetMouseLocation().x, 10);
+    // The location is only sampled once per tick
+    event_manager.OnMouseMove(30, 40);
+    EXPECT_EQ(event_manager.GetMouseLocation().x, 10);
+    Scheduler::Instance().SkipTicks(1);
+    EXPECT_EQ(event_manager.GetMouseLocation().x, 30);
+    // Unchanged locations are not recorded
+    Scheduler::Instance().SkipTicks(1);
+    EXPECT_EQ(event_manager.GetMouseLocation().x, 30);
+  }
+
+  auto entries = MUST(ReadInputLog(path));
+  ASSERT_EQ(entries.size(), 2u);
+  EXPECT_EQ(entries[0].tick, 2u);
+  EXPECT_EQ(entries[0].event.what, kNullEvent);
+  EXPECT_EQ(entries[1].tick, 3u);
+  EXPECT_EQ(entries[1].event.where.y, 40);
+
+  Machine machine;
+  Machine::Activation activation(machine);
+  Scheduler::Instance().SetClockMode(Scheduler::ClockMode::kVirtual);
+
+  EventManager event_manager;
+  event_manager.StartReplay(std::move(entries));
+  // The host mouse is ignored while replaying
+  event_manager.OnMouseMove(50, 60);
+  Scheduler::Instance().SkipTicks(2);
+  EXPECT_EQ(event_manager.GetMouseLocation().x, 10);
+  EXPECT_EQ(event_manager.GetMouseLocation().y, 20);
+  Scheduler::Instance().SkipTicks(1);
+  EXPECT_EQ(event_manager.GetMouseLocation().x, 30);
+  EXPECT_EQ(event_manager.GetMouseLocation().y, 40);
+  // Locations are not queued as events
+  EXPECT_EQ(event_manager.GetNextEvent(kEventEventMask).what, kNullEvent);
+}
+
 }  // namespace cyder
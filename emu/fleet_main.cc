@@ -0,0 +1,375 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+// Runs many applications headless (each in its own `emu` process so they use
+// every core) until they are idle and collects a single JSON report:
+//
+//   {"jobs": N, "wall_time_ms": N, "apps": [
+//     {"app": "<path>", "status": "idle", "exit_code": 0, "wall_time_ms": N,
+//      "log": "<path>", "screenshot": "<path>", "input": "<path>",
+//      "stats": {...}}, ...]}
+//
+// `status` is one of "idle" (exited with a report), "exited" (exited without
+// reaching idle), "timeout" or "crashed". `stats` is the `--report_file` of
+// the run (see emu/run_report.h) or null if none was written.
+//
+// With `--ticks` every application is instead run for exactly that many ticks
+// of the virtual clock (replaying `<replay_dir>/<app>.input` if there is one) so
+// the instructions, traps, heap high-water mark and screen hash of each run are
+// reproducible and the report can be used as a macro-benchmark: "done" is the
+// status of a run which reached the tick count.
+
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "core/logging.h"
+#include "core/status_helpers.h"
+#include "core/status_main.h"
+
+ABSL_FLAG(std::string,
+          emu,
+          /*default_value=*/"",
+          "The `emu` binary to run (defaults to the one next to this binary)");
+
+ABSL_FLAG(int,
+          jobs,
+          /*default_value=*/0,
+          "The number of applications run at once (defaults to one per core)");
+
+ABSL_FLAG(absl::Duration,
+          timeout,
+          /*default_value=*/absl::Seconds(30),
+          "How long an application may run before it is killed");
+
+ABSL_FLAG(std::string,
+          output_dir,
+          /*default_value=*/"/tmp/cyder-fleet",
+          "Where the log, screenshot and report of each application are kept");
+
+ABSL_FLAG(std::string,
+          report,
+          /*default_value=*/"",
+          "Writes the JSON report to this file instead of stdout");
+
+ABSL_FLAG(std::string,
+          system_file,
+          /*default_value=*/"",
+          "A Macintosh System resource file passed to every application");
+
+ABSL_FLAG(bool,
+          count_instructions,
+          /*default_value=*/true,
+          "Counts emulated instructions (slower as the block cache is unused)");
+
+ABSL_FLAG(bool,
+          block_cache,
+          /*default_value=*/false,
+          "Runs with `emu --block_cache` (only used without "
+          "--count_instructions)");
+
+ABSL_FLAG(int,
+          ticks,
+          /*default_value=*/0,
+          "Runs each application for this many emulated ticks (60 per second) "
+          "instead of until it is idle (0 to run until idle)");
+
+ABSL_FLAG(int,
+          memory_size_kb,
+          /*default_value=*/0,
+          "The emulated RAM (in KB) of every application (0 for the `emu` "
+          "default); sizes can not be chosen per application");
+
+ABSL_FLAG(std::string,
+          replay_dir,
+          /*default_value=*/"",
+          "Replays `<app>.input` (recorded with `emu --record_input` or "
+          "written by `input_script`) from this directory for applications "
+          "which have one");
+
+// Not declared by <unistd.h> on every platform (i.e. macOS)
+extern char** environ;
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// How often a running application is checked for having exited.
+constexpr absl::Duration kPollInterval = absl::Milliseconds(5);
+
+struct AppRun {
+  std::string app;
+  std::string name;
+  // The input log replayed for the run (if any).
+  std::string input;
+  std::string status;
+  int exit_code = 0;
+  absl::Duration wall_time;
+  std::string stats;
+};
+
+std::string JsonString(const std::string& value) {
+  std::string escaped = "\"";
+  for (char c : value) {
+    if (c == '"' || c == '\\') {
+      escaped.push_back('\\');
+      escaped.push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      absl::StrAppend(&escaped, "\\u00",
+                      absl::Hex(static_cast<uint8_t>(c), absl::kZeroPad2));
+    } else {
+      escaped.push_back(c);
+    }
+  }
+  return escaped + "\"";
+}
+
+// Expands directories to the `.rsrc` files they contain (like
+// regression_test.py) so that i.e. `examples/` can be passed directly.
+absl::StatusOr<std::vector<std::string>> CollectApps(const core::Args& args) {
+  std::vector<std::string> apps;
+  for (size_t i = 1; i < args.size(); ++i) {
+    auto path = TRY(args.GetArg(i, "FILE_OR_DIR"));
+    if (!fs::is_directory(path)) {
+      apps.push_back(path);
+      continue;
+    }
+    std::vector<std::string> dir_apps;
+    for (const auto& entry : fs::directory_iterator(path)) {
+      if (entry.path().extension() == ".rsrc")
+        dir_apps.push_back(entry.path().string());
+    }
+    std::sort(dir_apps.begin(), dir_apps.end());
+    apps.insert(apps.end(), dir_apps.begin(), dir_apps.end());
+  }
+  if (apps.empty())
+    return absl::InvalidArgumentError("No applications to run");
+  return apps;
+}
+
+std::string OutputPath(const AppRun& run, const std::string& extension) {
+  return (fs::path(absl::GetFlag(FLAGS_output_dir)) / (run.name + extension))
+      .string();
+}
+
+// Starts `emu` for `run` with its output sent to the run's log file.
+pid_t StartApp(const std::string& emu, const AppRun& run) {
+  std::vector<std::string> args = {
+      emu,
+      "--headless",
+      absl::StrCat("--screenshot_file=", OutputPath(run, ".pbm")),
+      absl::StrCat("--report_file=", OutputPath(run, ".json")),
+      absl::StrCat("--count_instructions=",
+                   absl::GetFlag(FLAGS_count_instructions) ? "true" : "false"),
+  };
+  if (absl::GetFlag(FLAGS_block_cache)) {
+    args.push_back("--block_cache");
+  }
+  if (int ticks = absl::GetFlag(FLAGS_ticks); ticks > 0) {
+    args.push_back(absl::StrCat("--exit_after_ticks=", ticks));
+  } else {
+    args.push_back("--exit_on_idle");
+  }
+  // Idle time is skipped on the virtual clock (rather than waited out on the
+  // host) so runs with and without an input log do the same work and the wall
+  // time measures emulation alone
+  args.push_back("--fast_forward");
+  if (!run.input.empty()) {
+    args.push_back(absl::StrCat("--replay_input=", run.input));
+  }
+  if (int memory_size_kb = absl::GetFlag(FLAGS_memory_size_kb);
+      memory_size_kb > 0) {
+    args.push_back(absl::StrCat("--memory_size_kb=", memory_size_kb));
+  }
+  if (auto system_file = absl::GetFlag(FLAGS_system_file);
+      !system_file.empty()) {
+    args.push_back(absl::StrCat("--system_file=", system_file));
+  }
+  args.push_back(run.app);
+
+  std::vector<char*> argv;
+  for (auto& arg : args) {
+    argv.push_back(arg.data());
+  }
+  argv.push_back(nullptr);
+  const std::string log_path = OutputPath(run, ".log");
+
+  // The environment is built before forking since only async-signal-safe
+  // calls may be made in the child of a multi-threaded process. SDL is still
+  // initialized (for events) when headless so it is given the dummy driver.
+  std::vector<std::string> env;
+  bool has_video_driver = false;
+  for (char** var = environ; *var != nullptr; ++var) {
+    env.push_back(*var);
+    has_video_driver |= env.back().rfind("SDL_VIDEODRIVER=", 0) == 0;
+  }
+  if (!has_video_driver)
+    env.push_back("SDL_VIDEODRIVER=dummy");
+  std::vector<char*> envp;
+  for (auto& var : env) {
+    envp.push_back(var.data());
+  }
+  envp.push_back(nullptr);
+
+  pid_t pid = fork();
+  CHECK_NE(pid, -1) << "Failed to fork: " << strerror(errno);
+  if (pid == 0) {
+    int log_fd = open(log_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (log_fd != -1) {
+      dup2(log_fd, STDOUT_FILENO);
+      dup2(log_fd, STDERR_FILENO);
+      close(log_fd);
+    }
+    execve(argv[0], argv.data(), envp.data());
+    _exit(127);
+  }
+  return pid;
+}
+
+void RunApp(const std::string& emu, AppRun& run) {
+  // A stale report from a previous run must not be mistaken for this one
+  fs::remove(OutputPath(run, ".json"));
+
+  const absl::Time start = absl::Now();
+  const absl::Time deadline = start + absl::GetFlag(FLAGS_timeout);
+  pid_t pid = StartApp(emu, run);
+
+  int wait_status = 0;
+  bool timed_out = false;
+  while (waitpid(pid, &wait_status, WNOHANG) == 0) {
+    if (absl::Now() >= deadline) {
+      kill(pid, SIGKILL);
+      waitpid(pid, &wait_status, 0);
+      timed_out = true;
+      break;
+    }
+    absl::SleepFor(kPollInterval);
+  }
+  run.wall_time = absl::Now() - start;
+
+  std::ifstream report(OutputPath(run, ".json"));
+  if (report) {
+    std::stringstream stats;
+    stats << report.rdbuf();
+    run.stats = stats.str();
+    run.stats.erase(run.stats.find_last_not_of("\n") + 1);
+  }
+
+  if (timed_out) {
+    run.status = "timeout";
+  } else if (WIFEXITED(wait_status)) {
+    run.exit_code = WEXITSTATUS(wait_status);
+    if (run.exit_code != 0 || run.stats.empty())
+      run.status = "exited";
+    else
+      run.status = absl::GetFlag(FLAGS_ticks) > 0 ? "done" : "idle";
+  } else {
+    run.exit_code = -WTERMSIG(wait_status);
+    run.status = "crashed";
+  }
+  LOG(INFO) << run.app << ": " << run.status << " in " << run.wall_time;
+}
+
+std::string ReportToJson(const std::vector<AppRun>& runs,
+                         int jobs,
+                         absl::Duration wall_time) {
+  std::string json =
+      absl::StrCat("{\"jobs\": ", jobs, ", \"wall_time_ms\": ",
+                   absl::ToInt64Milliseconds(wall_time), ", \"apps\": [");
+  for (size_t i = 0; i < runs.size(); ++i) {
+    const AppRun& run = runs[i];
+    absl::StrAppend(
+        &json, i == 0 ? "\n  " : ",\n  ", "{\"app\": ", JsonString(run.app),
+        ", \"status\": \"", run.status, "\", \"exit_code\": ", run.exit_code,
+        ", \"wall_time_ms\": ", absl::ToInt64Milliseconds(run.wall_time),
+        ", \"log\": ", JsonString(OutputPath(run, ".log")),
+        ", \"screenshot\": ", JsonString(OutputPath(run, ".pbm")),
+        ", \"input\": ", run.input.empty() ? "null" : JsonString(run.input),
+        ", \"stats\": ", run.stats.empty() ? "null" : run.stats, "}");
+  }
+  absl::StrAppend(&json, "\n]}\n");
+  return json;
+}
+
+}  // namespace
+
+absl::Status Main(const core::Args& args) {
+  auto apps = TRY(CollectApps(args));
+
+  std::string emu = absl::GetFlag(FLAGS_emu);
+  if (emu.empty()) {
+    emu = (fs::path(TRY(args.GetArg(0, "PROGRAM"))).parent_path() / "emu")
+              .string();
+  }
+  int jobs = absl::GetFlag(FLAGS_jobs);
+  if (jobs <= 0)
+    jobs = std::max(1u, std::thread::hardware_concurrency());
+  jobs = std::min<int>(jobs, apps.size());
+
+  std::error_code error;
+  fs::create_directories(absl::GetFlag(FLAGS_output_dir), error);
+  if (error) {
+    return absl::InternalError(
+        absl::StrCat("Unable to create '", absl::GetFlag(FLAGS_output_dir),
+                     "': ", error.message()));
+  }
+
+  std::vector<AppRun> runs(apps.size());
+  const std::string replay_dir = absl::GetFlag(FLAGS_replay_dir);
+  for (size_t i = 0; i < apps.size(); ++i) {
+    runs[i].app = apps[i];
+    // Prefixed with the index so that apps with the same name do not collide
+    runs[i].name = absl::StrCat(i, "-", fs::path(apps[i]).stem().string());
+    if (!replay_dir.empty()) {
+      fs::path input = fs::path(replay_dir) /
+                       (fs::path(apps[i]).stem().string() + ".input");
+      if (fs::exists(input))
+        runs[i].input = input.string();
+    }
+  }
+
+  const absl::Time start = absl::Now();
+  std::atomic<size_t> next_run{0};
+  std::vector<std::thread> workers;
+  for (int i = 0; i < jobs; ++i) {
+    workers.emplace_back([&]() {
+      for (size_t index = next_run++; index < runs.size();
+           index = next_run++) {
+        RunApp(emu, runs[index]);
+      }
+    });
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  std::string report = ReportToJson(runs, jobs, absl::Now() - start);
+  if (auto path = absl::GetFlag(FLAGS_report); !path.empty()) {
+    std::ofstream file(path, std::ios::trunc);
+    if (!(file << report)) {
+      return absl::InternalError(absl::StrCat("Error writing: '", path, "'"));
+    }
+    LOG(INFO) << "Saved report to: " << path;
+  } else {
+    std::cout << report;
+  }
+  return absl::OkStatus();
+}
@@ -36,6 +36,8 @@ int PixelWidthToBytes(int width_px) {
   return width_px % CHAR_BIT ? width_bytes + 1 : width_bytes;
 }
 
+}  // namespace
+
 absl::Status UnpackBits(core::MemoryReader& src,
                         uint8_t* dest,
                         size_t dst_size) {
@@ -64,8 +66,6 @@ absl::Status UnpackBits(core::MemoryReader& src,
   return absl::OkStatus();
 }
 
-}  // namespace
-
 absl::StatusOr<Rect> GetPICTFrame(const core::MemoryRegion& region) {
   core::MemoryReader reader(region);
 
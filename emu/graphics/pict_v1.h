@@ -7,6 +7,7 @@
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "core/memory_reader.h"
 #include "core/memory_region.h"
 #include "emu/graphics/grafport_types.tdef.h"
 
@@ -17,5 +18,11 @@ absl::StatusOr<Rect> GetPICTFrame(const core::MemoryRegion& region);
 
 absl::Status ParsePICTv1(const core::MemoryRegion& region, uint8_t* output);
 
+// Decompresses a single row packed with PackBits (preceded by its packed
+// length in bytes) from `src` in to the `dst_size` bytes of `dest`.
+absl::Status UnpackBits(core::MemoryReader& src,
+                        uint8_t* dest,
+                        size_t dst_size);
+
 }  // namespace graphics
 }  // namespace cyder
\ No newline at end of file
@@ -0,0 +1,76 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/input_log.h"
+
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <sstream>
+
+#include "absl/strings/str_cat.h"
+#include "core/memory_region.h"
+#include "core/status_helpers.h"
+
+namespace cyder {
+namespace {
+
+constexpr char kMagic[] = {'C', 'Y', 'I', 'N'};
+
+}  // namespace
+
+// static
+absl::StatusOr<std::unique_ptr<InputLogWriter>> InputLogWriter::Open(
+    const std::string& path) {
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file.write(kMagic, sizeof(kMagic))) {
+    return absl::InternalError(
+        absl::StrCat("Error opening: '", path, "': ", strerror(errno)));
+  }
+  return std::unique_ptr<InputLogWriter>(new InputLogWriter(std::move(file)));
+}
+
+InputLogWriter::InputLogWriter(std::ofstream file) : file_(std::move(file)) {}
+
+void InputLogWriter::Write(const InputLogEntry& entry) {
+  std::array<uint8_t, kInputLogEntrySize> buffer;
+  core::MemoryRegion region(buffer.data(), buffer.size());
+  CHECK_OK(region.Write<uint32_t>(0, entry.tick));
+  CHECK_OK(WriteType<EventRecord>(entry.event, region, sizeof(uint32_t)));
+  file_.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+  file_.flush();
+}
+
+absl::StatusOr<std::vector<InputLogEntry>> ReadInputLog(
+    const std::string& path) {
+  std::ifstream file(path, std::ios::binary);
+  std::stringstream contents;
+  if (!(file && contents << file.rdbuf())) {
+    return absl::NotFoundError(
+        absl::StrCat("Error reading: '", path, "': ", strerror(errno)));
+  }
+  std::string data = contents.str();
+  if (data.size() < sizeof(kMagic) ||
+      std::memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("'", path, "' is not an input log"));
+  }
+  if ((data.size() - sizeof(kMagic)) % kInputLogEntrySize != 0) {
+    return absl::DataLossError(
+        absl::StrCat("'", path, "' ends with a partial entry"));
+  }
+
+  core::MemoryRegion region(data.data() + sizeof(kMagic),
+                            data.size() - sizeof(kMagic));
+  std::vector<InputLogEntry> entries;
+  for (size_t offset = 0; offset < region.size();
+       offset += kInputLogEntrySize) {
+    InputLogEntry entry;
+    entry.tick = TRY(region.Read<uint32_t>(offset));
+    entry.event = TRY(ReadType<EventRecord>(region, offset + sizeof(uint32_t)));
+    entries.push_back(std::move(entry));
+  }
+  return entries;
+}
+
+}  // namespace cyder
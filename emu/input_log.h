@@ -0,0 +1,49 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/status/statusor.h"
+#include "emu/event_manager.tdef.h"
+
+namespace cyder {
+
+// A host input event (mouse or keyboard) and the tick at which the emulator
+// accepted it into the event queue. Null events record the location of the
+// mouse at that tick (see `EventManager::GetMouseLocation()`).
+struct InputLogEntry {
+  uint32_t tick;
+  EventRecord event;
+};
+
+// The size of each entry in an input log: the tick followed by the big-endian
+// `EventRecord` (as it is laid out in emulated memory).
+constexpr size_t kInputLogEntrySize =
+    sizeof(uint32_t) + EventRecord::fixed_size;
+
+// Appends entries to an input log as they are recorded (so the log survives the
+// emulator exiting at any point).
+class InputLogWriter final {
+ public:
+  static absl::StatusOr<std::unique_ptr<InputLogWriter>> Open(
+      const std::string& path);
+
+  void Write(const InputLogEntry& entry);
+
+ private:
+  explicit InputLogWriter(std::ofstream file);
+
+  std::ofstream file_;
+};
+
+// Reads every entry of the input log at `path`.
+absl::StatusOr<std::vector<InputLogEntry>> ReadInputLog(
+    const std::string& path);
+
+}  // namespace cyder
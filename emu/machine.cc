@@ -0,0 +1,126 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/machine.h"
+
+#include <cstring>
+#include <vector>
+
+#include "emu/memory/code_pages.h"
+#include "emu/memory/memory_map.h"
+#include "third_party/musashi/src/m68k.h"
+
+namespace cyder {
+namespace {
+
+constexpr size_t kCodePageWords = memory::kCodePageCount / 64;
+
+constexpr m68k_register_t kClearedRegisters[] = {
+    M68K_REG_D0, M68K_REG_D1, M68K_REG_D2,  M68K_REG_D3,  M68K_REG_D4,
+    M68K_REG_D5, M68K_REG_D6, M68K_REG_D7,  M68K_REG_A0,  M68K_REG_A1,
+    M68K_REG_A2, M68K_REG_A3, M68K_REG_A4,  M68K_REG_A5,  M68K_REG_A6,
+    M68K_REG_A7, M68K_REG_PC, M68K_REG_USP, M68K_REG_ISP, M68K_REG_MSP,
+};
+
+// Held by the `Activation` of a machine until it is released.
+std::mutex activation_mutex;
+
+// The active machine (or nullptr for the default machine).
+std::atomic<Machine*> current_machine{nullptr};
+
+// Set once the first machine is created (see `Machine::AnyCreated()`).
+std::atomic<bool> any_machine_created{false};
+
+}  // namespace
+
+// static
+Machine& Machine::Default() {
+  static Machine* machine = new Machine(DefaultMemory{});
+  return *machine;
+}
+
+// static
+Machine& Machine::Current() {
+  if (Machine* machine = current_machine.load())
+    return *machine;
+  return Default();
+}
+
+// static
+bool Machine::AnyCreated() {
+  return any_machine_created.load();
+}
+
+// static
+size_t Machine::NextSlotIndex() {
+  static std::atomic<size_t> next_index{0};
+  size_t index = next_index++;
+  CHECK_LT(index, kMaxSlots) << "Increase Machine::kMaxSlots";
+  return index;
+}
+
+Machine::Machine()
+    : owned_memory_(std::make_unique<uint8_t[]>(
+          memory::SystemMemorySize() + memory::kSystemMemoryGuardSize)),
+      owned_code_pages_(std::make_unique<uint64_t[]>(kCodePageWords)),
+      memory_(owned_memory_.get()),
+      code_pages_(owned_code_pages_.get()),
+      memory_region_(memory::CreateSystemMemoryRegion(memory_,
+                                                    memory::SystemMemorySize())),
+      cpu_context_(m68k_context_size()) {
+  any_machine_created.store(true);
+  // Musashi only holds the context of the active machine so a reset CPU is
+  // built in its place and saved before the active machine's is restored.
+  std::vector<uint8_t> active_context(m68k_context_size());
+  m68k_get_context(active_context.data());
+  m68k_init();
+  m68k_pulse_reset();
+  // Reset leaves the general registers as they were and reads the PC and SP
+  // from the active machine's memory so they are cleared as well.
+  for (m68k_register_t reg : kClearedRegisters)
+    m68k_set_reg(reg, 0);
+  m68k_get_context(cpu_context_.data());
+  m68k_set_context(active_context.data());
+  std::memset(memory_, 0,
+              memory::SystemMemorySize() + memory::kSystemMemoryGuardSize);
+}
+
+Machine::Machine(DefaultMemory)
+    : memory_(memory::kSystemMemoryRaw),
+      code_pages_(memory::kCodePageBitmap),
+      cpu_context_(m68k_context_size()) {
+  any_machine_created.store(true);
+}
+
+Machine::~Machine() {
+  CHECK(this != &Current()) << "The active machine can not be destroyed";
+  for (auto it = created_slots_.rbegin(); it != created_slots_.rend(); ++it) {
+    slots_[*it].deleter(slots_[*it].instance.load());
+  }
+}
+
+void Machine::SwitchTo() {
+  Machine& current = Current();
+  if (&current == this)
+    return;
+
+  m68k_get_context(current.cpu_context_.data());
+  current.memory_region_.emplace(memory::kSystemMemory);
+
+  m68k_set_context(cpu_context_.data());
+  memory::kSystemMemory = std::move(*memory_region_);
+  memory_region_.reset();
+  memory::kSystemMemoryRaw = memory_;
+  memory::kCodePageBitmap = code_pages_;
+  current_machine.store(this == &Default() ? nullptr : this);
+}
+
+Machine::Activation::Activation(Machine& machine) : lock_(activation_mutex) {
+  machine.SwitchTo();
+}
+
+Machine::Activation::~Activation() {
+  Default().SwitchTo();
+}
+
+}  // namespace cyder
@@ -0,0 +1,144 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include "core/logging.h"
+#include "core/memory_region.h"
+
+namespace cyder {
+
+// An emulated Macintosh: its memory, CPU context and the per-machine instances
+// returned by `Instance()`/`the()` (i.e. `Emulator`, `MemoryManager`).
+//
+// Musashi (and `memory::kSystemMemory`) are process-wide so a machine must be
+// made active before it is run or its state is touched. Only one machine is
+// active at a time: an `Activation` blocks until the active machine is released
+// so machines on different threads are interleaved rather than run in
+// parallel. The default machine is active whenever no other machine is which
+// keeps a single machine per process (i.e. the `emu` binary) working as-is.
+//
+// Machines can NOT be run in parallel: every `Activation` in the process holds
+// one global mutex and the state swapped on activation (Musashi's context, the
+// memory and code page bitmap) is not the only process-wide state. The
+// registers `BlockCache` runs with and the emulator's memory access mode (see
+// `Emulator::SetMemoryAccess()`) are also shared and are only valid for the
+// machine which is running (they are set again each `Emulator::Run()`). Use
+// separate processes to run machines in parallel (see emu/fleet_main.cc).
+class Machine final {
+ public:
+  // The machine used when no other machine is active.
+  static Machine& Default();
+  // The active machine.
+  static Machine& Current();
+  // Whether any machine (including the default) has been created. Memory is
+  // allocated when a machine is created so its size must be set before then.
+  static bool AnyCreated();
+
+  Machine();
+  ~Machine();
+
+  Machine(const Machine&) = delete;
+  Machine& operator=(const Machine&) = delete;
+
+  // Makes a machine active for as long as it is in scope.
+  class Activation final {
+   public:
+    explicit Activation(Machine& machine);
+    ~Activation();
+
+    Activation(const Activation&) = delete;
+    Activation& operator=(const Activation&) = delete;
+
+   private:
+    std::unique_lock<std::mutex> lock_;
+  };
+
+  // Returns this machine's instance of `Type` constructing it on first use.
+  // Instances are destroyed (in reverse order) with the machine.
+  template <typename Type>
+  Type& Get() {
+    const size_t index = SlotIndex<Type>();
+    if (void* instance = slots_[index].instance.load())
+      return *static_cast<Type*>(instance);
+
+    std::lock_guard<std::recursive_mutex> lock(slot_mutex_);
+    if (slots_[index].instance.load() == nullptr) {
+      auto* instance = new Type();
+      slots_[index].deleter = [](void* ptr) { delete static_cast<Type*>(ptr); };
+      slots_[index].instance.store(instance);
+      created_slots_.push_back(index);
+    }
+    return *static_cast<Type*>(slots_[index].instance.load());
+  }
+
+  // Registers the `instance` of `Type` owned elsewhere (i.e. the managers
+  // constructed by main()) to be returned by `GetRegistered()`.
+  template <typename Type>
+  void Register(Type* instance) {
+    slots_[SlotIndex<Type>()].instance.store(instance);
+  }
+  // Clears the registration of `instance` (if it is still the one registered)
+  // so `GetRegistered()` never returns a destroyed instance.
+  template <typename Type>
+  void Unregister(Type* instance) {
+    void* expected = instance;
+    slots_[SlotIndex<Type>()].instance.compare_exchange_strong(expected,
+                                                               nullptr);
+  }
+  template <typename Type>
+  Type& GetRegistered() {
+    void* instance = slots_[SlotIndex<Type>()].instance.load();
+    CHECK(instance) << "No instance registered for this machine";
+    return *static_cast<Type*>(instance);
+  }
+
+ private:
+  // The maximum number of types with per-machine instances.
+  static constexpr size_t kMaxSlots = 32;
+
+  struct Slot {
+    std::atomic<void*> instance{nullptr};
+    void (*deleter)(void*) = nullptr;
+  };
+
+  static size_t NextSlotIndex();
+
+  template <typename Type>
+  static size_t SlotIndex() {
+    static const size_t index = NextSlotIndex();
+    return index;
+  }
+
+  // The default machine uses the statically allocated memory which
+  // `memory::kSystemMemory` is initialized with.
+  struct DefaultMemory {};
+  explicit Machine(DefaultMemory);
+
+  // Swaps the process-wide state (memory, code pages and the CPU) to `this`.
+  void SwitchTo();
+
+  std::unique_ptr<uint8_t[]> owned_memory_;
+  std::unique_ptr<uint64_t[]> owned_code_pages_;
+  uint8_t* memory_;
+  uint64_t* code_pages_;
+  // The `memory::kSystemMemory` of the machine while it is not active.
+  std::optional<core::MemoryRegion> memory_region_;
+  // The Musashi context of the machine while it is not active.
+  std::vector<uint8_t> cpu_context_;
+
+  std::array<Slot, kMaxSlots> slots_;
+  std::vector<size_t> created_slots_;
+  std::recursive_mutex slot_mutex_;
+};
+
+}  // namespace cyder
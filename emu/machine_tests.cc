@@ -0,0 +1,97 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/machine.h"
+
+#include <gtest/gtest.h>
+
+#include "core/status_helpers.h"
+#include "emu/memory/code_pages.h"
+#include "emu/memory/memory_map.h"
+#include "emu/scheduler.h"
+#include "third_party/musashi/src/m68k.h"
+
+namespace cyder {
+namespace {
+
+TEST(MachineTests, DefaultIsCurrent) {
+  EXPECT_EQ(&Machine::Current(), &Machine::Default());
+}
+
+TEST(MachineTests, InstancesArePerMachine) {
+  Machine machine;
+  Scheduler* default_scheduler = &Scheduler::Instance();
+  {
+    Machine::Activation activation(machine);
+    EXPECT_EQ(&Machine::Current(), &machine);
+    EXPECT_NE(&Scheduler::Instance(), default_scheduler);
+    EXPECT_EQ(&Scheduler::Instance(), &machine.Get<Scheduler>());
+  }
+  EXPECT_EQ(&Machine::Current(), &Machine::Default());
+  EXPECT_EQ(&Scheduler::Instance(), default_scheduler);
+}
+
+TEST(MachineTests, ActivationSwapsMemory) {
+  Machine machine;
+  CHECK_OK(memory::kSystemMemory.Write<uint32_t>(0x100, 0xCAFEF00D));
+  memory::MarkCodePages(0x200, 0x204);
+  {
+    Machine::Activation activation(machine);
+    EXPECT_EQ(MUST(memory::kSystemMemory.Read<uint32_t>(0x100)), 0u);
+    EXPECT_FALSE(memory::IsCodePage(0x200));
+    CHECK_OK(memory::kSystemMemory.Write<uint32_t>(0x100, 0xDEADBEEF));
+  }
+  EXPECT_EQ(MUST(memory::kSystemMemory.Read<uint32_t>(0x100)), 0xCAFEF00D);
+  EXPECT_TRUE(memory::IsCodePage(0x200));
+
+  Machine::Activation activation(machine);
+  EXPECT_EQ(MUST(memory::kSystemMemory.Read<uint32_t>(0x100)), 0xDEADBEEF);
+}
+
+TEST(MachineTests, ActivationSwapsCpu) {
+  Machine machine;
+  m68k_set_reg(M68K_REG_D0, 1);
+  {
+    Machine::Activation activation(machine);
+    m68k_set_reg(M68K_REG_D0, 2);
+  }
+  EXPECT_EQ(m68k_get_reg(/*context=*/NULL, M68K_REG_D0), 1u);
+
+  Machine::Activation activation(machine);
+  EXPECT_EQ(m68k_get_reg(/*context=*/NULL, M68K_REG_D0), 2u);
+}
+
+TEST(MachineTests, StartsWithResetCpu) {
+  m68k_set_reg(M68K_REG_SR, 0x0000);
+  m68k_set_reg(M68K_REG_D0, 1);
+  m68k_set_reg(M68K_REG_A5, 0x1234);
+  m68k_set_reg(M68K_REG_PC, 0x3000);
+  Machine machine;
+  {
+    Machine::Activation activation(machine);
+    // Supervisor mode with interrupts masked (as after a reset)
+    EXPECT_EQ(m68k_get_reg(/*context=*/NULL, M68K_REG_SR), 0x2700u);
+    EXPECT_EQ(m68k_get_reg(/*context=*/NULL, M68K_REG_D0), 0u);
+    EXPECT_EQ(m68k_get_reg(/*context=*/NULL, M68K_REG_A5), 0u);
+    EXPECT_EQ(m68k_get_reg(/*context=*/NULL, M68K_REG_PC), 0u);
+  }
+  // The active machine's CPU is left as it was
+  EXPECT_EQ(m68k_get_reg(/*context=*/NULL, M68K_REG_D0), 1u);
+  EXPECT_EQ(m68k_get_reg(/*context=*/NULL, M68K_REG_PC), 0x3000u);
+}
+
+TEST(MachineTests, UnregistersInstances) {
+  struct Manager {};
+  Machine machine;
+  Manager first, second;
+  machine.Register(&first);
+  machine.Register(&second);
+  // Only the instance which is still registered is cleared
+  machine.Unregister(&first);
+  EXPECT_EQ(&machine.GetRegistered<Manager>(), &second);
+  machine.Unregister(&second);
+  EXPECT_DEATH(machine.GetRegistered<Manager>(), "No instance registered");
+}
+
+}  // namespace
+}  // namespace cyder
@@ -11,11 +11,15 @@
 #include <signal.h>
 #endif  // __LINUX__
 
+#include <algorithm>
 #include <atomic>
 #include <bitset>
 #include <chrono>
+#include <csignal>
 #include <cstdint>
+#include <cstdlib>
 #include <iomanip>
+#include <iostream>
 #include <regex>
 #include <thread>
 
@@ -27,20 +31,30 @@
 #include "core/status_main.h"
 #include "emu/debug/debug_manager.h"
 #include "emu/debug/debugger.h"
+#include "emu/debug/execution_stats.h"
+#include "emu/debug/profiler.h"
+#include "emu/debug/stats.h"
 #include "emu/debug_logger.h"
 #include "emu/emulator.h"
 #include "emu/event_manager.h"
 #include "emu/graphics/bitmap_image.h"
 #include "emu/graphics/graphics_helpers.h"
+#include "emu/input_log.h"
 #include "emu/memory/memory_manager.h"
 #include "emu/memory/memory_map.h"
 #include "emu/menu_manager.h"
 #include "emu/rsrc/resource_file.h"
 #include "emu/rsrc/resource_manager.h"
+#include "emu/run_report.h"
+#include "emu/save_state.h"
+#include "emu/scheduler.h"
 #include "emu/segment_loader.h"
+#include "emu/throughput_meter.h"
+#include "emu/trap/idle_detector.h"
 #include "emu/trap/stack_helpers.h"
 #include "emu/trap/trap_dispatcher.h"
 #include "emu/trap/trap_manager.h"
+#include "emu/trap/trap_stats.h"
 #include "emu/window_manager.h"
 #include "gen/global_names.h"
 #include "gen/trap_names.h"
@@ -61,11 +75,160 @@ ABSL_FLAG(bool,
           /*default_value=*/false,
           "Save a screenshot and exit once idle (use with --headless)");
 
+ABSL_FLAG(std::string,
+          screenshot_file,
+          /*default_value=*/"/tmp/screenshot.bmp",
+          "Where --exit_on_idle (or --exit_after_ticks) saves the final "
+          "screenshot");
+
+ABSL_FLAG(std::string,
+          report_file,
+          /*default_value=*/"",
+          "Writes a JSON summary of the run (instructions, cycles, traps and a "
+          "hash of the screen) to this file on --exit_on_idle or "
+          "--exit_after_ticks");
+
+ABSL_FLAG(int,
+          exit_after_ticks,
+          /*default_value=*/0,
+          "Save a screenshot (and --report_file) and exit once this many ticks "
+          "have been emulated for a fixed-length run (implies --virtual_clock; "
+          "0 to disable)");
+
+ABSL_FLAG(bool,
+          count_instructions,
+          /*default_value=*/false,
+          "Runs every instruction through the instruction hook (so the block "
+          "cache is not used) for --report_file");
+
 ABSL_FLAG(bool,
           debugger,
           /*default_value=*/false,
           "Enables the Cyder debugger prompt");
 
+ABSL_FLAG(bool,
+          trace,
+          /*default_value=*/false,
+          "Disassembles every instruction as it is executed");
+
+ABSL_FLAG(bool,
+          block_cache,
+          /*default_value=*/false,
+          "Runs straight-line code from a cache of pre-decoded blocks (ignored "
+          "with --debugger or --trace)");
+
+ABSL_FLAG(bool,
+          direct_traps,
+          /*default_value=*/false,
+          "Dispatches A-Traps reached between cached blocks directly to their "
+          "native handlers instead of raising the line 1010 exception (needs "
+          "--block_cache)");
+
+ABSL_FLAG(int,
+          cycles_per_quantum,
+          /*default_value=*/16384,
+          "The number of CPU cycles run between checks for the VBL interrupt");
+
+ABSL_FLAG(bool,
+          virtual_clock,
+          /*default_value=*/false,
+          "Derive emulated time from the CPU cycles run instead of the host "
+          "clock so that runs are reproducible");
+
+ABSL_FLAG(bool,
+          fast_forward,
+          /*default_value=*/false,
+          "Skip idle waits for events instead of sleeping (implies "
+          "--virtual_clock)");
+
+ABSL_FLAG(int,
+          idle_polls,
+          /*default_value=*/16,
+          "Parks the emulator until input or the next tick once the "
+          "application polls for events this many times in a row with nothing "
+          "to do (0 disables)");
+
+ABSL_FLAG(std::string,
+          save_state,
+          /*default_value=*/"",
+          "Saves the emulator state to this file once the application has "
+          "initialized (the first time it waits for events)");
+
+ABSL_FLAG(std::string,
+          restore_state,
+          /*default_value=*/"",
+          "Restores the emulator state from this file (saved with --save_state "
+          "for the same application) instead of starting the application");
+
+ABSL_FLAG(std::string,
+          record_input,
+          /*default_value=*/"",
+          "Records mouse and keyboard input (with the tick it was accepted at) "
+          "to this file for --replay_input (implies --virtual_clock)");
+
+ABSL_FLAG(std::string,
+          replay_input,
+          /*default_value=*/"",
+          "Replays the input recorded with --record_input instead of taking "
+          "input from the host (implies --virtual_clock)");
+
+ABSL_FLAG(bool,
+          checked_memory,
+          /*default_value=*/false,
+          "Validate and watch every emulated memory access (implied by "
+          "--debugger)");
+
+ABSL_FLAG(std::string,
+          profile_file,
+          /*default_value=*/"",
+          "Samples the PC while running and writes the collapsed stacks (for "
+          "flamegraph.pl) to this file on exit");
+
+ABSL_FLAG(int,
+          profile_period,
+          /*default_value=*/10000,
+          "The number of CPU cycles run between --profile_file samples");
+
+ABSL_FLAG(bool,
+          profile_frames,
+          /*default_value=*/false,
+          "Follows the A6 frame chain so --profile_file records callers too");
+
+ABSL_FLAG(int,
+          throughput_log_seconds,
+          /*default_value=*/0,
+          "Logs the emulated MIPS, cycles, traps and frames per second at this "
+          "interval (0 to disable)");
+
+ABSL_FLAG(std::string,
+          throughput_file,
+          /*default_value=*/"",
+          "Rewrites this file (atomically) with the throughput as JSON every "
+          "second");
+
+ABSL_FLAG(bool,
+          execution_stats,
+          /*default_value=*/false,
+          "Collects the opcode mix, memory accesses by region and branch "
+          "targets for the stats dump (see --print_stats). This is slow");
+
+ABSL_FLAG(bool,
+          print_stats,
+          /*default_value=*/false,
+          "Prints the emulator's statistics (i.e. per-trap call counts and "
+          "latencies) to stderr on exit. Also available on SIGUSR1 and from "
+          "the debugger with `stats`");
+
+ABSL_FLAG(int,
+          memory_size_kb,
+          /*default_value=*/512,
+          "The size of emulated RAM in KB (a power of two from 512 to 8192)");
+
+ABSL_FLAG(int,
+          stack_size_kb,
+          /*default_value=*/4,
+          "The size of the application stack in KB");
+
 #define SHOW_WINDOW
 
 constexpr SDL_Color kOnColor = {0xFF, 0xFF, 0xFF, 0xFF};
@@ -81,8 +244,8 @@ constexpr uint8_t kGreyPattern[8] = {0xAA, 0x55, 0xAA, 0x55,
 // unsigned int m68k_read_memory_16(unsigned int address) {
 //   cyder::memory::CheckReadAccess(address);
 
-//   if (address >= cyder::memory::kLastEmulatedSubroutineAddress &&
-//       address < cyder::memory::kSystemMemorySize) {
+//   if (address >= cyder::memory::LastEmulatedSubroutineAddress() &&
+//       address < cyder::memory::SystemMemorySize()) {
 //     CHECK(on_emulated_subroutine)
 //         << "No emulated subroutine callback registered";
 //     std::optional<Trap> trap = on_emulated_subroutine(address);
@@ -104,8 +267,8 @@ static ::cyder::DebugLogger logger;
 // void cpu_instr_callback(unsigned int pc) {
 //   CHECK(pc != 0) << "Reset";
 
-//   CHECK(m68k_get_reg(NULL, M68K_REG_ISP) <= cyder::memory::kStackStart);
-//   CHECK(m68k_get_reg(NULL, M68K_REG_ISP) > cyder::memory::kStackEnd);
+//   CHECK(m68k_get_reg(NULL, M68K_REG_ISP) <= cyder::memory::StackStart());
+//   CHECK(m68k_get_reg(NULL, M68K_REG_ISP) > cyder::memory::StackEnd());
 
 //   auto instr = MUST(cyder::memory::kSystemMemory.Read<uint16_t>(pc));
 //   if ((instr & 0xFFC0) == 0x4E80) {
@@ -122,26 +285,6 @@ static ::cyder::DebugLogger logger;
 //   }
 // }
 
-void PrintFrameTiming(std::ostream& os = std::cout, float period = 2.0f) {
-  static unsigned int frames = 0;
-  frames++;
-  static auto start = std::chrono::steady_clock::now();
-  auto end = std::chrono::steady_clock::now();
-
-  float seconds =
-      std::chrono::duration_cast<std::chrono::duration<float>>(end - start)
-          .count();
-  if (seconds > period) {
-    float spf = seconds / frames;
-    os << frames << " frames in " << std::setprecision(1) << std::fixed
-       << seconds << " seconds = " << std::setprecision(1) << std::fixed
-       << 1.0f / spf << " FPS (" << std::setprecision(3) << std::fixed
-       << spf * 1000.0f << " ms/frame)\n";
-    frames = 0;
-    start = end;
-  }
-}
-
 using cyder::EventManager;
 using cyder::MenuManager;
 using cyder::NewRect;
@@ -167,7 +310,8 @@ SDL_Surface* const MakeSurface(const BitmapImage& screen) {
 
 absl::Status UpdateGlobalTime() {
   return kSystemMemory.Write<uint32_t>(
-      GlobalVars::Time, absl::ToUnixSeconds(absl::Now()) + 2082844800);
+      GlobalVars::Time,
+      absl::ToUnixSeconds(cyder::Scheduler::Instance().Now()) + 2082844800);
 }
 
 void SaveScreenshot(const BitmapImage& screen) {
@@ -180,7 +324,7 @@ absl::Status InitializeVM(size_t pc) {
   cyder::Emulator::Instance().Init(pc);
 
   RETURN_IF_ERROR(kSystemMemory.Write<uint32_t>(GlobalVars::ApplLimit,
-                                                cyder::memory::kHeapEnd));
+                                                cyder::memory::HeapEnd()));
   RETURN_IF_ERROR(kSystemMemory.Write<uint32_t>(
       GlobalVars::CurrentA5, cyder::memory::GetA5WorldPosition()));
 
@@ -209,14 +353,22 @@ absl::Status InitializeVM(size_t pc) {
       kSystemMemory.Write<uint32_t>(GlobalVars::Lo3Bytes, 0x00FFFFFF));
 
   RETURN_IF_ERROR(kSystemMemory.Write<uint32_t>(GlobalVars::CurStackBase,
-                                                cyder::memory::kStackStart));
+                                                cyder::memory::StackStart()));
+  // `Time` is advanced from here by the VBL interrupt
+  RETURN_IF_ERROR(UpdateGlobalTime());
 
-  cyder::trap::Push<uint32_t>(cyder::memory::kBaseToolboxTrapAddress +
+  cyder::trap::Push<uint32_t>(cyder::memory::BaseToolboxTrapAddress() +
                               (Trap::ExitToShell & 0x03FF) * sizeof(uint16_t));
   return absl::OkStatus();
 }
 
-void run_emulator_thread(std::atomic<bool>& is_running) {
+void run_emulator_thread(std::atomic<bool>& is_running,
+                         const cyder::SaveStateComponents& components,
+                         EventManager& event_manager,
+                         const BitmapImage& screen) {
+  std::string save_state_path = absl::GetFlag(FLAGS_save_state);
+  const uint32_t exit_after_ticks =
+      std::max(absl::GetFlag(FLAGS_exit_after_ticks), 0);
   while (is_running.load()) {
     // If `--debugger` was passed continue to prompt the user for commands until
     // `Prompt()` indicates it is ready to run the main emulation loop.
@@ -228,8 +380,23 @@ void run_emulator_thread(std::atomic<bool>& is_running) {
       }
     }
 
-    CHECK_OK(UpdateGlobalTime());
     cyder::Emulator::Instance().Run();
+    cyder::DumpStatsIfRequested(std::cerr);
+    cyder::ThroughputMeter::Instance().Update();
+
+    // State can only be saved between timeslices. Once the application polls
+    // for events (and has drawn its windows) it is considered initialized.
+    if (!save_state_path.empty() && event_manager.has_polled_events() &&
+        !event_manager.has_window_events()) {
+      CHECK_OK(cyder::SaveState(save_state_path, components));
+      save_state_path.clear();
+    }
+
+    if (exit_after_ticks > 0 &&
+        cyder::Scheduler::Instance().NowTicks() >= exit_after_ticks) {
+      cyder::SaveRunAndExit(screen, absl::GetFlag(FLAGS_screenshot_file),
+                            absl::GetFlag(FLAGS_report_file));
+    }
   }
 }
 
@@ -245,6 +412,7 @@ bool main_loop(SDL_Renderer* renderer,
     SDL_RenderCopy(renderer, texture, nullptr, nullptr);
     SDL_RenderPresent(renderer);
     SDL_DestroyTexture(texture);
+    cyder::ThroughputMeter::Instance().RecordFrame();
   }
 
   SDL_Event event;
@@ -284,9 +452,6 @@ bool main_loop(SDL_Renderer* renderer,
         return false;  // Exit the main loop.
     }
   }
-  if (!(absl::GetFlag(FLAGS_headless) || absl::GetFlag(FLAGS_debugger))) {
-    // PrintFrameTiming();
-  }
   return true;  // Continue the main loop.
 }
 
@@ -304,6 +469,11 @@ void run_main_loop(void* args) {
 }
 
 absl::Status Main(const core::Args& args) {
+  // This must happen before anything touches the machine (and its memory)
+  RETURN_IF_ERROR(cyder::memory::ConfigureMemoryMap(
+      static_cast<size_t>(absl::GetFlag(FLAGS_memory_size_kb)) * 1_kb,
+      static_cast<size_t>(absl::GetFlag(FLAGS_stack_size_kb)) * 1_kb));
+
   auto file = TRY(ResourceFile::Load(TRY(args.GetArg(1, "FILENAME"))));
 
   auto system_path = absl::GetFlag(FLAGS_system_file);
@@ -313,10 +483,19 @@ absl::Status Main(const core::Args& args) {
   }
 
   cyder::DebugManager::Instance().TagMemory(
-      cyder::memory::kStackEnd, cyder::memory::kStackStart, "Stack");
+      cyder::memory::StackEnd(), cyder::memory::StackStart(), "Stack");
   MemoryManager memory_manager;
   logger.SetMemoryManager(&memory_manager);
-  cyder::memory::InstallMemoryWatcher();
+  // Checked memory access is much slower than reading system memory directly
+  // so it is only used when something is going to inspect the results.
+  const bool checked_memory =
+      absl::GetFlag(FLAGS_checked_memory) || absl::GetFlag(FLAGS_debugger);
+  if (checked_memory) {
+    cyder::memory::InstallMemoryWatcher();
+  }
+  cyder::Emulator::Instance().SetMemoryAccess(
+      checked_memory ? cyder::Emulator::MemoryAccess::kChecked
+                     : cyder::Emulator::MemoryAccess::kFast);
 
   ResourceManager resource_manager(memory_manager, *file, system_file.get());
 
@@ -327,7 +506,69 @@ absl::Status Main(const core::Args& args) {
   LOG(INFO) << "Initialize PC: " << std::hex << pc;
   LOG(INFO) << "Memory Map: " << cyder::memory::MemoryMapToStr();
 
+  auto& scheduler = cyder::Scheduler::Instance();
+  scheduler.SetQuantum(absl::GetFlag(FLAGS_cycles_per_quantum));
+  if (absl::GetFlag(FLAGS_virtual_clock) || absl::GetFlag(FLAGS_fast_forward) ||
+      absl::GetFlag(FLAGS_exit_after_ticks) > 0 ||
+      !absl::GetFlag(FLAGS_record_input).empty() ||
+      !absl::GetFlag(FLAGS_replay_input).empty()) {
+    scheduler.SetClockMode(cyder::Scheduler::ClockMode::kVirtual);
+  }
+  scheduler.SetFastForward(absl::GetFlag(FLAGS_fast_forward));
+  cyder::trap::IdleDetector::Instance().SetThreshold(
+      absl::GetFlag(FLAGS_idle_polls));
+
+  if (!absl::GetFlag(FLAGS_profile_file).empty()) {
+    cyder::Profiler::Instance().Start(absl::GetFlag(FLAGS_profile_period),
+                                      absl::GetFlag(FLAGS_profile_frames));
+    // Saved at exit so that runs ended by --exit_on_idle are covered too
+    std::atexit([] {
+      auto status = cyder::Profiler::Instance().SaveCollapsedStacks(
+          absl::GetFlag(FLAGS_profile_file));
+      LOG_IF(ERROR, !status.ok()) << status;
+    });
+  }
+
+  cyder::RegisterStats("Traps", [](std::ostream& os) {
+    cyder::trap::TrapStats::Instance().Print(os);
+  });
+  cyder::ThroughputMeter::Instance().Configure(
+      absl::Seconds(absl::GetFlag(FLAGS_throughput_log_seconds)),
+      absl::GetFlag(FLAGS_throughput_file));
+  cyder::RegisterStats("Throughput", [](std::ostream& os) {
+    cyder::ThroughputMeter::Instance().Print(os);
+    os << "\n";
+  });
+  if (absl::GetFlag(FLAGS_execution_stats)) {
+    cyder::Emulator::Instance().EnableExecutionStats();
+    cyder::RegisterStats("Execution", [](std::ostream& os) {
+      cyder::ExecutionStats::Instance().Print(os);
+    });
+  }
+  if (absl::GetFlag(FLAGS_print_stats)) {
+    std::atexit([] { cyder::DumpStats(std::cerr); });
+  }
+#ifndef __EMSCRIPTEN__
+  std::signal(SIGUSR1, [](int) { cyder::RequestStatsDump(); });
+#endif  // __EMSCRIPTEN__
+
   RETURN_IF_ERROR(InitializeVM(pc));
+  cyder::Emulator::Instance().EnableVblInterrupt();
+
+  // The instruction hook is a fixed cost on every instruction so it is only
+  // installed when something actually needs to observe each instruction.
+  // Cached blocks are never seen by the hook so they can only be used without.
+  if (absl::GetFlag(FLAGS_debugger) || absl::GetFlag(FLAGS_trace) ||
+      absl::GetFlag(FLAGS_count_instructions) ||
+      absl::GetFlag(FLAGS_execution_stats)) {
+    cyder::Emulator::Instance().EnableInstructionHook(
+        absl::GetFlag(FLAGS_trace));
+  } else {
+    cyder::Emulator::Instance().EnableBlockCache(
+        absl::GetFlag(FLAGS_block_cache));
+    cyder::Emulator::Instance().EnableDirectTraps(
+        absl::GetFlag(FLAGS_direct_traps));
+  }
 
   BitMap bitmap;
   bitmap.bounds = NewRect(0, 0, kScreenWidth, kScreenHeight);
@@ -369,6 +610,12 @@ absl::Status Main(const core::Args& args) {
   SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, 0);
 
   EventManager event_manager;
+  if (auto path = absl::GetFlag(FLAGS_record_input); !path.empty()) {
+    event_manager.StartRecording(TRY(cyder::InputLogWriter::Open(path)));
+  }
+  if (auto path = absl::GetFlag(FLAGS_replay_input); !path.empty()) {
+    event_manager.StartReplay(TRY(cyder::ReadInputLog(path)));
+  }
   WindowManager window_manager(event_manager, screen, memory_manager);
   TrapDispatcherImpl trap_dispatcher(memory_manager, resource_manager,
                                      event_manager, menu_manager,
@@ -379,9 +626,21 @@ absl::Status Main(const core::Args& args) {
     trap_manager.PatchTrapsFromSystemFile(memory_manager, *system_file);
   }
 
+  cyder::SaveStateComponents components{memory_manager, resource_manager,
+                                        trap_manager, window_manager,
+                                        menu_manager};
+  // The native setup above is repeated (it is cheap) so that host-side objects
+  // bound to emulated memory (i.e. the screen) line up with the snapshot.
+  if (auto path = absl::GetFlag(FLAGS_restore_state); !path.empty()) {
+    RETURN_IF_ERROR(cyder::RestoreState(path, components));
+    menu_manager.DrawMenuBar();
+  }
+
   std::atomic<bool> is_emulator_running{true};
   std::thread emulator_thread(run_emulator_thread,
-                              std::ref(is_emulator_running));
+                              std::ref(is_emulator_running),
+                              std::cref(components), std::ref(event_manager),
+                              std::cref(screen));
 
 #ifdef __EMSCRIPTEN__
   MainLoopArgs main_loop_args{renderer, window, &screen, &event_manager};
@@ -0,0 +1,64 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/memory/code_pages.h"
+
+#include <cstring>
+#include <vector>
+
+#include "emu/machine.h"
+
+namespace cyder {
+namespace memory {
+namespace {
+
+constexpr size_t kCodePageWords = kCodePageCount / 64;
+
+uint64_t kDefaultCodePageBitmap[kCodePageWords];
+
+std::vector<CodeWriteListener>& GetListeners() {
+  return Machine::Current().Get<std::vector<CodeWriteListener>>();
+}
+
+}  // namespace
+
+uint64_t* kCodePageBitmap = kDefaultCodePageBitmap;
+
+void AddCodeWriteListener(CodeWriteListener listener) {
+  GetListeners().push_back(std::move(listener));
+}
+
+void MarkCodePages(uint32_t start, uint32_t end) {
+  if (start >= end)
+    return;
+  // A store which starts just before the code can still overwrite it
+  start = start < sizeof(uint32_t) - 1 ? 0 : start - (sizeof(uint32_t) - 1);
+  for (uint32_t page = start >> kCodePageShift;
+       page <= ((end - 1) >> kCodePageShift) && page < kCodePageCount; ++page) {
+    kCodePageBitmap[page / 64] |= uint64_t{1} << (page % 64);
+  }
+}
+
+void ClearCodePages() {
+  memset(kCodePageBitmap, 0, kCodePageWords * sizeof(uint64_t));
+}
+
+void NotifyCodeWrite(uint32_t start, uint32_t end) {
+  bool touches_code = false;
+  for (uint32_t address = start & ~(kCodePageSize - 1); address < end;
+       address += kCodePageSize) {
+    if (IsCodePage(address)) {
+      touches_code = true;
+      break;
+    }
+  }
+  if (!touches_code)
+    return;
+
+  for (const auto& listener : GetListeners()) {
+    listener(start, end);
+  }
+}
+
+}  // namespace memory
+}  // namespace cyder
@@ -0,0 +1,62 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+#include "absl/base/optimization.h"
+#include "emu/memory/memory_map.h"
+
+namespace cyder {
+namespace memory {
+
+// Tracks which pages of `kSystemMemory` contain emulated code so that caches
+// of decoded instructions can be invalidated when code is overwritten (self-
+// modifying code, segment reloads, jump-table patches) with a single bit-test
+// per store rather than a lookup in every cache.
+constexpr uint32_t kCodePageShift = 8;
+constexpr uint32_t kCodePageSize = 1 << kCodePageShift;
+// Sized for the largest memory so that the page mask is a constant regardless
+// of how `ConfigureMemoryMap()` was called.
+constexpr uint32_t kCodePageCount = kMaxSystemMemorySize / kCodePageSize;
+
+static_assert((kCodePageCount & (kCodePageCount - 1)) == 0,
+              "The code page bitmap wraps addresses to a power of two");
+
+// One bit per page which is set if the page contains code (of the active
+// machine; see emu/machine.h).
+extern uint64_t* kCodePageBitmap;
+
+inline bool IsCodePage(uint32_t address) {
+  const uint32_t page = (address >> kCodePageShift) & (kCodePageCount - 1);
+  return (kCodePageBitmap[page / 64] >> (page % 64)) & 1;
+}
+
+// Called with the range of memory written when code may have been overwritten.
+using CodeWriteListener = std::function<void(uint32_t start, uint32_t end)>;
+
+void AddCodeWriteListener(CodeWriteListener listener);
+
+// Marks the pages covering [start, end) as containing code. This is done when
+// a segment is loaded and the first time a PC executes within a page.
+void MarkCodePages(uint32_t start, uint32_t end);
+
+// Clears the bitmap (used when all decoded code is dropped).
+void ClearCodePages();
+
+// Publishes [start, end) to all listeners if it touches a code page. This is
+// for writes which bypass the emulated CPU (i.e. native traps/loaders).
+void NotifyCodeWrite(uint32_t start, uint32_t end);
+
+// Checks a single store from the emulated CPU. Pages are marked starting
+// `sizeof(uint32_t) - 1` bytes early so that only the page containing the
+// first byte of a store needs to be tested.
+inline void CheckCodeWrite(uint32_t address, uint32_t size) {
+  if (ABSL_PREDICT_FALSE(IsCodePage(address)))
+    NotifyCodeWrite(address, address + size);
+}
+
+}  // namespace memory
+}  // namespace cyder
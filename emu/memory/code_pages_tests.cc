@@ -0,0 +1,72 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/memory/code_pages.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <utility>
+#include <vector>
+
+namespace cyder {
+namespace memory {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Pair;
+
+class CodePagesTests : public ::testing::Test {
+ protected:
+  CodePagesTests() {
+    static bool has_listener = false;
+    if (!has_listener) {
+      AddCodeWriteListener([](uint32_t start, uint32_t end) {
+        writes().emplace_back(start, end);
+      });
+      has_listener = true;
+    }
+    ClearCodePages();
+    writes().clear();
+  }
+
+  static std::vector<std::pair<uint32_t, uint32_t>>& writes() {
+    static std::vector<std::pair<uint32_t, uint32_t>> writes;
+    return writes;
+  }
+};
+
+TEST_F(CodePagesTests, MarksPages) {
+  MarkCodePages(0x2000, 0x2000 + kCodePageSize + 1);
+
+  EXPECT_TRUE(IsCodePage(0x2000));
+  EXPECT_TRUE(IsCodePage(0x2000 + kCodePageSize));
+  EXPECT_FALSE(IsCodePage(0x2000 + 2 * kCodePageSize));
+  // Stores starting just before the code could still overwrite it
+  EXPECT_TRUE(IsCodePage(0x2000 - 1));
+  EXPECT_FALSE(IsCodePage(0x2000 - 2 * kCodePageSize));
+}
+
+TEST_F(CodePagesTests, PublishesCodeWrites) {
+  MarkCodePages(0x2000, 0x2010);
+
+  CheckCodeWrite(0x4000, sizeof(uint32_t));
+  CheckCodeWrite(0x2004, sizeof(uint16_t));
+  NotifyCodeWrite(0x1000, 0x3000);
+  NotifyCodeWrite(0x3000, 0x4000);
+
+  EXPECT_THAT(writes(), ElementsAre(Pair(0x2004, 0x2006), Pair(0x1000, 0x3000)));
+}
+
+TEST_F(CodePagesTests, ClearsPages) {
+  MarkCodePages(0x2000, 0x2010);
+  ClearCodePages();
+
+  CheckCodeWrite(0x2004, sizeof(uint16_t));
+  EXPECT_FALSE(IsCodePage(0x2000));
+  EXPECT_THAT(writes(), ElementsAre());
+}
+
+}  // namespace
+}  // namespace memory
+}  // namespace cyder
@@ -3,11 +3,16 @@
 
 #include "emu/memory/memory_manager.h"
 
+#include <algorithm>
 #include <iomanip>
+#include <vector>
 
 #include "absl/strings/str_cat.h"
 #include "core/logging.h"
 #include "core/memory_region.h"
+#include "core/status_helpers.h"
+#include "emu/machine.h"
+#include "emu/memory/code_pages.h"
 #include "emu/memory/memory_map.h"
 #include "gen/global_names.h"
 
@@ -16,150 +21,486 @@ namespace memory {
 
 namespace {
 
-MemoryManager* s_instance;
-
 constexpr bool kEnableLogging = false;
 
 #define LOG_MEM(level) LOG_IF(level, kEnableLogging)
 
+// Blocks start after the master pointers and end at the stack (`HeapEnd()`)
+constexpr uint32_t kZoneStart = kHeapStart + MemoryManager::kHeapHandleOffset;
+
+// The smallest block with room for a (4 byte) master pointer when free
+constexpr uint32_t kMinBlockSize = MemoryManager::kBlockHeaderSize + 4;
+
+// Tag bytes (the upper two bits) for free, nonrelocatable and relocatable
+constexpr uint8_t kFreeTag = 0x00;
+constexpr uint8_t kNonrelocatableTag = 0x40;
+constexpr uint8_t kRelocatableTag = 0x80;
+
 }  // namespace
 
 extern core::MemoryRegion kSystemMemory;
 
-MemoryManager::MemoryManager() {
-  s_instance = this;
+MemoryManager::MemoryManager()
+    : handles_(kHeapHandleOffset / sizeof(Handle)),
+      machine_(Machine::Current()) {
+  machine_.Register(this);
+  AddFreeBlock(kZoneStart, HeapEnd() - kZoneStart);
+}
+
+MemoryManager::~MemoryManager() {
+  machine_.Unregister(this);
 }
 
 // static
 MemoryManager& MemoryManager::the() {
-  return *s_instance;
+  return Machine::Current().GetRegistered<MemoryManager>();
+}
+
+// static
+uint32_t MemoryManager::PhysicalSizeFor(uint32_t logical_size) {
+  uint32_t aligned = (logical_size + 3) & ~3u;
+  return std::max<uint32_t>(aligned + kBlockHeaderSize, kMinBlockSize);
 }
 
 Ptr MemoryManager::Allocate(uint32_t size) {
-  size_t ptr = kHeapStart + heap_offset_;
-  heap_offset_ += size;
-  LOG_MEM(INFO) << "Allocate " << size << "b at 0x" << std::hex << ptr << "("
-                << std::dec << heap_offset_ << " / " << (kHeapEnd - kHeapStart);
-  CHECK_LT(heap_offset_, kHeapEnd);
+  uint32_t address = AllocateBlock(size, /*handle=*/0);
+  CHECK_NE(address, 0u) << "Out of heap memory allocating " << size << "b";
+  Ptr ptr = address + kBlockHeaderSize;
+  LOG_MEM(INFO) << "Allocate " << size << "b at 0x" << std::hex << ptr;
   return ptr;
 }
 
-Handle MemoryManager::AllocateHandle(uint32_t size, std::string tag) {
-  Ptr block = Allocate(size);
-  Handle handle = kHeapStart + handle_offset_;
-
-  LOG_MEM(INFO) << "Handle " << (handle_offset_ / sizeof(Handle)) << " ["
-                << std::hex << handle << "] for '" << tag << "'";
-
+Handle MemoryManager::NewMasterPointer() {
+  if (!free_master_pointers_.empty()) {
+    Handle handle = free_master_pointers_.back();
+    free_master_pointers_.pop_back();
+    return handle;
+  }
   CHECK_LT(handle_offset_, kHeapHandleOffset);
-
+  Handle handle = kHeapStart + handle_offset_;
   handle_offset_ += sizeof(Handle);
   LOG_MEM(INFO) << "Handles used: " << handle_offset_ / sizeof(Handle);
+  return handle;
+}
+
+Handle MemoryManager::AllocateHandle(uint32_t size, std::string tag) {
+  Handle handle = NewMasterPointer();
+  uint32_t address = AllocateBlock(size, handle);
+  CHECK_NE(address, 0u) << "Out of heap memory allocating " << size
+                        << "b for '" << tag << "'";
+  Ptr block = address + kBlockHeaderSize;
+
+  LOG_MEM(INFO) << "Handle [" << std::hex << handle << "] for '" << tag
+                << "' at 0x" << block;
 
   CHECK(kSystemMemory.Write<uint32_t>(handle, block).ok());
 
-  HandleMetadata metadata;
+  HandleMetadata& metadata = handles_[(handle - kHeapStart) / sizeof(Handle)];
+  metadata = HandleMetadata();
+  metadata.allocated = true;
   metadata.tag = std::move(tag);
   metadata.start = block;
   metadata.end = block + size;
   metadata.size = size;
-
-  handle_to_metadata_.insert({handle, std::move(metadata)});
   return handle;
 }
 
+const MemoryManager::HandleMetadata* MemoryManager::FindHandle(
+    Handle handle) const {
+  const uint32_t offset = handle - kHeapStart;
+  if (handle < kHeapStart || offset >= kHeapHandleOffset ||
+      offset % sizeof(Handle) != 0) {
+    return nullptr;
+  }
+  const HandleMetadata& metadata = handles_[offset / sizeof(Handle)];
+  return metadata.allocated ? &metadata : nullptr;
+}
+
+MemoryManager::HandleMetadata& MemoryManager::GetHandle(Handle handle) {
+  HandleMetadata* metadata = FindHandle(handle);
+  CHECK(metadata) << "Handle (0x" << std::hex << handle
+                  << ") can not be found.";
+  return *metadata;
+}
+
+uint32_t MemoryManager::AllocateBlock(uint32_t logical_size, Handle handle) {
+  uint32_t physical_size = PhysicalSizeFor(logical_size);
+
+  uint32_t address = TakeFreeBlock(physical_size);
+  if (address == 0) {
+    Compact();
+    address = TakeFreeBlock(physical_size);
+  }
+  if (address == 0) {
+    Purge();
+    Compact();
+    address = TakeFreeBlock(physical_size);
+  }
+  if (address == 0)
+    return 0;
+
+  Block block{physical_size, logical_size, handle};
+  blocks_[address] = block;
+  WriteBlockHeader(address, block);
+
+  // Blocks may be reused so clear them like fresh memory
+  std::vector<uint8_t> zeros(logical_size, 0);
+  CHECK_OK(kSystemMemory.WriteRaw(zeros.data(), address + kBlockHeaderSize,
+                                  logical_size));
+  NotifyCodeWrite(address, address + physical_size);
+
+  heap_high_water_ =
+      std::max<size_t>(heap_high_water_, address + physical_size - kHeapStart);
+  return address;
+}
+
+uint32_t MemoryManager::TakeFreeBlock(uint32_t& physical_size) {
+  for (auto it = free_blocks_.begin(); it != free_blocks_.end(); ++it) {
+    if (it->second < physical_size)
+      continue;
+
+    const uint32_t address = it->first;
+    const uint32_t remainder = it->second - physical_size;
+    free_blocks_.erase(it);
+    // A remainder too small to be a block of its own is kept as padding
+    if (remainder >= kMinBlockSize)
+      AddFreeBlock(address + physical_size, remainder);
+    else
+      physical_size += remainder;
+    return address;
+  }
+  return 0;
+}
+
+void MemoryManager::AddFreeBlock(uint32_t address, uint32_t physical_size) {
+  free_blocks_[address] = physical_size;
+  CHECK_OK(kSystemMemory.Write<uint32_t>(
+      address, (kFreeTag << 24) | (physical_size & 0x00FFFFFF)));
+}
+
+void MemoryManager::FreeBlock(uint32_t address) {
+  auto entry = blocks_.find(address);
+  CHECK(entry != blocks_.end())
+      << "No block at 0x" << std::hex << address << " to free";
+  uint32_t size = entry->second.physical_size;
+  blocks_.erase(entry);
+  // Any code in the block is gone (and its space may be reused)
+  NotifyCodeWrite(address, address + size);
+
+  // Coalesce with the free blocks on either side
+  auto next = free_blocks_.find(address + size);
+  if (next != free_blocks_.end()) {
+    size += next->second;
+    free_blocks_.erase(next);
+  }
+  auto prev = free_blocks_.lower_bound(address);
+  if (prev != free_blocks_.begin()) {
+    --prev;
+    if (prev->first + prev->second == address) {
+      address = prev->first;
+      size += prev->second;
+      free_blocks_.erase(prev);
+    }
+  }
+  AddFreeBlock(address, size);
+}
+
+void MemoryManager::WriteBlockHeader(uint32_t address,
+                                     const Block& block) const {
+  uint8_t tag = block.handle ? kRelocatableTag : kNonrelocatableTag;
+  // The low nibble is the padding beyond the logical size
+  tag |= (block.physical_size - kBlockHeaderSize - block.logical_size) & 0xF;
+  CHECK_OK(kSystemMemory.Write<uint32_t>(
+      address, (tag << 24) | (block.physical_size & 0x00FFFFFF)));
+  CHECK_OK(kSystemMemory.Write<uint32_t>(
+      address + 4, block.handle ? block.handle - kHeapStart : kHeapStart));
+}
+
+bool MemoryManager::IsMovable(const Block& block) const {
+  if (block.handle == 0)
+    return false;
+  const HandleMetadata* metadata = FindHandle(block.handle);
+  return metadata && !metadata->locked;
+}
+
+uint32_t MemoryManager::Compact() {
+  std::map<uint32_t, Block> compacted;
+  uint32_t dest = kZoneStart;
+  for (const auto& [address, block] : blocks_) {
+    if (!IsMovable(block)) {
+      compacted[address] = block;
+      dest = address + block.physical_size;
+      continue;
+    }
+    if (dest < address) {
+      // Blocks only move down so a copy through a buffer is enough
+      std::vector<uint8_t> data(
+          kSystemMemory.raw_ptr() + address,
+          kSystemMemory.raw_ptr() + address + block.physical_size);
+      CHECK_OK(kSystemMemory.WriteRaw(data.data(), dest, data.size()));
+      // Covers both where the block was and where it is now
+      NotifyCodeWrite(dest, address + block.physical_size);
+
+      Ptr ptr = dest + kBlockHeaderSize;
+      CHECK_OK(kSystemMemory.Write<uint32_t>(block.handle, ptr));
+      HandleMetadata& metadata = GetHandle(block.handle);
+      metadata.start = ptr;
+      metadata.end = ptr + metadata.size;
+      LOG_MEM(INFO) << "Moved '" << metadata.tag << "' from 0x" << std::hex
+                    << address << " to 0x" << dest;
+    }
+    compacted[dest] = block;
+    dest += block.physical_size;
+  }
+  blocks_ = std::move(compacted);
+  RebuildFreeBlocks();
+  return MaxBlock(/*purge=*/false);
+}
+
+void MemoryManager::Purge() {
+  for (size_t slot = 0; slot < handles_.size(); ++slot) {
+    HandleMetadata& metadata = handles_[slot];
+    if (!metadata.allocated || !metadata.purgeable || metadata.locked ||
+        metadata.start == 0) {
+      continue;
+    }
+    const Handle handle = kHeapStart + slot * sizeof(Handle);
+
+    LOG_MEM(INFO) << "Purge '" << metadata.tag << "'";
+    FreeBlock(metadata.start - kBlockHeaderSize);
+    CHECK_OK(kSystemMemory.Write<uint32_t>(handle, 0));
+    metadata.start = metadata.end = metadata.size = 0;
+  }
+}
+
+void MemoryManager::RebuildFreeBlocks() {
+  free_blocks_.clear();
+  uint32_t cursor = kZoneStart;
+  for (const auto& [address, block] : blocks_) {
+    if (cursor < address)
+      AddFreeBlock(cursor, address - cursor);
+    cursor = address + block.physical_size;
+  }
+  if (cursor < HeapEnd())
+    AddFreeBlock(cursor, HeapEnd() - cursor);
+}
+
+uint32_t MemoryManager::LargestPhysicalBlock(bool purge) const {
+  // Compaction gathers all of the free space between each pair of immovable
+  // blocks at the top of that span.
+  uint32_t largest = 0;
+  uint32_t span_free = 0;
+  uint32_t cursor = kZoneStart;
+  for (const auto& [address, block] : blocks_) {
+    span_free += address - cursor;
+    cursor = address + block.physical_size;
+    if (!IsMovable(block)) {
+      largest = std::max(largest, span_free);
+      span_free = 0;
+    } else if (purge && FindHandle(block.handle)->purgeable) {
+      span_free += block.physical_size;
+    }
+  }
+  span_free += HeapEnd() - cursor;
+  return std::max(largest, span_free);
+}
+
+uint32_t MemoryManager::MaxBlock(bool purge) const {
+  uint32_t largest = LargestPhysicalBlock(purge);
+  return largest > kBlockHeaderSize ? largest - kBlockHeaderSize : 0;
+}
+
 Handle MemoryManager::AllocateHandleForRegion(const core::MemoryRegion& region,
                                               std::string tag) {
   Handle handle = AllocateHandle(region.size(), tag);
   size_t load_addr = MUST(kSystemMemory.Read<uint32_t>(handle));
 
-  for (size_t i = 0; i < region.size(); ++i) {
-    CHECK(kSystemMemory
-              .Write<uint8_t>(load_addr + i, MUST(region.Read<uint8_t>(i)))
-              .ok());
-  }
+  CHECK_OK(kSystemMemory.WriteRaw(region.raw_ptr(), load_addr, region.size()));
   return handle;
 }
 
 Ptr MemoryManager::GetPtrForHandle(Handle handle) const {
-  auto entry = handle_to_metadata_.find(handle);
-  CHECK(entry != handle_to_metadata_.cend())
-      << "Handle (0x" << std::hex << handle << ") can not be found.";
-
-  auto current_ptr = MUST(kSystemMemory.Read<uint32_t>(entry->first));
+  const HandleMetadata* metadata = FindHandle(handle);
+  CHECK(metadata) << "Handle (0x" << std::hex << handle
+                  << ") can not be found.";
 
-  const HandleMetadata& metadata = entry->second;
-  CHECK_EQ(current_ptr, metadata.start);
+  auto current_ptr = MUST(kSystemMemory.Read<uint32_t>(handle));
+  CHECK_EQ(current_ptr, metadata->start);
 
   return current_ptr;
 }
 
-void MemoryManager::UpdateHandle(Handle handle,
-                                 uint32_t new_address,
-                                 uint32_t new_size) {
-  auto entry = handle_to_metadata_.find(handle);
-  CHECK(entry != handle_to_metadata_.cend())
-      << "Handle (0x" << std::hex << handle << ") can not be found.";
+bool MemoryManager::SetHandleSize(Handle handle, uint32_t new_size) {
+  HandleMetadata& metadata = GetHandle(handle);
+
+  const uint32_t old_size = metadata.size;
+  uint32_t address = metadata.start ? metadata.start - kBlockHeaderSize : 0;
+  const uint32_t physical_size = PhysicalSizeFor(new_size);
+
+  if (address != 0) {
+    Block& block = blocks_.at(address);
+    uint32_t available = block.physical_size;
+    auto next = free_blocks_.find(address + block.physical_size);
+    if (next != free_blocks_.end())
+      available += next->second;
+
+    if (physical_size <= available) {
+      // Resize in place giving back (or taking from) the next free block
+      if (next != free_blocks_.end())
+        free_blocks_.erase(next);
+      const uint32_t remainder = available - physical_size;
+      block.physical_size = physical_size;
+      if (remainder >= kMinBlockSize)
+        AddFreeBlock(address + physical_size, remainder);
+      else
+        block.physical_size += remainder;
+      block.logical_size = new_size;
+      WriteBlockHeader(address, block);
+      heap_high_water_ = std::max<size_t>(
+          heap_high_water_, address + block.physical_size - kHeapStart);
+    } else if (metadata.locked) {
+      return false;
+    } else {
+      address = 0;
+    }
+  }
+
+  if (address == 0) {
+    // Move the contents to a new block (the old block is freed first so its
+    // space can be reused and it can not be moved out from under the copy).
+    const bool was_empty = metadata.start == 0;
+    std::vector<uint8_t> data(kSystemMemory.raw_ptr() + metadata.start,
+                              kSystemMemory.raw_ptr() + metadata.start +
+                                  std::min(old_size, new_size));
+    if (!was_empty) {
+      FreeBlock(metadata.start - kBlockHeaderSize);
+      // Otherwise purging to make room would free the old block again
+      metadata.start = metadata.end = 0;
+    }
+
+    address = AllocateBlock(new_size, handle);
+    const bool fits = address != 0;
+    if (!fits) {
+      if (was_empty)
+        return false;
+      // Put back the original block which must fit where it was freed
+      address = AllocateBlock(old_size, handle);
+      CHECK_NE(address, 0u);
+    }
+    CHECK_OK(kSystemMemory.WriteRaw(data.data(), address + kBlockHeaderSize,
+                                    data.size()));
+    metadata.start = address + kBlockHeaderSize;
+    metadata.end = metadata.start + metadata.size;
+    CHECK_OK(kSystemMemory.Write<uint32_t>(handle, metadata.start));
+    if (!fits)
+      return false;
+  } else if (new_size > old_size) {
+    // The space taken from the next free block is not cleared
+    std::vector<uint8_t> zeros(new_size - old_size, 0);
+    CHECK_OK(kSystemMemory.WriteRaw(zeros.data(), metadata.start + old_size,
+                                    zeros.size()));
+  }
+
+  metadata.size = new_size;
+  metadata.end = metadata.start + new_size;
+  return true;
+}
+
+void MemoryManager::SetHandleLocked(Handle handle, bool locked) {
+  GetHandle(handle).locked = locked;
+}
+
+void MemoryManager::SetHandlePurgeable(Handle handle, bool purgeable) {
+  GetHandle(handle).purgeable = purgeable;
+}
 
-  CHECK_OK(kSystemMemory.Write<uint32_t>(entry->first, new_address));
+bool MemoryManager::IsHandleLocked(Handle handle) const {
+  const HandleMetadata* metadata = FindHandle(handle);
+  return metadata && metadata->locked;
+}
 
-  entry->second.start = new_address;
-  entry->second.size = new_size;
+bool MemoryManager::IsHandlePurged(Handle handle) const {
+  const HandleMetadata* metadata = FindHandle(handle);
+  return metadata && metadata->start == 0;
 }
 
 core::MemoryRegion MemoryManager::GetRegionForHandle(Handle handle) const {
-  auto entry = handle_to_metadata_.find(handle);
-  CHECK(entry != handle_to_metadata_.cend())
-      << "Handle (0x" << std::hex << handle << ") can not be found.";
+  const HandleMetadata* metadata = FindHandle(handle);
+  CHECK(metadata) << "Handle (0x" << std::hex << handle
+                  << ") can not be found.";
 
-  const HandleMetadata& metadata = entry->second;
-  auto current_ptr = MUST(kSystemMemory.Read<uint32_t>(entry->first));
-  CHECK_EQ(current_ptr, metadata.start);
+  auto current_ptr = MUST(kSystemMemory.Read<uint32_t>(handle));
+  CHECK_EQ(current_ptr, metadata->start);
 
-  return MUST(kSystemMemory.Create(absl::StrCat("Handle[", metadata.tag, "]"),
-                                   metadata.start, metadata.size));
+  return MUST(kSystemMemory.Create(absl::StrCat("Handle[", metadata->tag, "]"),
+                                   metadata->start, metadata->size));
 }
 
 bool MemoryManager::Deallocate(Handle handle) {
-  auto entry = handle_to_metadata_.find(handle);
-  if (entry == handle_to_metadata_.cend()) {
+  HandleMetadata* metadata = FindHandle(handle);
+  if (metadata == nullptr) {
     LOG(ERROR) << "Handle was already deallocated...";
     return false;
   }
 
-  LOG(INFO) << "Dealloc: '" << entry->second.tag << "'";
-  handle_to_metadata_.erase(handle);
+  LOG(INFO) << "Dealloc: '" << metadata->tag << "'";
+  if (metadata->start != 0)
+    FreeBlock(metadata->start - kBlockHeaderSize);
+  *metadata = HandleMetadata();
+  CHECK_OK(kSystemMemory.Write<uint32_t>(handle, 0));
+  free_master_pointers_.push_back(handle);
+  return true;
+}
+
+bool MemoryManager::DeallocatePtr(Ptr ptr) {
+  auto entry = blocks_.find(ptr - kBlockHeaderSize);
+  if (entry == blocks_.cend() || entry->second.handle != 0) {
+    LOG(ERROR) << "Ptr 0x" << std::hex << ptr << " is not a heap block";
+    return false;
+  }
+  FreeBlock(entry->first);
+
+  // Release the master pointer made for the block by `RecoverHandle()`
+  auto recovered = recovered_handles_.find(ptr);
+  if (recovered != recovered_handles_.end()) {
+    CHECK_OK(kSystemMemory.Write<uint32_t>(recovered->second, 0));
+    free_master_pointers_.push_back(recovered->second);
+    recovered_handles_.erase(recovered);
+  }
   return true;
 }
 
 std::string MemoryManager::GetTag(Handle handle) const {
-  auto entry = handle_to_metadata_.find(handle);
-  if (entry == handle_to_metadata_.cend()) {
+  const HandleMetadata* metadata = FindHandle(handle);
+  if (metadata == nullptr) {
     return {};
   }
-  return entry->second.tag;
+  return metadata->tag;
 }
 
 Handle MemoryManager::GetHandleThatContains(uint32_t address) const {
-  for (const auto& entry : handle_to_metadata_) {
-    if (address < entry.second.end && address >= entry.second.start) {
-      return entry.first;
-    }
-  }
-  return 0;
+  // The last block starting at or before `address` is the only candidate
+  auto entry = blocks_.upper_bound(address);
+  if (entry == blocks_.cbegin())
+    return 0;
+  --entry;
+  const uint32_t start = entry->first + kBlockHeaderSize;
+  if (address < start || address >= start + entry->second.logical_size)
+    return 0;
+  return entry->second.handle;
 }
 
 uint32_t MemoryManager::GetHandleSize(Handle handle) const {
-  auto entry = handle_to_metadata_.find(handle);
-  if (entry == handle_to_metadata_.cend()) {
+  const HandleMetadata* metadata = FindHandle(handle);
+  if (metadata == nullptr) {
     NOTREACHED() << "Handle 0x" << std::hex << handle << " does not exist!";
     return {};
   }
-  return entry->second.size;
+  return metadata->size;
 }
 
 bool MemoryManager::SetApplLimit(Ptr last_addr) {
-  if (last_addr >= kHeapEnd) {
+  if (last_addr >= HeapEnd()) {
     LOG(WARNING) << "Requested more heap memory than available";
     return false;
   }
@@ -169,15 +510,111 @@ bool MemoryManager::SetApplLimit(Ptr last_addr) {
 }
 
 uint32_t MemoryManager::GetFreeMemorySize() const {
-  return kHeapEnd - heap_offset_;
+  uint32_t free_size = 0;
+  for (const auto& [address, size] : free_blocks_) {
+    free_size += size;
+  }
+  return free_size;
 }
 
 Handle MemoryManager::RecoverHandle(Ptr ptr) {
-  Handle handle = kHeapStart + handle_offset_;
+  auto entry = blocks_.find(ptr - kBlockHeaderSize);
+  if (entry != blocks_.cend() && entry->second.handle != 0)
+    return entry->second.handle;
+
+  // Not a relocatable block so make a master pointer which refers to it (once)
+  auto recovered = recovered_handles_.find(ptr);
+  if (recovered != recovered_handles_.cend())
+    return recovered->second;
+  Handle handle = NewMasterPointer();
   CHECK(kSystemMemory.Write<uint32_t>(handle, ptr).ok());
-  handle_offset_ += sizeof(Handle);
+  recovered_handles_[ptr] = handle;
   return handle;
 }
 
+void MemoryManager::SaveState(core::SnapshotWriter& writer) const {
+  writer.Write<uint64_t>(handle_offset_);
+  writer.Write<uint32_t>(free_master_pointers_.size());
+  for (Handle handle : free_master_pointers_) {
+    writer.Write<Handle>(handle);
+  }
+  writer.Write<uint32_t>(std::count_if(
+      handles_.begin(), handles_.end(),
+      [](const HandleMetadata& metadata) { return metadata.allocated; }));
+  for (size_t slot = 0; slot < handles_.size(); ++slot) {
+    const HandleMetadata& metadata = handles_[slot];
+    if (!metadata.allocated)
+      continue;
+    writer.Write<Handle>(kHeapStart + slot * sizeof(Handle));
+    writer.WriteString(metadata.tag);
+    writer.Write<uint32_t>(metadata.start);
+    writer.Write<uint32_t>(metadata.end);
+    writer.Write<uint32_t>(metadata.size);
+    writer.Write<uint8_t>(metadata.locked);
+    writer.Write<uint8_t>(metadata.purgeable);
+  }
+  // Free blocks are the gaps between blocks (and their headers are in memory)
+  writer.Write<uint32_t>(blocks_.size());
+  for (const auto& [address, block] : blocks_) {
+    writer.Write<uint32_t>(address);
+    writer.Write<uint32_t>(block.physical_size);
+    writer.Write<uint32_t>(block.logical_size);
+    writer.Write<Handle>(block.handle);
+  }
+  writer.Write<uint32_t>(recovered_handles_.size());
+  for (const auto& [ptr, handle] : recovered_handles_) {
+    writer.Write<Ptr>(ptr);
+    writer.Write<Handle>(handle);
+  }
+}
+
+absl::Status MemoryManager::RestoreState(core::SnapshotReader& reader) {
+  handle_offset_ = TRY(reader.Read<uint64_t>());
+  free_master_pointers_.clear();
+  auto free_count = TRY(reader.Read<uint32_t>());
+  for (uint32_t i = 0; i < free_count; ++i) {
+    free_master_pointers_.push_back(TRY(reader.Read<Handle>()));
+  }
+  handles_.assign(handles_.size(), HandleMetadata());
+  auto count = TRY(reader.Read<uint32_t>());
+  for (uint32_t i = 0; i < count; ++i) {
+    auto handle = TRY(reader.Read<Handle>());
+    if (handle < kHeapStart || handle - kHeapStart >= kHeapHandleOffset) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid handle in snapshot: ", handle));
+    }
+    HandleMetadata metadata;
+    metadata.allocated = true;
+    metadata.tag = TRY(reader.ReadString());
+    metadata.start = TRY(reader.Read<uint32_t>());
+    metadata.end = TRY(reader.Read<uint32_t>());
+    metadata.size = TRY(reader.Read<uint32_t>());
+    metadata.locked = TRY(reader.Read<uint8_t>());
+    metadata.purgeable = TRY(reader.Read<uint8_t>());
+    handles_[(handle - kHeapStart) / sizeof(Handle)] = std::move(metadata);
+  }
+  blocks_.clear();
+  heap_high_water_ = kHeapHandleOffset;
+  auto block_count = TRY(reader.Read<uint32_t>());
+  for (uint32_t i = 0; i < block_count; ++i) {
+    auto address = TRY(reader.Read<uint32_t>());
+    Block block;
+    block.physical_size = TRY(reader.Read<uint32_t>());
+    block.logical_size = TRY(reader.Read<uint32_t>());
+    block.handle = TRY(reader.Read<Handle>());
+    blocks_[address] = block;
+    heap_high_water_ = std::max<size_t>(
+        heap_high_water_, address + block.physical_size - kHeapStart);
+  }
+  RebuildFreeBlocks();
+  recovered_handles_.clear();
+  auto recovered_count = TRY(reader.Read<uint32_t>());
+  for (uint32_t i = 0; i < recovered_count; ++i) {
+    auto ptr = TRY(reader.Read<Ptr>());
+    recovered_handles_[ptr] = TRY(reader.Read<Handle>());
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace memory
 }  // namespace cyder
\ No newline at end of file
@@ -7,30 +7,48 @@
 #include <map>
 #include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "core/memory_region.h"
+#include "core/snapshot.h"
+#include "emu/machine.h"
 #include "emu/memory/memory_map.h"
 #include "gen/typegen/generated_types.tdef.h"
 
 namespace cyder {
 namespace memory {
 
+// The application heap zone. Master pointers fill the first
+// `kHeapHandleOffset` bytes and blocks (each preceded by a header) the rest.
+// Relocatable blocks which are not locked are slid down to fill free space when
+// an allocation does not otherwise fit, and purgeable blocks are purged only
+// if that is still not enough.
 class MemoryManager {
  public:
   static constexpr size_t kHeapHandleOffset{4096};
+  // Mirrors the 24-bit Memory Manager: a tag byte and the 24-bit physical size
+  // followed by the offset of the master pointer from the zone (relocatable)
+  // or the zone itself (nonrelocatable).
+  static constexpr size_t kBlockHeaderSize{8};
 
   MemoryManager();
+  ~MemoryManager();
 
   static MemoryManager& the();
 
+  // Allocates a nonrelocatable block which is cleared to zero.
   Ptr Allocate(uint32_t size);
   Handle AllocateHandle(uint32_t size, std::string tag);
   Handle AllocateHandleForRegion(const core::MemoryRegion& region,
                                  std::string tag);
   bool Deallocate(Handle handle);
+  bool DeallocatePtr(Ptr ptr);
 
+  // Returns whether `size` bytes can be allocated (after compacting and
+  // purging the heap if needed).
   bool HasSpaceForAllocation(uint32_t size) const {
-    return heap_offset_ + size < kHeapEnd;
+    return PhysicalSizeFor(size) <= LargestPhysicalBlock(/*purge=*/true);
   }
 
   std::string GetTag(Handle handle) const;
@@ -42,10 +60,30 @@ class MemoryManager {
 
   uint32_t GetHandleSize(Handle handle) const;
 
-  void UpdateHandle(Handle handle, uint32_t new_address, uint32_t new_size);
+  // Resizes the block of `handle` (in place if possible otherwise it is moved
+  // unless locked). Returns false if there is not enough memory.
+  bool SetHandleSize(Handle handle, uint32_t new_size);
+
+  void SetHandleLocked(Handle handle, bool locked);
+  void SetHandlePurgeable(Handle handle, bool purgeable);
+  bool IsHandleLocked(Handle handle) const;
+  // Returns whether the block of `handle` has been purged (its master pointer
+  // is NIL). `SetHandleSize()` allocates it a new block.
+  bool IsHandlePurged(Handle handle) const;
+
+  // Moves all relocatable blocks which are not locked to the bottom of the
+  // heap and returns the largest free block (in logical bytes).
+  uint32_t Compact();
+  // Empties the handle of every purgeable block which is not locked.
+  void Purge();
+  // The largest block which could be allocated after compacting the heap
+  // (and purging it if `purge` is true).
+  uint32_t MaxBlock(bool purge) const;
 
   bool SetApplLimit(Ptr last_addr);
   uint32_t GetFreeMemorySize() const;
+  // The most heap (in bytes from `kHeapStart`) in use at once so far.
+  size_t heap_high_water() const { return heap_high_water_; }
 
   Handle RecoverHandle(Ptr ptr);
 
@@ -69,27 +107,84 @@ class MemoryManager {
     return handle;
   }
 
+  // Saves/restores the heap and handle bookkeeping (see emu/save_state.h).
+  void SaveState(core::SnapshotWriter& writer) const;
+  absl::Status RestoreState(core::SnapshotReader& reader);
+
   std::string LogHandles() {
     std::stringstream os;
-    for (const auto& handle_pair : handle_to_metadata_) {
-      os << "\n0x" << std::hex << handle_pair.first << " -> 0x"
-         << handle_pair.second.start << " (" << handle_pair.second.tag << ")";
+    for (size_t slot = 0; slot < handles_.size(); ++slot) {
+      if (!handles_[slot].allocated)
+        continue;
+      os << "\n0x" << std::hex << kHeapStart + slot * sizeof(Handle)
+         << " -> 0x" << handles_[slot].start << " (" << handles_[slot].tag
+         << ")";
     }
     return os.str();
   }
 
  private:
-  size_t heap_offset_{kHeapHandleOffset};
+  struct Block {
+    // Includes the header and any padding
+    uint32_t physical_size;
+    uint32_t logical_size;
+    // The master pointer or 0 if nonrelocatable
+    Handle handle;
+  };
+
+  static uint32_t PhysicalSizeFor(uint32_t logical_size);
+
+  // Returns the address of the header of a new block or 0 if there is no room
+  // (even after compacting and purging the heap).
+  uint32_t AllocateBlock(uint32_t logical_size, Handle handle);
+  // Takes `physical_size` bytes from the first free block large enough
+  // (growing `physical_size` to absorb a remainder too small to split off).
+  uint32_t TakeFreeBlock(uint32_t& physical_size);
+  void FreeBlock(uint32_t address);
+  void AddFreeBlock(uint32_t address, uint32_t physical_size);
+  void WriteBlockHeader(uint32_t address, const Block& block) const;
+  bool IsMovable(const Block& block) const;
+  uint32_t LargestPhysicalBlock(bool purge) const;
+  // Rebuilds `free_blocks_` from the gaps between `blocks_`.
+  void RebuildFreeBlocks();
+
+  Handle NewMasterPointer();
+
   size_t handle_offset_{0};
+  size_t heap_high_water_{kHeapHandleOffset};
+  // Master pointers released by disposed handles which can be reused
+  std::vector<Handle> free_master_pointers_;
 
   struct HandleMetadata {
+    bool allocated = false;
     std::string tag;
     uint32_t start;
     uint32_t end;
     uint32_t size;
+    bool locked = false;
+    bool purgeable = false;
   };
 
-  std::map<Handle, HandleMetadata> handle_to_metadata_;
+  // Returns the metadata for `handle` or nullptr if it is not allocated.
+  const HandleMetadata* FindHandle(Handle handle) const;
+  HandleMetadata* FindHandle(Handle handle) {
+    return const_cast<HandleMetadata*>(std::as_const(*this).FindHandle(handle));
+  }
+  // Like `FindHandle()` but `handle` must be allocated.
+  HandleMetadata& GetHandle(Handle handle);
+
+  // Indexed by the slot of the master pointer in the table at `kHeapStart`
+  std::vector<HandleMetadata> handles_;
+  // Allocated blocks keyed by the address of their header. This doubles as
+  // the index of which block contains an address.
+  std::map<uint32_t, Block> blocks_;
+  std::map<uint32_t, uint32_t> free_blocks_;
+  // Master pointers made by `RecoverHandle()` for nonrelocatable blocks which
+  // are released along with the block.
+  std::map<Ptr, Handle> recovered_handles_;
+
+  // The machine this is registered with (until it is destroyed).
+  Machine& machine_;
 };
 
 }  // namespace memory
@@ -0,0 +1,284 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/memory/memory_manager.h"
+
+#include <gtest/gtest.h>
+
+#include <utility>
+#include <vector>
+
+#include "core/memory_region.h"
+#include "core/snapshot.h"
+#include "core/status_helpers.h"
+#include "emu/memory/code_pages.h"
+#include "emu/memory/memory_map.h"
+
+namespace cyder {
+namespace memory {
+namespace {
+
+// The ranges published to code-write listeners (see `NotifyCodeWrite()`).
+std::vector<std::pair<uint32_t, uint32_t>>& CodeWrites() {
+  static auto* writes = [] {
+    auto* writes = new std::vector<std::pair<uint32_t, uint32_t>>();
+    AddCodeWriteListener([writes](uint32_t start, uint32_t end) {
+      writes->emplace_back(start, end);
+    });
+    return writes;
+  }();
+  return *writes;
+}
+
+bool WasPublished(uint32_t start, uint32_t end) {
+  for (const auto& [write_start, write_end] : CodeWrites()) {
+    if (write_start <= start && end <= write_end)
+      return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+TEST(MemoryManagerTests, SaveAndRestoreState) {
+  MemoryManager memory_manager;
+  Handle handle = memory_manager.AllocateHandle(16, "Test");
+  CHECK_OK(kSystemMemory.Write<uint32_t>(
+      memory_manager.GetPtrForHandle(handle), 0xCAFEF00D));
+  CHECK_OK(SetA5WorldBounds(/*above_a5=*/32, /*below_a5=*/64));
+
+  core::SnapshotWriter writer;
+  SaveMemoryMap(writer);
+  memory_manager.SaveState(writer);
+
+  memory_manager.AllocateHandle(32, "Not Saved");
+  CHECK_OK(kSystemMemory.Write<uint32_t>(
+      memory_manager.GetPtrForHandle(handle), 0));
+  CHECK_OK(SetA5WorldBounds(0, 0));
+
+  MemoryManager restored;
+  core::SnapshotReader reader(writer.data());
+  CHECK_OK(RestoreMemoryMap(reader));
+  CHECK_OK(restored.RestoreState(reader));
+  EXPECT_TRUE(reader.at_end());
+
+  EXPECT_EQ(restored.GetTag(handle), "Test");
+  EXPECT_EQ(restored.GetHandleSize(handle), 16u);
+  Ptr ptr = restored.GetPtrForHandle(handle);
+  EXPECT_EQ(MUST(kSystemMemory.Read<uint32_t>(ptr)), 0xCAFEF00D);
+  EXPECT_EQ(GetA5WorldPosition(), StackStart() + 64);
+  // The handle allocated after saving is not known
+  EXPECT_EQ(restored.Allocate(4),
+            ptr + 16 + MemoryManager::kBlockHeaderSize);
+}
+
+TEST(MemoryManagerTests, ReusesAndCoalescesFreedBlocks) {
+  MemoryManager memory_manager;
+  Ptr first = memory_manager.Allocate(16);
+  Ptr second = memory_manager.Allocate(16);
+  Ptr third = memory_manager.Allocate(16);
+  const uint32_t free_size = memory_manager.GetFreeMemorySize();
+
+  EXPECT_TRUE(memory_manager.DeallocatePtr(first));
+  EXPECT_TRUE(memory_manager.DeallocatePtr(second));
+  EXPECT_FALSE(memory_manager.DeallocatePtr(second));
+  // The two freed blocks are merged and can satisfy a larger request
+  EXPECT_EQ(memory_manager.Allocate(32), first);
+
+  EXPECT_TRUE(memory_manager.DeallocatePtr(first));
+  EXPECT_TRUE(memory_manager.DeallocatePtr(third));
+  EXPECT_EQ(memory_manager.GetFreeMemorySize(),
+            free_size + 3 * (16 + MemoryManager::kBlockHeaderSize));
+}
+
+TEST(MemoryManagerTests, ReusesMasterPointers) {
+  MemoryManager memory_manager;
+  Handle handle = memory_manager.AllocateHandle(16, "First");
+  EXPECT_TRUE(memory_manager.Deallocate(handle));
+  EXPECT_EQ(memory_manager.AllocateHandle(8, "Second"), handle);
+  EXPECT_EQ(memory_manager.GetTag(handle), "Second");
+  EXPECT_EQ(MUST(kSystemMemory.Read<uint32_t>(handle)),
+            memory_manager.GetPtrForHandle(handle));
+}
+
+TEST(MemoryManagerTests, CompactMovesUnlockedHandles) {
+  MemoryManager memory_manager;
+  Handle freed = memory_manager.AllocateHandle(64, "Freed");
+  Handle locked = memory_manager.AllocateHandle(16, "Locked");
+  Handle moved = memory_manager.AllocateHandle(16, "Moved");
+  const Ptr freed_ptr = memory_manager.GetPtrForHandle(freed);
+  const Ptr locked_ptr = memory_manager.GetPtrForHandle(locked);
+  CHECK_OK(kSystemMemory.Write<uint32_t>(
+      memory_manager.GetPtrForHandle(moved), 0xCAFEF00D));
+
+  memory_manager.SetHandleLocked(locked, true);
+  EXPECT_TRUE(memory_manager.Deallocate(freed));
+  memory_manager.Compact();
+
+  // Only the block after the locked block could move (and it is in place)
+  EXPECT_EQ(memory_manager.GetPtrForHandle(locked), locked_ptr);
+  EXPECT_EQ(memory_manager.GetPtrForHandle(moved),
+            locked_ptr + 16 + MemoryManager::kBlockHeaderSize);
+
+  memory_manager.SetHandleLocked(locked, false);
+  memory_manager.Compact();
+  EXPECT_EQ(memory_manager.GetPtrForHandle(locked), freed_ptr);
+  Ptr moved_ptr = memory_manager.GetPtrForHandle(moved);
+  EXPECT_EQ(moved_ptr, freed_ptr + 16 + MemoryManager::kBlockHeaderSize);
+  EXPECT_EQ(MUST(kSystemMemory.Read<uint32_t>(moved)), moved_ptr);
+  EXPECT_EQ(MUST(kSystemMemory.Read<uint32_t>(moved_ptr)), 0xCAFEF00D);
+  EXPECT_EQ(memory_manager.GetHandleThatContains(moved_ptr + 4), moved);
+}
+
+TEST(MemoryManagerTests, GetHandleThatContains) {
+  MemoryManager memory_manager;
+  Handle first = memory_manager.AllocateHandle(16, "First");
+  Ptr ptr = memory_manager.Allocate(16);
+  Handle second = memory_manager.AllocateHandle(16, "Second");
+
+  Ptr first_ptr = memory_manager.GetPtrForHandle(first);
+  EXPECT_EQ(memory_manager.GetHandleThatContains(first_ptr), first);
+  EXPECT_EQ(memory_manager.GetHandleThatContains(first_ptr + 15), first);
+  // Block headers and nonrelocatable blocks do not belong to a handle
+  EXPECT_EQ(memory_manager.GetHandleThatContains(first_ptr - 1), 0u);
+  EXPECT_EQ(memory_manager.GetHandleThatContains(ptr), 0u);
+  EXPECT_EQ(memory_manager.GetHandleThatContains(
+                memory_manager.GetPtrForHandle(second) + 8),
+            second);
+  EXPECT_EQ(memory_manager.GetHandleThatContains(HeapEnd() - 1), 0u);
+  EXPECT_EQ(memory_manager.GetHandleThatContains(0), 0u);
+}
+
+TEST(MemoryManagerTests, SetHandleSizeKeepsContents) {
+  MemoryManager memory_manager;
+  Handle handle = memory_manager.AllocateHandle(4, "Grows");
+  memory_manager.Allocate(4);
+  CHECK_OK(kSystemMemory.Write<uint32_t>(
+      memory_manager.GetPtrForHandle(handle), 0xCAFEF00D));
+
+  // The nonrelocatable block after the handle means it has to move to grow
+  ASSERT_TRUE(memory_manager.SetHandleSize(handle, 64));
+  Ptr ptr = memory_manager.GetPtrForHandle(handle);
+  EXPECT_EQ(memory_manager.GetHandleSize(handle), 64u);
+  EXPECT_EQ(MUST(kSystemMemory.Read<uint32_t>(ptr)), 0xCAFEF00D);
+  EXPECT_EQ(MUST(kSystemMemory.Read<uint32_t>(ptr + 4)), 0u);
+
+  // Shrinking is always done in place
+  ASSERT_TRUE(memory_manager.SetHandleSize(handle, 8));
+  EXPECT_EQ(memory_manager.GetPtrForHandle(handle), ptr);
+  EXPECT_EQ(memory_manager.GetHandleSize(handle), 8u);
+}
+
+TEST(MemoryManagerTests, PurgesWhenOutOfMemory) {
+  MemoryManager memory_manager;
+  const uint32_t max_block = memory_manager.MaxBlock(/*purge=*/false);
+  Handle purgeable = memory_manager.AllocateHandle(max_block / 2, "Purge");
+  memory_manager.SetHandlePurgeable(purgeable, true);
+
+  EXPECT_LT(memory_manager.MaxBlock(/*purge=*/false), max_block / 2 + 1);
+  EXPECT_EQ(memory_manager.MaxBlock(/*purge=*/true), max_block);
+  EXPECT_TRUE(memory_manager.HasSpaceForAllocation(max_block));
+
+  memory_manager.SetHandleLocked(purgeable, true);
+  EXPECT_LT(memory_manager.MaxBlock(/*purge=*/true), max_block / 2 + 1);
+  memory_manager.SetHandleLocked(purgeable, false);
+
+  memory_manager.Allocate(max_block * 3 / 4);
+  EXPECT_EQ(MUST(kSystemMemory.Read<uint32_t>(purgeable)), 0u);
+  EXPECT_EQ(memory_manager.GetHandleSize(purgeable), 0u);
+  EXPECT_TRUE(memory_manager.IsHandlePurged(purgeable));
+
+  // A purged handle is given a new block when it is resized (i.e. reloaded)
+  ASSERT_TRUE(memory_manager.SetHandleSize(purgeable, 16));
+  EXPECT_FALSE(memory_manager.IsHandlePurged(purgeable));
+  EXPECT_EQ(MUST(kSystemMemory.Read<uint32_t>(purgeable)),
+            memory_manager.GetPtrForHandle(purgeable));
+}
+
+TEST(MemoryManagerTests, GrowsPurgeableHandleWhenOutOfMemory) {
+  MemoryManager memory_manager;
+  Handle grown = memory_manager.AllocateHandle(64, "Grown");
+  Handle neighbour = memory_manager.AllocateHandle(64, "Neighbour");
+  Handle other = memory_manager.AllocateHandle(1024, "Other");
+  memory_manager.SetHandlePurgeable(grown, true);
+  memory_manager.SetHandleLocked(neighbour, true);
+  memory_manager.SetHandlePurgeable(other, true);
+  memory_manager.Allocate(memory_manager.MaxBlock(/*purge=*/false));
+  CHECK_OK(kSystemMemory.Write<uint32_t>(
+      memory_manager.GetPtrForHandle(grown), 0xC0FFEE));
+
+  // Growing past the locked neighbour only fits once `other` is purged
+  ASSERT_TRUE(memory_manager.SetHandleSize(grown, 512));
+  EXPECT_TRUE(memory_manager.IsHandlePurged(other));
+  EXPECT_FALSE(memory_manager.IsHandlePurged(grown));
+  EXPECT_EQ(memory_manager.GetHandleSize(grown), 512u);
+  EXPECT_EQ(MUST(kSystemMemory.Read<uint32_t>(
+                memory_manager.GetPtrForHandle(grown))),
+            0xC0FFEEu);
+}
+
+TEST(MemoryManagerTests, PublishesReusedMemory) {
+  MemoryManager memory_manager;
+  ClearCodePages();
+  CodeWrites().clear();
+
+  Handle freed = memory_manager.AllocateHandle(64, "Freed");
+  Handle moved = memory_manager.AllocateHandle(64, "Moved");
+  const Ptr freed_ptr = memory_manager.GetPtrForHandle(freed);
+  const Ptr moved_ptr = memory_manager.GetPtrForHandle(moved);
+  MarkCodePages(freed_ptr, moved_ptr + 64);
+
+  EXPECT_TRUE(memory_manager.Deallocate(freed));
+  EXPECT_TRUE(WasPublished(freed_ptr, freed_ptr + 64));
+
+  // The block is slid down into the freed space
+  CodeWrites().clear();
+  memory_manager.Compact();
+  EXPECT_EQ(memory_manager.GetPtrForHandle(moved), freed_ptr);
+  EXPECT_TRUE(WasPublished(freed_ptr, moved_ptr + 64));
+
+  // The space it was moved from is reused for new code
+  CodeWrites().clear();
+  uint8_t code[] = {0x4E, 0x75 /* RTS */};
+  Handle loaded = memory_manager.AllocateHandleForRegion(
+      core::MemoryRegion(code, sizeof(code)), "Code");
+  const Ptr loaded_ptr = memory_manager.GetPtrForHandle(loaded);
+  EXPECT_EQ(loaded_ptr, moved_ptr);
+  ASSERT_FALSE(CodeWrites().empty());
+  EXPECT_LE(CodeWrites().back().first, loaded_ptr);
+  EXPECT_GE(CodeWrites().back().second, loaded_ptr + sizeof(code));
+  ClearCodePages();
+}
+
+TEST(MemoryManagerTests, RecoverHandleReusesMasterPointers) {
+  MemoryManager memory_manager;
+  Handle handle = memory_manager.AllocateHandle(16, "Relocatable");
+  EXPECT_EQ(
+      memory_manager.RecoverHandle(memory_manager.GetPtrForHandle(handle)),
+      handle);
+
+  Ptr ptr = memory_manager.Allocate(16);
+  Handle recovered = memory_manager.RecoverHandle(ptr);
+  EXPECT_EQ(MUST(kSystemMemory.Read<uint32_t>(recovered)), ptr);
+  EXPECT_EQ(memory_manager.RecoverHandle(ptr), recovered);
+
+  // The master pointer is released along with the block
+  EXPECT_TRUE(memory_manager.DeallocatePtr(ptr));
+  EXPECT_EQ(MUST(kSystemMemory.Read<uint32_t>(recovered)), 0u);
+  EXPECT_EQ(memory_manager.AllocateHandle(8, "Reused"), recovered);
+}
+
+TEST(MemoryManagerTests, RestoreTruncatedState) {
+  MemoryManager memory_manager;
+  memory_manager.AllocateHandle(16, "Test");
+
+  core::SnapshotWriter writer;
+  memory_manager.SaveState(writer);
+
+  core::SnapshotReader reader(
+      writer.data().substr(0, writer.data().size() - 1));
+  EXPECT_FALSE(memory_manager.RestoreState(reader).ok());
+}
+
+}  // namespace memory
+}  // namespace cyder
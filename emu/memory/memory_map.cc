@@ -3,12 +3,18 @@
 
 #include "memory_map.h"
 
+#include <algorithm>
 #include <iomanip>
 #include <sstream>
+#include <utility>
 
+#include "absl/numeric/bits.h"
 #include "absl/strings/str_cat.h"
 #include "core/logging.h"
+#include "core/status_helpers.h"
 #include "emu/debug/debug_manager.h"
+#include "emu/machine.h"
+#include "emu/memory/code_pages.h"
 #include "gen/global_names.h"
 
 namespace cyder {
@@ -18,13 +24,37 @@ namespace {
 // TODO: Add proper verbose logging support to core/logging.h
 constexpr bool verbose_logging = false;
 
-// Stores the size above/below the A5 World (used for bounds checking)
-uint32_t above_a5_size{0};
-uint32_t below_a5_size{0};
-uint32_t a5_world{0};
+// The top 1/`kA5WorldShare` of memory holds the A5 world and the stubs.
+constexpr size_t kA5WorldShare = 16;
 
-// Stores whether a given address is initialized (written to)
-bool kHasInitializedMemory[kSystemMemorySize];
+// Writes are tracked per page until they are reported to the `DebugManager`.
+constexpr size_t kDirtyPageShift = 8;
+constexpr size_t kDirtyPageSize = 1 << kDirtyPageShift;
+
+constexpr size_t WordCount(size_t bits) {
+  return (bits + 63) / 64;
+}
+
+bool TestBit(const std::vector<uint64_t>& bits, size_t index) {
+  return (bits[index / 64] >> (index % 64)) & 1;
+}
+
+// Sets bits [start, end) a word at a time.
+void SetBits(std::vector<uint64_t>& bits, size_t start, size_t end) {
+  if (start >= end)
+    return;
+  const size_t first = start / 64;
+  const size_t last = (end - 1) / 64;
+  const uint64_t first_mask = ~uint64_t{0} << (start % 64);
+  const uint64_t last_mask = ~uint64_t{0} >> (63 - (end - 1) % 64);
+  if (first == last) {
+    bits[first] |= first_mask & last_mask;
+    return;
+  }
+  bits[first] |= first_mask;
+  std::fill(bits.begin() + first + 1, bits.begin() + last, ~uint64_t{0});
+  bits[last] |= last_mask;
+}
 
 struct RegionEntry {
   std::string name;
@@ -33,8 +63,32 @@ struct RegionEntry {
   std::vector<Field> whitelist;
 };
 
-std::vector<RegionEntry> log_read_regions;
-std::vector<RegionEntry> log_write_regions;
+// The bookkeeping kept for each machine's memory (see emu/machine.h)
+struct MemoryMapState {
+  // Stores the size above/below the A5 World (used for bounds checking)
+  uint32_t above_a5_size{0};
+  uint32_t below_a5_size{0};
+  uint32_t a5_world{0};
+
+  // One bit per address which is set once it is initialized (written to)
+  std::vector<uint64_t> initialized =
+      std::vector<uint64_t>(WordCount(SystemMemorySize()));
+  // One bit per page which is set when it is written to and cleared once the
+  // write has been reported to the `DebugManager`
+  std::vector<uint64_t> dirty_pages =
+      std::vector<uint64_t>(WordCount(SystemMemorySize() / kDirtyPageSize));
+
+  std::vector<RegionEntry> log_read_regions;
+  std::vector<RegionEntry> log_write_regions;
+};
+
+MemoryMapState& State() {
+  return Machine::Current().Get<MemoryMapState>();
+}
+
+uint8_t kDefaultSystemMemory[kDefaultSystemMemorySize + kSystemMemoryGuardSize];
+
+bool is_memory_map_configured = false;
 
 constexpr GlobalVars kWhitelistReadGlobalVars[] = {
     GlobalVars::CurrentA5, GlobalVars::CurApName, GlobalVars::CurStackBase,
@@ -85,47 +139,198 @@ bool ShouldLogAccess(const RegionEntry& entry, uint32_t address) {
 
 }  // namespace
 
-uint8_t kSystemMemoryRaw[kSystemMemorySize];
-core::MemoryRegion kSystemMemory(&kSystemMemoryRaw, kSystemMemorySize);
+namespace {
+
+// Lays out the top of memory for `memory_size` and `stack_size`.
+constexpr MemoryLayout LayoutFor(size_t memory_size, size_t stack_size) {
+  MemoryLayout layout{};
+  layout.system_memory_size = memory_size;
+  layout.stack_size = stack_size;
+
+  layout.trap_manager_entry_address = memory_size - sizeof(uint16_t);
+  layout.trap_manager_exit_address =
+      layout.trap_manager_entry_address - sizeof(uint32_t);
+
+  layout.base_system_trap_address =
+      layout.trap_manager_exit_address - (256 * sizeof(uint16_t));
+  layout.base_toolbox_trap_address =
+      layout.base_system_trap_address - (1024 * sizeof(uint16_t));
+
+  layout.end_function_call_address =
+      layout.base_toolbox_trap_address - sizeof(uint16_t);
+  layout.vbl_interrupt_address =
+      layout.end_function_call_address - sizeof(uint16_t);
+  layout.last_emulated_subroutine_address = layout.vbl_interrupt_address;
+
+  // The A5 world fills the space between the stack and the stubs so it is
+  // given a fixed share of memory (32 KB of 512 KB) to grow with the machine.
+  layout.stack_start = memory_size - memory_size / kA5WorldShare;
+  layout.stack_end = layout.stack_start - stack_size;
+  layout.heap_end = layout.stack_end;
+  return layout;
+}
 
-class InitializedWatcher : public core::MemoryWatcher {
+static_assert(LayoutFor(kDefaultSystemMemorySize, kDefaultStackSize)
+                      .last_emulated_subroutine_address ==
+                  kDefaultSystemMemorySize - kStubRegionSize,
+              "kStubRegionSize must match the stubs laid out above");
+
+// Publishes writes which touch code (see code_pages.h) so that natives which
+// load or patch code through `kSystemMemory` invalidate it like the CPU does.
+class CodeWriteWatcher : public core::MemoryWatcher {
+ public:
   void OnWrite(size_t offset, size_t size) override {
-    DebugManager::Instance().RecordWrite(offset, offset + size);
-    for (int i = 0; i < size; ++i) {
-      kHasInitializedMemory[offset + i] = true;
-    }
+    if (size != 0)
+      NotifyCodeWrite(offset, offset + size);
   }
 };
 
+// Also tracks which bytes have been initialized and which pages are dirty.
+class InitializedWatcher : public CodeWriteWatcher {
+ public:
+  void OnWrite(size_t offset, size_t size) override {
+    CodeWriteWatcher::OnWrite(offset, size);
+    if (size == 0)
+      return;
+    MemoryMapState& state = State();
+    SetBits(state.initialized, offset, offset + size);
+    SetBits(state.dirty_pages, offset >> kDirtyPageShift,
+            ((offset + size - 1) >> kDirtyPageShift) + 1);
+  }
+};
+
+CodeWriteWatcher code_write_watcher;
+
+}  // namespace
+
+namespace internal {
+MemoryLayout memory_layout =
+    LayoutFor(kDefaultSystemMemorySize, kDefaultStackSize);
+}  // namespace internal
+
+uint8_t* kSystemMemoryRaw = kDefaultSystemMemory;
+core::MemoryRegion kSystemMemory =
+    CreateSystemMemoryRegion(kDefaultSystemMemory, kDefaultSystemMemorySize);
+
+core::MemoryRegion CreateSystemMemoryRegion(uint8_t* data, size_t size) {
+  core::MemoryRegion region(data, size);
+  region.SetWatcher(&code_write_watcher);
+  return region;
+}
+
+absl::Status ConfigureMemoryMap(size_t memory_size, size_t stack_size) {
+  if (is_memory_map_configured) {
+    return absl::FailedPreconditionError("Memory map is already configured");
+  }
+  if (memory_size < kMinSystemMemorySize ||
+      memory_size > kMaxSystemMemorySize ||
+      (memory_size & (memory_size - 1)) != 0) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Memory size must be a power of two between ", kMinSystemMemorySize,
+        " and ", kMaxSystemMemorySize, " bytes (not ", memory_size, ")"));
+  }
+  // The stack must leave room for the heap (and isn't allowed to be empty)
+  if (stack_size == 0 || stack_size % sizeof(uint32_t) != 0 ||
+      stack_size > memory_size / 2) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Stack size must be a non-zero multiple of 4 bytes and at most half "
+        "of memory (not ",
+        stack_size, ")"));
+  }
+
+  // The default machine holds `kSystemMemoryRaw` (sized for the old layout)
+  CHECK(!Machine::AnyCreated())
+      << "The memory map must be configured before any machine is created";
+
+  is_memory_map_configured = true;
+  internal::memory_layout = LayoutFor(memory_size, stack_size);
+
+  if (memory_size != kDefaultSystemMemorySize) {
+    // Released at exit along with the default machine which holds it
+    kSystemMemoryRaw = new uint8_t[memory_size + kSystemMemoryGuardSize]();
+    kSystemMemory = CreateSystemMemoryRegion(kSystemMemoryRaw, memory_size);
+  }
+  return absl::OkStatus();
+}
+
+// Reports the initialized runs of memory within each page written since the
+// last report (the `DebugManager` merges runs which span pages).
+void ReportDirtyPages() {
+  MemoryMapState& state = State();
+  DebugManager& debug_manager = DebugManager::Instance();
+  for (size_t word = 0; word < state.dirty_pages.size(); ++word) {
+    for (uint64_t dirty = std::exchange(state.dirty_pages[word], 0); dirty;
+         dirty &= dirty - 1) {
+      const size_t start = (word * 64 + absl::countr_zero(dirty))
+                           << kDirtyPageShift;
+      const size_t end = start + kDirtyPageSize;
+      for (size_t address = start; address < end;) {
+        if (!TestBit(state.initialized, address)) {
+          ++address;
+          continue;
+        }
+        const size_t run_start = address;
+        while (address < end && TestBit(state.initialized, address))
+          ++address;
+        debug_manager.RecordWrite(run_start, address);
+      }
+    }
+  }
+}
+
 void InstallMemoryWatcher() {
-  static core::MemoryWatcher* watcher = new InitializedWatcher();
-  kSystemMemory.SetWatcher(watcher);
+  static InitializedWatcher watcher;
+  kSystemMemory.SetWatcher(&watcher);
+  DebugManager::Instance().SetWriteReporter(&ReportDirtyPages);
 }
 
 uint32_t GetA5WorldPosition() {
-  return a5_world;
+  MemoryMapState& state = State();
+  return state.a5_world;
 }
 
 absl::Status SetA5WorldBounds(uint32_t above_a5, uint32_t below_a5) {
-  above_a5_size = above_a5;
-  below_a5_size = below_a5;
-  a5_world = kStackStart + below_a5_size;
+  MemoryMapState& state = State();
+  state.above_a5_size = above_a5;
+  state.below_a5_size = below_a5;
+  state.a5_world = StackStart() + state.below_a5_size;
 
-  if (above_a5_size + a5_world > kLastEmulatedSubroutineAddress) {
+  const size_t a5_world_end = state.a5_world + state.above_a5_size;
+  if (a5_world_end > LastEmulatedSubroutineAddress()) {
     return absl::FailedPreconditionError(absl::StrCat(
         "A5 World is too large for available memory by ",
-        (above_a5_size + a5_world - kLastEmulatedSubroutineAddress), " bytes"));
+        a5_world_end - LastEmulatedSubroutineAddress(), " bytes"));
   }
 
   return absl::OkStatus();
 }
 
+void SaveMemoryMap(core::SnapshotWriter& writer) {
+  MemoryMapState& state = State();
+  writer.WriteBytes(kSystemMemoryRaw, SystemMemorySize());
+  writer.WriteBytes(state.initialized.data(),
+                    state.initialized.size() * sizeof(uint64_t));
+  writer.Write<uint32_t>(state.above_a5_size);
+  writer.Write<uint32_t>(state.below_a5_size);
+}
+
+absl::Status RestoreMemoryMap(core::SnapshotReader& reader) {
+  MemoryMapState& state = State();
+  RETURN_IF_ERROR(reader.ReadBytes(kSystemMemoryRaw, SystemMemorySize()));
+  RETURN_IF_ERROR(reader.ReadBytes(
+      state.initialized.data(), state.initialized.size() * sizeof(uint64_t)));
+  auto above_a5 = TRY(reader.Read<uint32_t>());
+  auto below_a5 = TRY(reader.Read<uint32_t>());
+  return SetA5WorldBounds(above_a5, below_a5);
+}
+
 void CheckReadAccess(uint32_t address) {
+  MemoryMapState& state = State();
   auto within_region = [&](size_t lower, size_t upper) {
     return address >= lower && address < upper;
   };
 
-  for (const auto& entry : log_read_regions) {
+  for (const auto& entry : state.log_read_regions) {
     if (within_region(entry.start, entry.end)) {
       if (ShouldLogAccess(entry, address))
         LOG(FATAL) << "Read within protected region \"" << entry.name
@@ -169,7 +374,7 @@ void CheckReadAccess(uint32_t address) {
 
   // System Heap
   if (within_region(kSystemHeapStart, kSystemHeapEnd)) {
-    if (kHasInitializedMemory[address])
+    if (TestBit(state.initialized, address))
       return;
 
     LOG(WARNING) << "Read system heap: 0x" << std::hex << address;
@@ -177,45 +382,47 @@ void CheckReadAccess(uint32_t address) {
   }
 
   // Application Heap
-  if (within_region(kHeapStart, kHeapEnd)) {
+  if (within_region(kHeapStart, HeapEnd())) {
     return;
   }
 
   // Stack
-  if (within_region(kStackEnd, kStackStart)) {
+  if (within_region(StackEnd(), StackStart())) {
     LOG_IF(INFO, verbose_logging) << "Read Stack: 0x" << std::hex << address
-                                  << " (0x" << (kStackStart - address) << ")";
+                                  << " (0x" << (StackStart() - address) << ")";
     return;
   }
 
   // A5 World
-  if (address == a5_world) {
+  if (address == state.a5_world) {
     LOG(WARNING) << "Read A5 (Pointer to QuickDraw): 0x" << std::hex << address;
     return;
   }
-  if (within_region(a5_world - below_a5_size, a5_world)) {
-    LOG_IF(INFO, verbose_logging) << "Read below A5: 0x" << std::hex << address
-                                  << " (-0x" << (a5_world - address) << ")";
-    if (kHasInitializedMemory[address]) {
+  if (within_region(state.a5_world - state.below_a5_size, state.a5_world)) {
+    LOG_IF(INFO, verbose_logging)
+        << "Read below A5: 0x" << std::hex << address << " (-0x"
+        << (state.a5_world - address) << ")";
+    if (TestBit(state.initialized, address)) {
       return;
     }
     LOG(WARNING) << "Read un-initialized below A5: 0x" << std::hex << address
-                 << " (-0x" << (a5_world - address) << ")";
+                 << " (-0x" << (state.a5_world - address) << ")";
     return;
   }
-  if (within_region(a5_world, a5_world + above_a5_size)) {
-    if (address < a5_world + 32) {
+  if (within_region(state.a5_world, state.a5_world + state.above_a5_size)) {
+    if (address < state.a5_world + 32) {
       LOG(WARNING) << "Read unimplemented application parameters: 0x"
-                   << std::hex << address << " (0x" << (address - a5_world)
-                   << ")";
+                   << std::hex << address << " (0x"
+                   << (address - state.a5_world) << ")";
       return;
     }
-    LOG_IF(INFO, verbose_logging) << "Read above A5: 0x" << std::hex << address
-                                  << " (+0x" << (address - a5_world) << ")";
+    LOG_IF(INFO, verbose_logging)
+        << "Read above A5: 0x" << std::hex << address << " (+0x"
+        << (address - state.a5_world) << ")";
     return;
   }
 
-  if (address >= kLastEmulatedSubroutineAddress) {
+  if (address >= LastEmulatedSubroutineAddress()) {
     return;
   }
 
@@ -223,11 +430,12 @@ void CheckReadAccess(uint32_t address) {
 }
 
 void CheckWriteAccess(uint32_t address, uint32_t value) {
+  MemoryMapState& state = State();
   auto within_region = [&](size_t lower, size_t upper) {
     return address >= lower && address < upper;
   };
 
-  for (const auto& entry : log_write_regions) {
+  for (const auto& entry : state.log_write_regions) {
     if (within_region(entry.start, entry.end) &&
         ShouldLogAccess(entry, address)) {
       LOG(FATAL) << "Write within protected region \"" << entry.name << "\": 0x"
@@ -266,54 +474,54 @@ void CheckWriteAccess(uint32_t address, uint32_t value) {
 
   // System Heap
   if (within_region(kSystemHeapStart, kSystemHeapEnd)) {
-    if (kHasInitializedMemory[address])
+    if (TestBit(state.initialized, address))
       return;
 
     LOG(WARNING) << "Write to system heap: 0x" << std::hex << address << " = 0x"
                  << value;
-    kHasInitializedMemory[address] = true;
+    SetBits(state.initialized, address, address + 1);
     return;
   }
 
   // Application Heap
-  if (within_region(kHeapStart, kHeapEnd)) {
+  if (within_region(kHeapStart, HeapEnd())) {
     return;
   }
 
   // Stack
-  if (within_region(kStackEnd, kStackStart)) {
+  if (within_region(StackEnd(), StackStart())) {
     LOG_IF(INFO, verbose_logging)
         << "Write Stack: 0x" << std::hex << address << " (0x"
-        << (kStackStart - address) << ") = 0x" << value;
+        << (StackStart() - address) << ") = 0x" << value;
     return;
   }
 
   // A5 World
-  if (address == a5_world) {
+  if (address == state.a5_world) {
     LOG(WARNING) << "Write A5 (Pointer to QuickDraw): 0x" << std::hex << address
                  << " = 0x" << value;
     return;
   }
-  if (within_region(a5_world - below_a5_size, a5_world)) {
+  if (within_region(state.a5_world - state.below_a5_size, state.a5_world)) {
     LOG_IF(INFO, verbose_logging)
         << "Write below A5 (app globals): 0x" << std::hex << address << " (-0x"
-        << (a5_world - address) << ") = 0x" << value;
-    kHasInitializedMemory[address] = true;
+        << (state.a5_world - address) << ") = 0x" << value;
+    SetBits(state.initialized, address, address + 1);
     return;
   }
-  if (within_region(a5_world, a5_world + above_a5_size)) {
-    if (address < a5_world + 32) {
+  if (within_region(state.a5_world, state.a5_world + state.above_a5_size)) {
+    if (address < state.a5_world + 32) {
       LOG(WARNING) << "Write unimplemented application parameters: 0x"
-                   << std::hex << address << " (0x" << (address - a5_world)
-                   << ") = 0x" << value;
+                   << std::hex << address << " (0x"
+                   << (address - state.a5_world) << ") = 0x" << value;
       return;
     }
     LOG(WARNING) << "Write above A5: 0x" << std::hex << address << " (+0x"
-                 << (address - a5_world) << ") = 0x" << value;
+                 << (address - state.a5_world) << ") = 0x" << value;
     return;
   }
 
-  if (address > kLastEmulatedSubroutineAddress) {
+  if (address > LastEmulatedSubroutineAddress()) {
     LOG(FATAL) << "Writing to address reserved for native "
                   "function calls: 0x"
                << std::hex << address << " = 0x" << value;
@@ -325,11 +533,13 @@ void CheckWriteAccess(uint32_t address, uint32_t value) {
 }
 
 std::string MemoryMapToStr() {
+  MemoryMapState& state = State();
   std::stringstream ss;
   ss << std::hex;
-  ss << "Heap: [0x" << kHeapStart << ", 0x" << kHeapEnd << "] " << "Stack: [0x"
-     << kStackEnd << ", 0x" << kStackStart << "] " << "A5 World: 0x" << a5_world
-     << " (+" << above_a5_size << ", -" << below_a5_size << ")";
+  ss << "Heap: [0x" << kHeapStart << ", 0x" << HeapEnd() << "] " << "Stack: [0x"
+     << StackEnd() << ", 0x" << StackStart() << "] " << "A5 World: 0x"
+     << state.a5_world << " (+" << state.above_a5_size << ", -"
+     << state.below_a5_size << ")";
   return ss.str();
 }
 
@@ -352,39 +562,44 @@ void LogRegionAccess(size_t offset,
                      bool on_write,
                      const std::string& region_name,
                      std::vector<Field> whitelist_fields) {
+  MemoryMapState& state = State();
   auto region_entry = RegionEntry{.name = region_name,
                                   .start = offset,
                                   .end = offset + length,
                                   .whitelist = std::move(whitelist_fields)};
 
   if (on_read) {
-    MaybeRemoveOverlappingEntry(log_read_regions, offset, length);
-    log_read_regions.push_back(region_entry);
+    MaybeRemoveOverlappingEntry(state.log_read_regions, offset, length);
+    state.log_read_regions.push_back(region_entry);
   }
   if (on_write) {
-    MaybeRemoveOverlappingEntry(log_write_regions, offset, length);
-    log_write_regions.push_back(region_entry);
+    MaybeRemoveOverlappingEntry(state.log_write_regions, offset, length);
+    state.log_write_regions.push_back(region_entry);
   }
 }
 
 namespace debug {
 
 void LogA5World() {
+  MemoryMapState& state = State();
   LOG(INFO) << "A5 World:\n"
-            << MUST(kSystemMemory.Create("A5 World", a5_world - below_a5_size,
-                                         below_a5_size + above_a5_size));
+            << MUST(kSystemMemory.Create(
+                   "A5 World", state.a5_world - state.below_a5_size,
+                   state.below_a5_size + state.above_a5_size));
 }
 
 void LogAppGlobals() {
+  MemoryMapState& state = State();
   LOG(INFO) << "Application Globals:\n"
-            << MUST(kSystemMemory.Create("Globals", a5_world - below_a5_size,
-                                         below_a5_size));
+            << MUST(kSystemMemory.Create(
+                   "Globals", state.a5_world - state.below_a5_size,
+                   state.below_a5_size));
 }
 
 void LogStack(uint32_t stack_head) {
   LOG(INFO) << "Stack:\n"
             << MUST(memory::kSystemMemory.Create("Stack", stack_head,
-                                                 kStackStart - stack_head));
+                                                 StackStart() - stack_head));
 }
 
 }  // namespace debug
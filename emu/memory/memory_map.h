@@ -5,8 +5,10 @@
 
 #include <cstdint>
 
+#include "absl/status/status.h"
 #include "core/literal_helpers.h"
 #include "core/memory_region.h"
+#include "core/snapshot.h"
 #include "gen/typegen/typegen_prelude.h"
 
 namespace cyder {
@@ -14,8 +16,59 @@ namespace memory {
 
 extern core::MemoryRegion kSystemMemory;
 
-const size_t kSystemMemorySize = 512_kb;
-const size_t kDefaultStackSize = 4_kb;
+// Returns a region over `size` bytes of system memory at `data` which publishes
+// writes to code (see emu/memory/code_pages.h). Each machine's memory is
+// created with this so that native writes to code need not be published.
+core::MemoryRegion CreateSystemMemoryRegion(uint8_t* data, size_t size);
+
+// The size of emulated RAM must be a power of two within these bounds.
+constexpr size_t kMinSystemMemorySize = 512_kb;
+constexpr size_t kMaxSystemMemorySize = 8_mb;
+constexpr size_t kDefaultSystemMemorySize = 512_kb;
+constexpr size_t kDefaultStackSize = 4_kb;
+
+// Sets the size of emulated RAM and of the stack which the addresses at the
+// top of the memory map (below) are derived from. Unless this is called the
+// defaults above are used. This must be called (at most once) before any
+// machine is created since each allocates memory of this size (CHECK fails).
+absl::Status ConfigureMemoryMap(size_t memory_size, size_t stack_size);
+
+// The size of memory and of the stack along with the addresses derived from
+// them (see the memory map below). Read through the accessors below.
+struct MemoryLayout {
+  size_t system_memory_size;
+  size_t stack_size;
+  size_t trap_manager_entry_address;
+  size_t trap_manager_exit_address;
+  size_t base_system_trap_address;
+  size_t base_toolbox_trap_address;
+  size_t end_function_call_address;
+  size_t vbl_interrupt_address;
+  size_t last_emulated_subroutine_address;
+  size_t stack_start;
+  size_t stack_end;
+  size_t heap_end;
+};
+
+namespace internal {
+// Only set by `ConfigureMemoryMap()`.
+extern MemoryLayout memory_layout;
+}  // namespace internal
+
+inline size_t SystemMemorySize() {
+  return internal::memory_layout.system_memory_size;
+}
+inline size_t StackSize() {
+  return internal::memory_layout.stack_size;
+}
+
+// The raw bytes backing `kSystemMemory`. This is only accessed directly by the
+// emulator's fast memory path; all other code should use `kSystemMemory`.
+// There are `kSystemMemoryGuardSize` bytes past `SystemMemorySize()` so that
+// multi-byte accesses at the top of memory never leave the buffer. Both point
+// at the memory of the active machine (see emu/machine.h).
+extern uint8_t* kSystemMemoryRaw;
+const size_t kSystemMemoryGuardSize = sizeof(uint32_t);
 
 // Defines the memory map exposed to the emulated m68k; it should
 // be noted that when there are multiple "correct" locations (depending
@@ -51,25 +104,51 @@ const size_t kDefaultStackSize = 4_kb;
 //  0x00FF End of Interrupt Vector Table
 //  [ LOW MEMORY ]
 
-const size_t kTrapManagerEntryAddress = kSystemMemorySize - sizeof(uint16_t);
-const size_t kTrapManagerExitAddress =
-    kTrapManagerEntryAddress - sizeof(uint32_t);
-
-const size_t kBaseSystemTrapAddress =
-    kTrapManagerExitAddress - (256 * sizeof(uint16_t));
-const size_t kBaseToolboxTrapAddress =
-    kBaseSystemTrapAddress - (1024 * sizeof(uint16_t));
-
-const size_t kEndFunctionCallAddress =
-    kBaseToolboxTrapAddress - sizeof(uint16_t);
-
-const size_t kLastEmulatedSubroutineAddress = kEndFunctionCallAddress;
+// The addresses below are offsets from the top of memory and are recomputed by
+// `ConfigureMemoryMap()`.
+inline size_t TrapManagerEntryAddress() {
+  return internal::memory_layout.trap_manager_entry_address;
+}
+inline size_t TrapManagerExitAddress() {
+  return internal::memory_layout.trap_manager_exit_address;
+}
+
+inline size_t BaseSystemTrapAddress() {
+  return internal::memory_layout.base_system_trap_address;
+}
+inline size_t BaseToolboxTrapAddress() {
+  return internal::memory_layout.base_toolbox_trap_address;
+}
+
+inline size_t EndFunctionCallAddress() {
+  return internal::memory_layout.end_function_call_address;
+}
+
+inline size_t VblInterruptAddress() {
+  return internal::memory_layout.vbl_interrupt_address;
+}
+
+inline size_t LastEmulatedSubroutineAddress() {
+  return internal::memory_layout.last_emulated_subroutine_address;
+}
+
+// The number of bytes from `LastEmulatedSubroutineAddress()` to the top of
+// memory (the same for any size of memory).
+constexpr size_t kStubRegionSize =
+    sizeof(uint16_t) /* TrapManager entry */ +
+    sizeof(uint32_t) /* TrapManager exit */ + 256 * sizeof(uint16_t) +
+    1024 * sizeof(uint16_t) + sizeof(uint16_t) /* End function call */ +
+    sizeof(uint16_t) /* VBL interrupt */;
 
 // A5 World
 
 // User Stack
-const size_t kStackStart = kSystemMemorySize - 32_kb;
-const size_t kStackEnd = kStackStart - kDefaultStackSize;
+inline size_t StackStart() {
+  return internal::memory_layout.stack_start;
+}
+inline size_t StackEnd() {
+  return internal::memory_layout.stack_end;
+}
 
 // System Heap
 const size_t kSystemHeapStart = 0x1C00;
@@ -77,7 +156,9 @@ const size_t kSystemHeapEnd = kSystemHeapStart + 4_kb;
 
 // Application Heap
 const size_t kHeapStart = kSystemHeapEnd;
-const size_t kHeapEnd = kStackEnd;
+inline size_t HeapEnd() {
+  return internal::memory_layout.heap_end;
+}
 
 // Toolbox A-Trap Table
 const size_t kToolboxTrapTableEnd = 0x1C00;
@@ -110,6 +191,11 @@ void InstallMemoryWatcher();
 absl::Status SetA5WorldBounds(uint32_t above_a5, uint32_t below_a5);
 uint32_t GetA5WorldPosition();
 
+// Saves/restores the contents of `kSystemMemory` along with the A5 world bounds
+// and which bytes have been initialized (see emu/save_state.h).
+void SaveMemoryMap(core::SnapshotWriter& writer);
+absl::Status RestoreMemoryMap(core::SnapshotReader& reader);
+
 // Returns a string representation of the memory map (for debugging).
 std::string MemoryMapToStr();
 
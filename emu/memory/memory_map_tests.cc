@@ -4,9 +4,16 @@
 #include <gmock/gmock-matchers.h>
 #include <gtest/gtest.h>
 
+#include <cstdlib>
+#include <utility>
+#include <vector>
+
 #include "absl/status/statusor.h"
 #include "core/status_helpers.h"
+#include "emu/debug/debug_manager.h"
 #include "emu/graphics/grafport_types.tdef.h"
+#include "emu/machine.h"
+#include "emu/memory/code_pages.h"
 #include "emu/memory/memory_map.h"
 
 namespace cyder {
@@ -57,5 +64,91 @@ TEST(MemoryMapTests, RestrictAccessOverlapping) {
   CheckWriteAccess(kHeapStart, 0);
 }
 
+TEST(MemoryMapTests, ReportsWritesWhenTagsAreRead) {
+  InstallMemoryWatcher();
+  DebugManager::Instance().Clear();
+
+  CHECK_OK(kSystemMemory.Write<uint32_t>(kHeapStart + 0x100, 1));
+  CHECK_OK(kSystemMemory.Write<uint32_t>(kHeapStart + 0x104, 2));
+  CHECK_OK(kSystemMemory.Write<uint16_t>(kHeapStart + 0x200, 3));
+  // Runs of initialized memory are merged across pages
+  CHECK_OK(kSystemMemory.Write<uint32_t>(kHeapStart + 0x3FE, 4));
+
+  EXPECT_THAT(DebugManager::Instance().GetMemoryTags(),
+              testing::ElementsAre(
+                  MemorySpan{kHeapStart + 0x100, kHeapStart + 0x108, ""},
+                  MemorySpan{kHeapStart + 0x200, kHeapStart + 0x202, ""},
+                  MemorySpan{kHeapStart + 0x3FE, kHeapStart + 0x402, ""}));
+}
+
+TEST(MemoryMapTests, PublishesWritesToCode) {
+  Machine machine;
+  Machine::Activation activation(machine);
+  std::vector<std::pair<uint32_t, uint32_t>> writes;
+  AddCodeWriteListener([&writes](uint32_t start, uint32_t end) {
+    writes.emplace_back(start, end);
+  });
+  MarkCodePages(kHeapStart + 0x100, kHeapStart + 0x110);
+
+  CHECK_OK(kSystemMemory.Write<uint16_t>(kHeapStart + 0x104, 0x4E75));
+  CHECK_OK(kSystemMemory.Write<uint16_t>(kHeapStart + 0x800, 0x4E75));
+
+  EXPECT_THAT(writes, testing::ElementsAre(testing::Pair(
+                          kHeapStart + 0x104, kHeapStart + 0x106)));
+}
+
+TEST(MemoryMapTests, DefaultLayout) {
+  EXPECT_EQ(SystemMemorySize(), kDefaultSystemMemorySize);
+  EXPECT_EQ(kSystemMemory.size(), kDefaultSystemMemorySize);
+  EXPECT_EQ(TrapManagerEntryAddress(), SystemMemorySize() - 2);
+  EXPECT_EQ(LastEmulatedSubroutineAddress(),
+            SystemMemorySize() - kStubRegionSize);
+  EXPECT_EQ(StackStart(), SystemMemorySize() - 32_kb);
+  EXPECT_EQ(StackEnd(), StackStart() - kDefaultStackSize);
+  EXPECT_EQ(HeapEnd(), StackEnd());
+}
+
+TEST(MemoryMapTests, ConfigureRejectsInvalidSizes) {
+  EXPECT_THAT(ConfigureMemoryMap(256_kb, kDefaultStackSize),
+              testing::Property(&absl::Status::code,
+                                absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(ConfigureMemoryMap(16_mb, kDefaultStackSize),
+              testing::Property(&absl::Status::code,
+                                absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(ConfigureMemoryMap(3_mb, kDefaultStackSize),
+              testing::Property(&absl::Status::code,
+                                absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(ConfigureMemoryMap(1_mb, /*stack_size=*/0),
+              testing::Property(&absl::Status::code,
+                                absl::StatusCode::kInvalidArgument));
+  EXPECT_THAT(ConfigureMemoryMap(1_mb, 1_mb),
+              testing::Property(&absl::Status::code,
+                                absl::StatusCode::kInvalidArgument));
+
+  // Nothing changes when the configuration is rejected
+  EXPECT_EQ(SystemMemorySize(), kDefaultSystemMemorySize);
+  EXPECT_EQ(StackSize(), kDefaultStackSize);
+}
+
+TEST(MemoryMapDeathTest, ConfigureAfterMachineIsCreated) {
+  Machine::Default();
+  EXPECT_DEATH(ConfigureMemoryMap(1_mb, kDefaultStackSize).IgnoreError(),
+               "before any machine is created");
+}
+
+TEST(MemoryMapDeathTest, A5WorldSpaceScalesWithMemory) {
+  // Memory can only be configured once per process (before any machine is
+  // created) so each size is tried in a freshly started child process.
+  GTEST_FLAG_SET(death_test_style, "threadsafe");
+  auto fits_a5_world = [](size_t memory_size) {
+    CHECK_OK(ConfigureMemoryMap(memory_size, kDefaultStackSize));
+    std::exit(SetA5WorldBounds(/*above_a5=*/16_kb, /*below_a5=*/32_kb).ok()
+                  ? 0
+                  : 1);
+  };
+  EXPECT_EXIT(fits_a5_world(2_mb), testing::ExitedWithCode(0), "");
+  EXPECT_EXIT(fits_a5_world(512_kb), testing::ExitedWithCode(1), "");
+}
+
 }  // namespace memory
 }  // namespace cyder
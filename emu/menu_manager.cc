@@ -5,6 +5,7 @@
 
 #include "absl/strings/str_join.h"
 #include "core/logging.h"
+#include "core/status_helpers.h"
 #include "emu/event_manager.h"
 #include "emu/font/font.h"
 #include "emu/graphics/graphics_helpers.h"
@@ -31,6 +32,21 @@ bool IsAppleMenu(const MenuResource& menu) {
   return menu.title == "\x14";
 }
 
+// Menus are stored in a snapshot in their emulated (resource) representation.
+template <typename Type>
+void WriteMenuType(const Type& value, core::SnapshotWriter& writer) {
+  std::string data(value.size(), '\0');
+  core::MemoryRegion region(data.data(), data.size());
+  CHECK_OK(WriteType<Type>(value, region, /*offset=*/0));
+  writer.WriteString(data);
+}
+
+template <typename Type>
+absl::StatusOr<Type> ReadMenuType(core::SnapshotReader& reader) {
+  std::string data = TRY(reader.ReadString());
+  return ReadType<Type>(core::MemoryRegion(data.data(), data.size()));
+}
+
 }  // namespace
 
 MenuManager::MenuManager(graphics::BitmapImage& screen) : screen_(screen) {}
@@ -139,4 +155,32 @@ uint32_t MenuManager::MenuSelect(const Point& start) {
   EventManager::the().OnMouseMove(start.x, start.y);
 }
 
+void MenuManager::SaveState(core::SnapshotWriter& writer) const {
+  writer.Write<uint32_t>(menus_.size());
+  for (const auto& menu : menus_) {
+    WriteMenuType(menu, writer);
+    const auto& items = menu_items_.at(menu.id);
+    writer.Write<uint32_t>(items.size());
+    for (const auto& item : items) {
+      WriteMenuType(item, writer);
+    }
+  }
+}
+
+absl::Status MenuManager::RestoreState(core::SnapshotReader& reader) {
+  menus_.clear();
+  menu_items_.clear();
+  auto menu_count = TRY(reader.Read<uint32_t>());
+  for (uint32_t i = 0; i < menu_count; ++i) {
+    auto menu = TRY(ReadMenuType<MenuResource>(reader));
+    auto item_count = TRY(reader.Read<uint32_t>());
+    std::vector<MenuItemResource> items;
+    for (uint32_t j = 0; j < item_count; ++j) {
+      items.push_back(TRY(ReadMenuType<MenuItemResource>(reader)));
+    }
+    InsertMenu(std::move(menu), std::move(items));
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace cyder
\ No newline at end of file
@@ -8,6 +8,8 @@
 #include <string>
 #include <vector>
 
+#include "absl/status/status.h"
+#include "core/snapshot.h"
 #include "emu/graphics/bitmap_image.h"
 #include "emu/menu_popup.h"
 #include "gen/typegen/generated_types.tdef.h"
@@ -25,6 +27,10 @@ class MenuManager {
 
   uint32_t MenuSelect(const Point& start);
 
+  // Saves/restores the inserted menus and their items.
+  void SaveState(core::SnapshotWriter& writer) const;
+  absl::Status RestoreState(core::SnapshotReader& reader);
+
  private:
   graphics::BitmapImage& screen_;
   std::vector<MenuResource> menus_;
@@ -26,6 +26,8 @@ namespace cyder {
 namespace rsrc {
 namespace {
 
+constexpr bool kVerboseLogging = false;
+
 absl::Status LoadFileError(absl::string_view file_path) {
   return absl::InternalError(
       absl::StrCat("Error loading: '", file_path, "': ", strerror(errno)));
@@ -69,11 +71,11 @@ absl::StatusOr<std::unique_ptr<ResourceFile>> ResourceFile::Load(
 absl::StatusOr<std::unique_ptr<ResourceFile>> ResourceFile::LoadRsrcFork(
     const core::MemoryRegion& region) {
   auto file_header = TRY(ReadType<ResourceHeader>(region));
-  LOG(INFO) << "ResourceHeader: " << file_header;
+  LOG_IF(INFO, kVerboseLogging) << "ResourceHeader: " << file_header;
 
   auto map_header =
       TRY(ReadType<ResourceMapHeader>(region, file_header.map_offset));
-  LOG(INFO) << "ResourceMapHeader: " << map_header;
+  LOG_IF(INFO, kVerboseLogging) << "ResourceMapHeader: " << map_header;
 
   core::MemoryRegion data_region = TRY(
       region.Create("Data", file_header.data_offset, file_header.data_length));
@@ -4,6 +4,8 @@
 #include "emu/rsrc/resource_manager.h"
 
 #include "absl/strings/str_cat.h"
+#include "core/status_helpers.h"
+#include "emu/machine.h"
 #include "emu/memory/memory_map.h"
 #include "gen/global_names.h"
 #include "gen/typegen/typegen_prelude.h"
@@ -17,8 +19,6 @@ std::string GetUniqueId(ResType theType, ResId theId) {
   return absl::StrCat("Resource[", OSTypeName(theType), ":", theId, "]");
 }
 
-static ResourceManager* s_instance;
-
 }  // namespace
 
 ResourceManager::ResourceManager(memory::MemoryManager& memory_manager,
@@ -26,27 +26,26 @@ ResourceManager::ResourceManager(memory::MemoryManager& memory_manager,
                                  rsrc::ResourceFile* system_file)
     : memory_manager_(memory_manager),
       resource_file_(resource_file),
-      system_file_(system_file) {
-  s_instance = this;
+      system_file_(system_file),
+      machine_(Machine::Current()) {
+  machine_.Register(this);
+}
+
+ResourceManager::~ResourceManager() {
+  machine_.Unregister(this);
 }
 
 // static
 ResourceManager& ResourceManager::the() {
-  return *s_instance;
+  return Machine::Current().GetRegistered<ResourceManager>();
 }
 
 const Resource* ResourceManager::GetSegmentZero() const {
   return resource_file_.FindByTypeAndId('CODE', 0);
 }
 
-Handle ResourceManager::GetResource(ResType theType, ResId theId) {
-  const std::string unique_id = GetUniqueId(theType, theId);
-
-  const auto& cached_handle_pair = resource_to_handle_.find(unique_id);
-  if (cached_handle_pair != resource_to_handle_.cend()) {
-    return cached_handle_pair->second;
-  }
-
+const Resource* ResourceManager::FindResource(ResType theType,
+                                              ResId theId) const {
   const Resource* resource = resource_file_.FindByTypeAndId(theType, theId);
 
   // If a System file was provided at start-up fallback to looking there.
@@ -54,17 +53,43 @@ Handle ResourceManager::GetResource(ResType theType, ResId theId) {
   if (resource == nullptr && system_file_) {
     resource = system_file_->FindByTypeAndId(theType, theId);
   }
+  return resource;
+}
 
-  // FIXME: Set ResError in D0 and call ResErrorProc
-  // http://0.0.0.0:8000/docs/mac/MoreToolbox/MoreToolbox-35.html#MARKER-9-220
-  CHECK(resource) << "Resource not found: " << unique_id;
+Handle ResourceManager::GetHandleFor(const Resource& resource,
+                                     ResType theType) {
+  const std::string unique_id = GetUniqueId(theType, resource.GetId());
+
+  const auto& cached_handle_pair = resource_to_handle_.find(unique_id);
+  if (cached_handle_pair != resource_to_handle_.cend()) {
+    LoadResource(cached_handle_pair->second);
+    return cached_handle_pair->second;
+  }
 
   Handle handle =
-      memory_manager_.AllocateHandleForRegion(resource->GetData(), unique_id);
+      memory_manager_.AllocateHandleForRegion(resource.GetData(), unique_id);
   resource_to_handle_[unique_id] = handle;
+  loaded_resources_[handle] = {theType, &resource};
   return handle;
 }
 
+Handle ResourceManager::GetResource(ResType theType, ResId theId) {
+  const std::string unique_id = GetUniqueId(theType, theId);
+
+  const auto& cached_handle_pair = resource_to_handle_.find(unique_id);
+  if (cached_handle_pair != resource_to_handle_.cend()) {
+    LoadResource(cached_handle_pair->second);
+    return cached_handle_pair->second;
+  }
+
+  const Resource* resource = FindResource(theType, theId);
+
+  // FIXME: Set ResError in D0 and call ResErrorProc
+  // http://0.0.0.0:8000/docs/mac/MoreToolbox/MoreToolbox-35.html#MARKER-9-220
+  CHECK(resource) << "Resource not found: " << unique_id;
+  return GetHandleFor(*resource, theType);
+}
+
 Handle ResourceManager::GetResourseByName(ResType theType,
                                           absl::string_view theName) {
   const Resource* const resource =
@@ -77,19 +102,30 @@ Handle ResourceManager::GetResourseByName(ResType theType,
     CHECK(status.ok()) << std::move(status).message();
     return 0;
   }
+  return GetHandleFor(*resource, theType);
+}
 
-  const std::string unique_id = GetUniqueId(theType, resource->GetId());
-
-  const auto& cached_handle_pair = resource_to_handle_.find(unique_id);
-  if (cached_handle_pair != resource_to_handle_.cend()) {
-    LOG(INFO) << "Returning cached handle for " << unique_id;
-    return cached_handle_pair->second;
+void ResourceManager::LoadResource(Handle handle) {
+  const auto& entry = loaded_resources_.find(handle);
+  if (entry == loaded_resources_.cend() ||
+      !memory_manager_.IsHandlePurged(handle)) {
+    return;
   }
 
-  Handle handle =
-      memory_manager_.AllocateHandleForRegion(resource->GetData(), unique_id);
-  resource_to_handle_[unique_id] = handle;
-  return handle;
+  const core::MemoryRegion& data = entry->second.resource->GetData();
+  CHECK(memory_manager_.SetHandleSize(handle, data.size()))
+      << "Out of memory reloading " << memory_manager_.GetTag(handle);
+  CHECK_OK(memory_manager_.GetRegionForHandle(handle).WriteRaw(
+      data.raw_ptr(), /*offset=*/0, data.size()));
+}
+
+void ResourceManager::ForgetResource(Handle handle) {
+  const auto& entry = loaded_resources_.find(handle);
+  if (entry == loaded_resources_.cend())
+    return;
+  resource_to_handle_.erase(
+      GetUniqueId(entry->second.type, entry->second.resource->GetId()));
+  loaded_resources_.erase(entry);
 }
 
 std::vector<std::pair<ResId, std::string>> ResourceManager::GetIdsForType(
@@ -110,4 +146,32 @@ std::vector<std::pair<ResId, std::string>> ResourceManager::GetIdsForType(
   return id_and_names;
 }
 
-}  // namespace cyder
\ No newline at end of file
+void ResourceManager::SaveState(core::SnapshotWriter& writer) const {
+  writer.Write<uint32_t>(loaded_resources_.size());
+  for (const auto& [handle, loaded] : loaded_resources_) {
+    writer.Write<ResType>(loaded.type);
+    writer.Write<ResId>(loaded.resource->GetId());
+    writer.Write<uint32_t>(handle);
+  }
+}
+
+absl::Status ResourceManager::RestoreState(core::SnapshotReader& reader) {
+  resource_to_handle_.clear();
+  loaded_resources_.clear();
+  auto count = TRY(reader.Read<uint32_t>());
+  for (uint32_t i = 0; i < count; ++i) {
+    auto type = TRY(reader.Read<ResType>());
+    auto id = TRY(reader.Read<ResId>());
+    auto handle = TRY(reader.Read<uint32_t>());
+    const Resource* resource = FindResource(type, id);
+    if (resource == nullptr) {
+      return absl::NotFoundError(
+          absl::StrCat(GetUniqueId(type, id), " is not in the resource file"));
+    }
+    resource_to_handle_[GetUniqueId(type, id)] = handle;
+    loaded_resources_[handle] = {type, resource};
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace cyder
@@ -9,6 +9,8 @@
 #include <vector>
 
 #include "absl/strings/string_view.h"
+#include "core/snapshot.h"
+#include "emu/machine.h"
 #include "emu/memory/memory_manager.h"
 #include "emu/rsrc/resource.h"
 #include "emu/rsrc/resource_file.h"
@@ -22,15 +24,27 @@ class ResourceManager {
   ResourceManager(memory::MemoryManager&,
                   rsrc::ResourceFile&,
                   rsrc::ResourceFile*);
+  ~ResourceManager();
 
   static ResourceManager& the();
 
   const rsrc::Resource* GetSegmentZero() const;
 
+  // Returns the handle of the resource loading it on first use (or reloading
+  // it if the handle has since been purged).
   Handle GetResource(ResType, ResId);
   Handle GetResourseByName(ResType, absl::string_view);
+  // Reads the resource back into `handle` if it has been purged.
+  void LoadResource(Handle handle);
+  // Forgets `handle` if it holds a resource (i.e. before it is disposed of)
+  // so the resource is read into a new handle the next time it is requested.
+  void ForgetResource(Handle handle);
   std::vector<std::pair<ResId, std::string>> GetIdsForType(ResType);
 
+  // Saves/restores the cache of loaded resource handles.
+  void SaveState(core::SnapshotWriter& writer) const;
+  absl::Status RestoreState(core::SnapshotReader& reader);
+
   template <typename T>
   absl::StatusOr<T> GetResource(ResType theType, ResId theId) {
     Handle handle = GetResource(theType, theId);
@@ -39,11 +53,24 @@ class ResourceManager {
   }
 
  private:
+  // Finds the resource in the application falling back to the System file.
+  const rsrc::Resource* FindResource(ResType, ResId) const;
+  Handle GetHandleFor(const rsrc::Resource& resource, ResType theType);
+
   memory::MemoryManager& memory_manager_;
   rsrc::ResourceFile& resource_file_;
   rsrc::ResourceFile* system_file_;
 
   std::map<std::string, uint32_t> resource_to_handle_;
+  // The resource read into each cached handle (to reload it once purged).
+  struct LoadedResource {
+    ResType type;
+    const rsrc::Resource* resource;
+  };
+  std::map<Handle, LoadedResource> loaded_resources_;
+
+  // The machine this is registered with (until it is destroyed).
+  Machine& machine_;
 };
 
 }  // namespace cyder
\ No newline at end of file
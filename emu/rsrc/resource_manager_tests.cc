@@ -0,0 +1,99 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/rsrc/resource_manager.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "core/memory_region.h"
+#include "core/status_helpers.h"
+#include "emu/machine.h"
+#include "emu/memory/memory_manager.h"
+#include "emu/memory/memory_map.h"
+#include "emu/rsrc/resource_file.h"
+
+namespace cyder {
+namespace {
+
+// A raw resource fork with a variety of resources (see //examples).
+constexpr char kResourceFork[] = CYDER_EXAMPLES_DIR "/Window.rsrc";
+
+class ResourceManagerTests : public ::testing::Test {
+ protected:
+  ResourceManagerTests()
+      : activation_(machine_),
+        data_(ReadFile(kResourceFork)),
+        file_(MUST(rsrc::ResourceFile::LoadRsrcFork(
+            core::MemoryRegion(data_.data(), data_.size())))),
+        resource_manager_(memory_manager_, *file_, /*system_file=*/nullptr) {
+    const auto& group = file_->groups().front();
+    type_ = group.GetType();
+    resource_ = &group.GetResources().front();
+  }
+
+  static std::vector<char> ReadFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    CHECK(file.is_open()) << "Unable to open: " << path;
+    return std::vector<char>(std::istreambuf_iterator<char>(file), {});
+  }
+
+  // Whether `handle` holds the contents of `resource_`.
+  bool HoldsResource(Handle handle) {
+    const core::MemoryRegion& data = resource_->GetData();
+    if (memory_manager_.GetHandleSize(handle) != data.size())
+      return false;
+    return memcmp(memory::kSystemMemory.raw_ptr() +
+                      memory_manager_.GetPtrForHandle(handle),
+                  data.raw_ptr(), data.size()) == 0;
+  }
+
+  Machine machine_;
+  Machine::Activation activation_;
+  std::vector<char> data_;
+  std::unique_ptr<rsrc::ResourceFile> file_;
+  memory::MemoryManager memory_manager_;
+  ResourceManager resource_manager_;
+
+  ResType type_;
+  const rsrc::Resource* resource_;
+};
+
+TEST_F(ResourceManagerTests, ReloadsPurgedResources) {
+  Handle handle = resource_manager_.GetResource(type_, resource_->GetId());
+  ASSERT_TRUE(HoldsResource(handle));
+
+  memory_manager_.SetHandlePurgeable(handle, true);
+  memory_manager_.Purge();
+  ASSERT_TRUE(memory_manager_.IsHandlePurged(handle));
+
+  resource_manager_.LoadResource(handle);
+  EXPECT_TRUE(HoldsResource(handle));
+
+  memory_manager_.Purge();
+  EXPECT_EQ(resource_manager_.GetResource(type_, resource_->GetId()), handle);
+  EXPECT_TRUE(HoldsResource(handle));
+}
+
+TEST_F(ResourceManagerTests, DisposedResourcesAreNotReturned) {
+  Handle handle = resource_manager_.GetResource(type_, resource_->GetId());
+
+  // i.e. `DisposeHandle()` after which the master pointer is reused
+  resource_manager_.ForgetResource(handle);
+  EXPECT_TRUE(memory_manager_.Deallocate(handle));
+  Handle other = memory_manager_.AllocateHandle(4, "NewHandle");
+  ASSERT_EQ(other, handle);
+
+  Handle reloaded = resource_manager_.GetResource(type_, resource_->GetId());
+  EXPECT_NE(reloaded, other);
+  EXPECT_TRUE(HoldsResource(reloaded));
+  EXPECT_EQ(memory_manager_.GetHandleSize(other), 4u);
+}
+
+}  // namespace
+}  // namespace cyder
@@ -0,0 +1,90 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/run_report.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "core/logging.h"
+#include "emu/emulator.h"
+#include "emu/graphics/graphics_helpers.h"
+#include "emu/memory/memory_manager.h"
+#include "emu/scheduler.h"
+#include "emu/trap/trap_stats.h"
+#include "gen/trap_names.h"
+
+namespace cyder {
+
+uint64_t HashScreen(const graphics::BitmapImage& screen) {
+  constexpr uint64_t kFnvOffsetBasis = 0xcbf29ce484222325;
+  constexpr uint64_t kFnvPrime = 0x100000001b3;
+
+  const size_t size = PixelWidthToBytes(screen.width()) * screen.height();
+  uint64_t hash = kFnvOffsetBasis;
+  for (size_t i = 0; i < size; ++i) {
+    hash = (hash ^ screen.bits()[i]) * kFnvPrime;
+  }
+  return hash;
+}
+
+std::string RunReportToJson(const graphics::BitmapImage& screen) {
+  const Scheduler& scheduler = Scheduler::Instance();
+  const trap::TrapStats& trap_stats = trap::TrapStats::Instance();
+  const memory::MemoryManager& memory_manager = memory::MemoryManager::the();
+
+  std::string json = absl::StrCat(
+      "{\"instructions\": ",
+      kHasInstructionHook
+          ? absl::StrCat(Emulator::Instance().instructions_run())
+          : "null",
+      ", \"cycles\": ", scheduler.total_cycles(),
+      ", \"ticks\": ", scheduler.NowTicks(),
+      ", \"wall_time_ms\": ", absl::ToInt64Milliseconds(scheduler.Uptime()),
+      ", \"heap_high_water\": ", memory_manager.heap_high_water(),
+      ", \"screen_hash\": \"",
+      absl::StrFormat("%016x", HashScreen(screen)),
+      "\", \"traps\": ", trap_stats.total(), ", \"trap_counts\": {");
+  bool is_first = true;
+  trap_stats.ForEachTrap([&](uint16_t trap_op,
+                             const trap::TrapStats::Counters& counters) {
+    // Traps only reached by chaining from a patch are timed but not entered
+    if (counters.calls == 0)
+      return;
+    const char* name = GetTrapName(trap_op);
+    absl::StrAppend(&json, is_first ? "" : ", ", "\"",
+                    name ? name : absl::StrFormat("0x%04X", trap_op),
+                    "\": ", counters.calls);
+    is_first = false;
+  });
+  absl::StrAppend(&json, "}}");
+  return json;
+}
+
+absl::Status WriteRunReport(const std::string& path,
+                            const graphics::BitmapImage& screen) {
+  std::ofstream file(path, std::ios::trunc);
+  if (!(file << RunReportToJson(screen) << "\n")) {
+    return absl::InternalError(
+        absl::StrCat("Error writing: '", path, "': ", strerror(errno)));
+  }
+  return absl::OkStatus();
+}
+
+void SaveRunAndExit(const graphics::BitmapImage& screen,
+                    const std::string& screenshot_path,
+                    const std::string& report_path) {
+  screen.SaveBitmap(screenshot_path);
+  LOG(INFO) << "Saved screenshot to: " << screenshot_path;
+  if (!report_path.empty()) {
+    CHECK_OK(WriteRunReport(report_path, screen));
+    LOG(INFO) << "Saved report to: " << report_path;
+  }
+  exit(0);
+}
+
+}  // namespace cyder
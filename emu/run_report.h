@@ -0,0 +1,37 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "absl/status/status.h"
+#include "emu/graphics/bitmap_image.h"
+
+namespace cyder {
+
+// Returns a FNV-1a hash of the pixels of `screen` (to compare final frames
+// across runs without keeping every screenshot).
+uint64_t HashScreen(const graphics::BitmapImage& screen);
+
+// Summarizes the run of the active machine as a JSON object:
+//   {"instructions": N, "cycles": N, "ticks": N, "wall_time_ms": N,
+//    "heap_high_water": N, "screen_hash": "<hex>", "traps": N,
+//    "trap_counts": {"<name>": N, ...}}
+// `instructions` is null when Musashi is built without the instruction hook
+// since only those run from cached blocks would be counted (see
+// `kHasInstructionHook`).
+std::string RunReportToJson(const graphics::BitmapImage& screen);
+
+// Writes `RunReportToJson()` to the file at `path` (see `--report_file`).
+absl::Status WriteRunReport(const std::string& path,
+                            const graphics::BitmapImage& screen);
+
+// Saves `screen` to `screenshot_path` and the run report to `report_path` (if
+// not empty) then exits (see `--exit_on_idle` and `--exit_after_ticks`).
+[[noreturn]] void SaveRunAndExit(const graphics::BitmapImage& screen,
+                                 const std::string& screenshot_path,
+                                 const std::string& report_path);
+
+}  // namespace cyder
@@ -0,0 +1,55 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/run_report.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include "absl/strings/str_cat.h"
+#include "emu/graphics/graphics_helpers.h"
+#include "emu/memory/memory_manager.h"
+#include "emu/trap/trap_stats.h"
+
+namespace cyder {
+namespace {
+
+using ::testing::HasSubstr;
+
+TEST(RunReportTests, HashesScreenPixels) {
+  graphics::BitmapImage screen(/*width=*/16, /*height=*/2);
+  const uint64_t blank = HashScreen(screen);
+  EXPECT_EQ(HashScreen(screen), blank);
+
+  constexpr uint8_t kSetPattern[8] = {0xFF, 0xFF, 0xFF, 0xFF,
+                                      0xFF, 0xFF, 0xFF, 0xFF};
+  screen.FillRect(NewRect(0, 0, 1, 1), kSetPattern);
+  EXPECT_NE(HashScreen(screen), blank);
+}
+
+TEST(RunReportTests, CountsTraps) {
+  memory::MemoryManager memory_manager;
+  // GetNextEvent
+  trap::TrapStats::Instance().RecordTrap(0xA970, /*total_cycles=*/0);
+  trap::TrapStats::Instance().RecordTrap(0xA970, /*total_cycles=*/0);
+
+  graphics::BitmapImage screen(/*width=*/8, /*height=*/1);
+  std::string json = RunReportToJson(screen);
+  EXPECT_THAT(json, HasSubstr("\"traps\": 2"));
+  EXPECT_THAT(json, HasSubstr("\"trap_counts\": {\"GetNextEvent\": 2}"));
+}
+
+TEST(RunReportTests, ReportsHeapHighWater) {
+  memory::MemoryManager memory_manager;
+  memory_manager.Allocate(128);
+
+  graphics::BitmapImage screen(/*width=*/8, /*height=*/1);
+  EXPECT_THAT(RunReportToJson(screen),
+              HasSubstr(absl::StrCat(
+                  "\"heap_high_water\": ",
+                  memory::MemoryManager::kHeapHandleOffset +
+                      memory::MemoryManager::kBlockHeaderSize + 128)));
+}
+
+}  // namespace
+}  // namespace cyder
@@ -0,0 +1,91 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/save_state.h"
+
+#include <cstdint>
+
+#include "absl/strings/str_cat.h"
+#include "core/logging.h"
+#include "core/snapshot.h"
+#include "core/status_helpers.h"
+#include "emu/block_cache.h"
+#include "emu/emulator.h"
+#include "emu/memory/memory_map.h"
+#include "emu/scheduler.h"
+#include "emu/vertical_retrace.h"
+
+namespace cyder {
+namespace {
+
+constexpr uint32_t kSaveStateMagic = 'CYSS';
+// Increment whenever the layout of a snapshot changes.
+constexpr uint32_t kSaveStateVersion = 6;
+
+}  // namespace
+
+absl::Status SaveState(const std::string& path,
+                       const SaveStateComponents& components) {
+  core::SnapshotWriter writer;
+  writer.Write<uint32_t>(kSaveStateMagic);
+  writer.Write<uint32_t>(kSaveStateVersion);
+  writer.Write<uint32_t>(memory::SystemMemorySize());
+
+  memory::SaveMemoryMap(writer);
+  Emulator::Instance().SaveState(writer);
+  components.memory_manager.SaveState(writer);
+  components.resource_manager.SaveState(writer);
+  components.trap_manager.SaveState(writer);
+  components.window_manager.SaveState(writer);
+  components.menu_manager.SaveState(writer);
+  Scheduler::Instance().SaveState(writer);
+  VerticalRetraceManager::Instance().SaveState(writer);
+  BlockCache::Instance().SaveState(writer);
+
+  RETURN_IF_ERROR(writer.SaveToFile(path));
+  LOG(INFO) << "Saved state (" << writer.data().size() << " bytes) to: "
+            << path;
+  return absl::OkStatus();
+}
+
+absl::Status RestoreState(const std::string& path,
+                          const SaveStateComponents& components) {
+  auto reader = TRY(core::SnapshotReader::LoadFromFile(path));
+  if (TRY(reader.Read<uint32_t>()) != kSaveStateMagic) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("'", path, "' is not a save-state"));
+  }
+  auto version = TRY(reader.Read<uint32_t>());
+  if (version != kSaveStateVersion) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("Save-state version ", version,
+                     " is not supported (expected ", kSaveStateVersion, ")"));
+  }
+  auto memory_size = TRY(reader.Read<uint32_t>());
+  if (memory_size != memory::SystemMemorySize()) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("Save-state has ", memory_size,
+                     " bytes of memory but expected ",
+                     memory::SystemMemorySize()));
+  }
+
+  RETURN_IF_ERROR(memory::RestoreMemoryMap(reader));
+  RETURN_IF_ERROR(Emulator::Instance().RestoreState(reader));
+  RETURN_IF_ERROR(components.memory_manager.RestoreState(reader));
+  RETURN_IF_ERROR(components.resource_manager.RestoreState(reader));
+  RETURN_IF_ERROR(components.trap_manager.RestoreState(reader));
+  RETURN_IF_ERROR(components.window_manager.RestoreState(reader));
+  RETURN_IF_ERROR(components.menu_manager.RestoreState(reader));
+  RETURN_IF_ERROR(Scheduler::Instance().RestoreState(reader));
+  RETURN_IF_ERROR(VerticalRetraceManager::Instance().RestoreState(reader));
+  RETURN_IF_ERROR(BlockCache::Instance().RestoreState(reader));
+
+  if (!reader.at_end()) {
+    return absl::FailedPreconditionError(
+        absl::StrCat("Unexpected data at the end of '", path, "'"));
+  }
+  LOG(INFO) << "Restored state from: " << path;
+  return absl::OkStatus();
+}
+
+}  // namespace cyder
@@ -0,0 +1,38 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#pragma once
+
+#include <string>
+
+#include "absl/status/status.h"
+#include "emu/memory/memory_manager.h"
+#include "emu/menu_manager.h"
+#include "emu/rsrc/resource_manager.h"
+#include "emu/trap/trap_manager.h"
+#include "emu/window_manager.h"
+
+namespace cyder {
+
+// The native components with state which must be saved alongside emulated
+// memory and the CPU (singletons are saved implicitly).
+struct SaveStateComponents {
+  memory::MemoryManager& memory_manager;
+  ResourceManager& resource_manager;
+  trap::TrapManager& trap_manager;
+  WindowManager& window_manager;
+  MenuManager& menu_manager;
+};
+
+// Saves a snapshot of the emulator to the file at `path`. This must be called
+// between calls to `Emulator::Run()` (no native function can be in progress).
+absl::Status SaveState(const std::string& path,
+                       const SaveStateComponents& components);
+
+// Restores the snapshot at `path` which must have been saved by the same build
+// running the same application (so the native setup done before restoring
+// matches that of the saved run).
+absl::Status RestoreState(const std::string& path,
+                          const SaveStateComponents& components);
+
+}  // namespace cyder
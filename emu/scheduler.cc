@@ -0,0 +1,110 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/scheduler.h"
+
+#include "absl/time/civil_time.h"
+#include "absl/time/clock.h"
+#include "core/logging.h"
+#include "core/status_helpers.h"
+#include "emu/machine.h"
+
+namespace cyder {
+namespace {
+
+// Short enough that the VBL interrupt is raised promptly (a tick is ~261k
+// cycles on a 15.67 MHz 68030) while keeping the per-quantum overhead low.
+constexpr int kDefaultQuantum = 16384;
+
+constexpr int64_t kTicksPerSecond = 60;
+
+// The virtual clock runs as a Macintosh IIx (68030 at 15.6672 MHz) would.
+constexpr uint64_t kCyclesPerTick = 15667200 / kTicksPerSecond;
+
+// The virtual clock always boots at the same date/time so runs are repeatable.
+absl::Time VirtualEpoch() {
+  return absl::FromCivil(absl::CivilSecond(1991, 1, 1, 0, 0, 0),
+                         absl::UTCTimeZone());
+}
+
+}  // namespace
+
+// static
+Scheduler& Scheduler::Instance() {
+  return Machine::Current().Get<Scheduler>();
+}
+
+Scheduler::Scheduler() : boot_time_(absl::Now()), quantum_(kDefaultQuantum) {}
+
+void Scheduler::SetClockMode(ClockMode mode) {
+  clock_mode_ = mode;
+}
+
+void Scheduler::SetFastForward(bool enable) {
+  CHECK(!enable || clock_mode_ == ClockMode::kVirtual)
+      << "Fast-forward requires the virtual clock";
+  fast_forward_ = enable;
+}
+
+void Scheduler::SetQuantum(int cycles) {
+  CHECK_GT(cycles, 0) << "Quantum must be at least one cycle";
+  quantum_ = cycles;
+}
+
+void Scheduler::SkipTicks(uint32_t ticks) {
+  if (clock_mode_ == ClockMode::kVirtual)
+    tick_offset_ += ticks;
+}
+
+bool Scheduler::ShouldRaiseVbl() {
+  uint32_t now = NowTicks();
+  if (now == vbl_tick_)
+    return false;
+  vbl_tick_ = now;
+  return true;
+}
+
+uint32_t Scheduler::NowTicks() const {
+  return ClockTicks() + tick_offset_;
+}
+
+int64_t Scheduler::ClockTicks() const {
+  if (clock_mode_ == ClockMode::kVirtual)
+    return total_cycles_ / kCyclesPerTick;
+  return (absl::Now() - boot_time_) * kTicksPerSecond / absl::Seconds(1);
+}
+
+absl::Duration Scheduler::TimeUntilNextTick() const {
+  if (clock_mode_ == ClockMode::kVirtual)
+    return absl::ZeroDuration();
+  const absl::Duration elapsed = absl::Now() - boot_time_;
+  const absl::Duration tick = absl::Seconds(1) / kTicksPerSecond;
+  return tick - elapsed % tick;
+}
+
+absl::Time Scheduler::Now() const {
+  if (clock_mode_ == ClockMode::kVirtual)
+    return VirtualEpoch() + absl::Seconds(NowTicks()) / kTicksPerSecond;
+  return absl::Now();
+}
+
+absl::TimeZone Scheduler::time_zone() const {
+  if (clock_mode_ == ClockMode::kVirtual)
+    return absl::UTCTimeZone();
+  return absl::LocalTimeZone();
+}
+
+void Scheduler::SaveState(core::SnapshotWriter& writer) const {
+  writer.Write<uint64_t>(total_cycles_);
+  writer.Write<uint32_t>(NowTicks());
+  writer.Write<uint32_t>(vbl_tick_);
+}
+
+absl::Status Scheduler::RestoreState(core::SnapshotReader& reader) {
+  total_cycles_ = TRY(reader.Read<uint64_t>());
+  tick_offset_ = TRY(reader.Read<uint32_t>()) - ClockTicks();
+  vbl_tick_ = TRY(reader.Read<uint32_t>());
+  return absl::OkStatus();
+}
+
+}  // namespace cyder
@@ -0,0 +1,94 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "absl/status/status.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "core/snapshot.h"
+
+namespace cyder {
+
+// Splits emulation into quanta of CPU cycles and keeps the tick clock (one tick
+// is 1/60th of a second) that drives the vertical blanking (VBL) interrupt, the
+// `Ticks` global and `TickCount()`.
+class Scheduler {
+ public:
+  enum class ClockMode {
+    // Ticks follow the host's clock.
+    kWallClock,
+    // Ticks are derived from the CPU cycles retired (and ticks skipped while
+    // idle) so that a run is reproducible regardless of host speed.
+    kVirtual,
+  };
+
+  static Scheduler& Instance();
+
+  Scheduler();
+
+  ClockMode clock_mode() const { return clock_mode_; }
+  void SetClockMode(ClockMode mode);
+
+  // Skip (rather than wait out) idle time when waiting for events. Only
+  // meaningful with the virtual clock which is advanced by the skipped time.
+  bool fast_forward() const { return fast_forward_; }
+  void SetFastForward(bool enable);
+
+  // The number of CPU cycles run between checks for a due VBL interrupt.
+  int quantum() const { return quantum_; }
+  void SetQuantum(int cycles);
+
+  // Accounts for `cycles` retired by the CPU.
+  void AddCycles(int cycles) { total_cycles_ += cycles; }
+  uint64_t total_cycles() const { return total_cycles_; }
+
+  // Advances the virtual clock by `ticks` (i.e. when idle). The wall clock
+  // advances on its own so this does nothing in `ClockMode::kWallClock`.
+  void SkipTicks(uint32_t ticks);
+
+  // Returns true (once per tick) if the VBL interrupt should be raised.
+  bool ShouldRaiseVbl();
+
+  // The number of ticks elapsed since startup.
+  uint32_t NowTicks() const;
+
+  // The host time until the next tick (when the VBL interrupt is next due).
+  // This is zero with `ClockMode::kVirtual` where ticks follow the cycles run.
+  absl::Duration TimeUntilNextTick() const;
+
+  // The host time elapsed since the scheduler was created (at startup).
+  absl::Duration Uptime() const { return absl::Now() - boot_time_; }
+
+  // The current date and time: the host's for `ClockMode::kWallClock`
+  // otherwise a fixed epoch plus `NowTicks()`.
+  absl::Time Now() const;
+  // The time zone used to convert to/from dates (UTC with the virtual clock).
+  absl::TimeZone time_zone() const;
+
+  // Saves/restores the cycles run and the tick count (which continues from the
+  // snapshot). The clock mode and quantum are configuration and are left as-is.
+  void SaveState(core::SnapshotWriter& writer) const;
+  absl::Status RestoreState(core::SnapshotReader& reader);
+
+ private:
+  // The ticks counted by the clock itself (cycles or time since startup).
+  int64_t ClockTicks() const;
+
+  const absl::Time boot_time_;
+  ClockMode clock_mode_ = ClockMode::kWallClock;
+  bool fast_forward_ = false;
+  int quantum_;
+  // Read from the UI thread to timestamp input events
+  std::atomic<uint64_t> total_cycles_{0};
+  // Added to the ticks counted by the clock (ticks skipped while idle and the
+  // ticks from before a snapshot was restored).
+  std::atomic<int64_t> tick_offset_{0};
+  // The tick at which the VBL interrupt was last raised.
+  uint32_t vbl_tick_ = 0;
+};
+
+}  // namespace cyder
@@ -0,0 +1,55 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/scheduler.h"
+
+#include <gtest/gtest.h>
+
+#include "absl/time/clock.h"
+
+namespace cyder {
+namespace {
+
+TEST(SchedulerTests, CountsCycles) {
+  Scheduler scheduler;
+  scheduler.SetQuantum(1000);
+  EXPECT_EQ(scheduler.quantum(), 1000);
+
+  scheduler.AddCycles(1000);
+  scheduler.AddCycles(24);
+  EXPECT_EQ(scheduler.total_cycles(), 1024u);
+}
+
+TEST(SchedulerTests, RaisesVblOncePerTick) {
+  Scheduler scheduler;
+  absl::SleepFor(absl::Milliseconds(50));
+
+  EXPECT_GE(scheduler.NowTicks(), 2u);
+  EXPECT_TRUE(scheduler.ShouldRaiseVbl());
+  EXPECT_FALSE(scheduler.ShouldRaiseVbl());
+}
+
+TEST(SchedulerTests, VirtualClockFollowsCycles) {
+  Scheduler scheduler;
+  scheduler.SetClockMode(Scheduler::ClockMode::kVirtual);
+  EXPECT_EQ(scheduler.NowTicks(), 0u);
+  EXPECT_FALSE(scheduler.ShouldRaiseVbl());
+
+  // One tick is 1/60th of a second at 15.6672 MHz
+  scheduler.AddCycles(261119);
+  EXPECT_EQ(scheduler.NowTicks(), 0u);
+  scheduler.AddCycles(1);
+  EXPECT_EQ(scheduler.NowTicks(), 1u);
+  EXPECT_TRUE(scheduler.ShouldRaiseVbl());
+
+  scheduler.SkipTicks(59);
+  EXPECT_EQ(scheduler.NowTicks(), 60u);
+
+  // Every virtual clock starts from the same date and time
+  Scheduler other;
+  other.SetClockMode(Scheduler::ClockMode::kVirtual);
+  EXPECT_EQ(scheduler.Now() - other.Now(), absl::Seconds(1));
+}
+
+}  // namespace
+}  // namespace cyder
@@ -6,6 +6,7 @@
 #include "absl/strings/str_cat.h"
 #include "core/logging.h"
 #include "core/memory_region.h"
+#include "emu/block_cache.h"
 #include "emu/debug/debug_manager.h"
 #include "emu/memory/memory_map.h"
 #include "emu/rsrc/resource.h"
@@ -89,11 +90,17 @@ absl::StatusOr<Ptr> SegmentLoaderImpl::Load(uint16_t segment_id) {
   const Handle segment_handle =
       resource_manager_.GetResource('CODE', segment_id);
 
+  // The jump table refers to the segment by address so it must not move
+  memory_manager_.SetHandleLocked(segment_handle, /*locked=*/true);
   const auto resource_data = memory_manager_.GetRegionForHandle(segment_handle);
   cyder::DebugManager::Instance().TagMemory(
       resource_data.base_offset(),
       resource_data.base_offset() + resource_data.size(),
       absl::StrCat("CODE", segment_id));
+  // The segment may have been loaded over code which has already been cached.
+  BlockCache::Instance().AddCodeRange(
+      resource_data.base_offset(),
+      resource_data.base_offset() + resource_data.size());
 
   const bool is_far_model = (0xFFFF == TRY(resource_data.Read<uint16_t>(0)));
   // TODO: Add support for far model headers
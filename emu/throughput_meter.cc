@@ -0,0 +1,141 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/throughput_meter.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "core/logging.h"
+#include "emu/emulator.h"
+#include "emu/machine.h"
+#include "emu/scheduler.h"
+#include "emu/trap/trap_stats.h"
+
+namespace cyder {
+
+// static
+ThroughputMeter& ThroughputMeter::Instance() {
+  return Machine::Current().Get<ThroughputMeter>();
+}
+
+void ThroughputMeter::Configure(absl::Duration log_interval,
+                                std::string stats_file) {
+  log_interval_ = log_interval;
+  stats_file_ = std::move(stats_file);
+}
+
+void ThroughputMeter::Update() {
+  const absl::Time now = absl::Now();
+  if (!samples_.empty() && now - samples_.back().time < kSamplePeriod)
+    return;
+
+  const Scheduler& scheduler = Scheduler::Instance();
+  AddSample(Sample{now, Emulator::Instance().instructions_run(),
+                   scheduler.total_cycles(),
+                   trap::TrapStats::Instance().total(), frames_,
+                   scheduler.NowTicks()});
+
+  if (log_interval_ > absl::ZeroDuration() &&
+      now - last_log_ >= log_interval_) {
+    std::stringstream line;
+    Print(line);
+    LOG(INFO) << line.str();
+    last_log_ = now;
+  }
+  if (!stats_file_.empty()) {
+    auto status = WriteStatsFile(stats_file_);
+    LOG_IF(ERROR, !status.ok()) << status;
+  }
+}
+
+void ThroughputMeter::AddSample(const Sample& sample) {
+  if (!samples_.empty()) {
+    const Sample& last = samples_.back();
+    const uint64_t ticks = sample.ticks - last.ticks;
+    const uint64_t frames = sample.frames - last.frames;
+    frames_skipped_ += ticks > frames ? ticks - frames : 0;
+  }
+  samples_.push_back(sample);
+  // The window spans `kWindowSize` periods between the oldest and newest
+  while (samples_.size() > kWindowSize + 1) {
+    samples_.pop_front();
+  }
+}
+
+ThroughputMeter::Rates ThroughputMeter::GetRates() const {
+  Rates rates;
+  if (samples_.size() < 2)
+    return rates;
+
+  const Sample& first = samples_.front();
+  const Sample& last = samples_.back();
+  rates.seconds = absl::ToDoubleSeconds(last.time - first.time);
+  if (rates.seconds <= 0)
+    return rates;
+
+  rates.instructions = (last.instructions - first.instructions) / rates.seconds;
+  rates.cycles = (last.cycles - first.cycles) / rates.seconds;
+  rates.traps = (last.traps - first.traps) / rates.seconds;
+  rates.frames = (last.frames - first.frames) / rates.seconds;
+  const uint64_t ticks = last.ticks - first.ticks;
+  const uint64_t frames = last.frames - first.frames;
+  rates.skipped_frames = (ticks > frames ? ticks - frames : 0) / rates.seconds;
+  return rates;
+}
+
+void ThroughputMeter::Print(std::ostream& os) const {
+  const Rates rates = GetRates();
+  if (counts_instructions_)
+    os << absl::StreamFormat("%.2f MIPS, ", rates.instructions / 1e6);
+  else
+    os << "MIPS unavailable, ";
+  os << absl::StreamFormat(
+      "%.2f MHz, %.0f traps/s, %.1f FPS (%.1f skipped/s) over %.1fs",
+      rates.cycles / 1e6, rates.traps, rates.frames, rates.skipped_frames,
+      rates.seconds);
+}
+
+std::string ThroughputMeter::ToJson() const {
+  const Rates rates = GetRates();
+  const Sample last = samples_.empty() ? Sample{} : samples_.back();
+  // Partial instruction counts are reported as null rather than a wrong number
+  const std::string instructions_per_second =
+      counts_instructions_ ? absl::StrFormat("%.0f", rates.instructions)
+                           : "null";
+  const std::string instructions =
+      counts_instructions_ ? absl::StrCat(last.instructions) : "null";
+  return absl::StrFormat(
+      "{\"window_seconds\": %.3f, \"instructions_per_second\": %s, "
+      "\"cycles_per_second\": %.0f, \"traps_per_second\": %.1f, "
+      "\"frames_per_second\": %.2f, \"skipped_frames_per_second\": %.2f, "
+      "\"instructions\": %s, \"cycles\": %d, \"traps\": %d, "
+      "\"frames_presented\": %d, \"frames_skipped\": %d}",
+      rates.seconds, instructions_per_second, rates.cycles, rates.traps,
+      rates.frames, rates.skipped_frames, instructions, last.cycles,
+      last.traps, last.frames, frames_skipped_);
+}
+
+absl::Status ThroughputMeter::WriteStatsFile(const std::string& path) const {
+  const std::string temp_path = absl::StrCat(path, ".tmp");
+  {
+    std::ofstream file(temp_path, std::ios::trunc);
+    if (!(file << ToJson() << "\n")) {
+      return absl::InternalError(absl::StrCat("Error writing: '", temp_path,
+                                              "': ", strerror(errno)));
+    }
+  }
+  if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+    return absl::InternalError(
+        absl::StrCat("Error renaming to: '", path, "': ", strerror(errno)));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace cyder
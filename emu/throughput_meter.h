@@ -0,0 +1,90 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <ostream>
+#include <string>
+
+#include "absl/status/status.h"
+#include "absl/time/time.h"
+#include "emu/emulator.h"
+
+namespace cyder {
+
+// Measures the throughput of the emulator (emulated instructions, cycles and
+// traps per host second and frames presented/skipped) over a rolling window so
+// that regressions in an application's speed can be spotted.
+class ThroughputMeter {
+ public:
+  static ThroughputMeter& Instance();
+
+  // The period at which samples are taken and the number kept in the window.
+  static constexpr absl::Duration kSamplePeriod = absl::Seconds(1);
+  static constexpr size_t kWindowSize = 5;
+
+  // The totals observed at a point in time.
+  struct Sample {
+    absl::Time time;
+    uint64_t instructions = 0;
+    uint64_t cycles = 0;
+    uint64_t traps = 0;
+    uint64_t frames = 0;
+    uint64_t ticks = 0;
+  };
+
+  // The rates (per host second) over the window.
+  struct Rates {
+    double seconds = 0;
+    double instructions = 0;
+    double cycles = 0;
+    double traps = 0;
+    double frames = 0;
+    // Ticks (1/60th of a second) for which no frame was presented.
+    double skipped_frames = 0;
+  };
+
+  // Logs the rates every `log_interval` (if non-zero) and rewrites the
+  // `stats_file` (if not empty) with each sample.
+  void Configure(absl::Duration log_interval, std::string stats_file);
+
+  // Whether the instructions sampled are complete (see `kHasInstructionHook`).
+  // Otherwise the instruction rate and total are reported as unavailable.
+  void SetCountsInstructions(bool counts) { counts_instructions_ = counts; }
+
+  // Counts a frame presented to the host (called from the UI thread).
+  void RecordFrame() { ++frames_; }
+
+  // Samples the active machine if `kSamplePeriod` has passed since the last
+  // sample. Must be called from the emulator thread (between timeslices).
+  void Update();
+  // Adds a sample (dropping the oldest outside of the window).
+  void AddSample(const Sample& sample);
+
+  Rates GetRates() const;
+  uint64_t frames_presented() const { return frames_; }
+  uint64_t frames_skipped() const { return frames_skipped_; }
+
+  // Prints the rates as a single line (i.e. for logs).
+  void Print(std::ostream& os) const;
+  // Returns the rates and totals as a JSON object.
+  std::string ToJson() const;
+  // Writes `ToJson()` to a temporary file which then replaces `path` so that
+  // readers never see a partially written file.
+  absl::Status WriteStatsFile(const std::string& path) const;
+
+ private:
+  bool counts_instructions_ = kHasInstructionHook;
+  std::atomic<uint64_t> frames_{0};
+  uint64_t frames_skipped_ = 0;
+  std::deque<Sample> samples_;
+
+  absl::Duration log_interval_ = absl::ZeroDuration();
+  absl::Time last_log_ = absl::InfinitePast();
+  std::string stats_file_;
+};
+
+}  // namespace cyder
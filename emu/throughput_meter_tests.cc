@@ -0,0 +1,84 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/throughput_meter.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+
+#include "core/status_helpers.h"
+
+namespace cyder {
+namespace {
+
+using ::testing::HasSubstr;
+
+TEST(ThroughputMeterTests, RatesOverWindow) {
+  const absl::Time start = absl::UnixEpoch();
+  ThroughputMeter meter;
+  meter.SetCountsInstructions(true);
+  meter.AddSample({start, /*instructions=*/0, /*cycles=*/0, /*traps=*/0,
+                   /*frames=*/0, /*ticks=*/0});
+  meter.AddSample({start + absl::Seconds(2), /*instructions=*/4'000'000,
+                   /*cycles=*/16'000'000, /*traps=*/200, /*frames=*/100,
+                   /*ticks=*/120});
+
+  ThroughputMeter::Rates rates = meter.GetRates();
+  EXPECT_DOUBLE_EQ(rates.seconds, 2);
+  EXPECT_DOUBLE_EQ(rates.instructions, 2'000'000);
+  EXPECT_DOUBLE_EQ(rates.cycles, 8'000'000);
+  EXPECT_DOUBLE_EQ(rates.traps, 100);
+  EXPECT_DOUBLE_EQ(rates.frames, 50);
+  EXPECT_DOUBLE_EQ(rates.skipped_frames, 10);
+  EXPECT_EQ(meter.frames_skipped(), 20u);
+
+  std::stringstream line;
+  meter.Print(line);
+  EXPECT_THAT(line.str(), HasSubstr("2.00 MIPS, 8.00 MHz"));
+}
+
+TEST(ThroughputMeterTests, PartialInstructionsAreUnavailable) {
+  ThroughputMeter meter;
+  meter.SetCountsInstructions(false);
+  meter.AddSample({absl::UnixEpoch(), 0, 0, 0, 0, 0});
+  meter.AddSample({absl::UnixEpoch() + absl::Seconds(1), 1000, 1000, 0, 0, 0});
+
+  std::stringstream line;
+  meter.Print(line);
+  EXPECT_THAT(line.str(), HasSubstr("MIPS unavailable, 0.00 MHz"));
+  EXPECT_THAT(meter.ToJson(), HasSubstr("\"instructions_per_second\": null"));
+  EXPECT_THAT(meter.ToJson(), HasSubstr("\"instructions\": null"));
+}
+
+TEST(ThroughputMeterTests, WindowDropsOldSamples) {
+  const absl::Time start = absl::UnixEpoch();
+  ThroughputMeter meter;
+  // Runs at 1000 cycles/s and then 2000 cycles/s for a full window
+  uint64_t cycles = 0;
+  for (int i = 0; i <= 10; ++i) {
+    meter.AddSample({start + absl::Seconds(i), 0, cycles, 0, 0, 0});
+    cycles += i < 5 ? 1000 : 2000;
+  }
+  EXPECT_DOUBLE_EQ(meter.GetRates().seconds, ThroughputMeter::kWindowSize);
+  EXPECT_DOUBLE_EQ(meter.GetRates().cycles, 2000);
+}
+
+TEST(ThroughputMeterTests, WriteStatsFile) {
+  const std::string path = testing::TempDir() + "/throughput.json";
+  ThroughputMeter meter;
+  meter.AddSample({absl::UnixEpoch(), 0, 0, 0, 0, 0});
+  meter.AddSample({absl::UnixEpoch() + absl::Seconds(1), 0, 1000, 0, 0, 0});
+  CHECK_OK(meter.WriteStatsFile(path));
+
+  std::ifstream file(path);
+  std::stringstream contents;
+  contents << file.rdbuf();
+  EXPECT_THAT(contents.str(), HasSubstr("\"cycles_per_second\": 1000"));
+  EXPECT_FALSE(std::ifstream(path + ".tmp").is_open());
+}
+
+}  // namespace
+}  // namespace cyder
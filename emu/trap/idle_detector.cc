@@ -0,0 +1,58 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/trap/idle_detector.h"
+
+#include "emu/machine.h"
+#include "gen/trap_names.h"
+
+namespace cyder {
+namespace trap {
+namespace {
+
+// Whether `trap_op` is (commonly) called by an event loop with nothing to do.
+bool IsPollingTrap(uint16_t trap_op) {
+  switch (trap_op) {
+    case Trap::Button:
+    case Trap::EventAvail:
+    case Trap::GetKeys:
+    case Trap::GetMouse:
+    case Trap::GetNextEvent:
+    case Trap::OSEventAvail:
+    case Trap::StillDown:
+    case Trap::SystemTask:
+    case Trap::TickCount:
+    case Trap::WaitNextEvent:
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+// static
+IdleDetector& IdleDetector::Instance() {
+  return Machine::Current().Get<IdleDetector>();
+}
+
+void IdleDetector::OnTrap(uint16_t trap_op) {
+  if (!IsPollingTrap(trap_op))
+    idle_polls_ = 0;
+}
+
+bool IdleDetector::OnIdlePoll(bool has_written_memory) {
+  if (threshold_ == 0)
+    return false;
+  if (has_written_memory) {
+    idle_polls_ = 0;
+    return false;
+  }
+  if (++idle_polls_ < threshold_)
+    return false;
+  ++idle_count_;
+  return true;
+}
+
+}  // namespace trap
+}  // namespace cyder
@@ -0,0 +1,44 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#pragma once
+
+#include <cstdint>
+
+namespace cyder {
+namespace trap {
+
+// Detects an application spinning in its event loop with nothing to do (i.e.
+// `GetNextEvent()` returning null events over and over) so that the emulator
+// thread can be parked rather than burn a host core. Any trap other than those
+// used to poll, a non-null event or a store outside of the stack between polls
+// means the application is busy.
+class IdleDetector {
+ public:
+  static IdleDetector& Instance();
+
+  // The number of consecutive idle polls after which the application is
+  // considered idle (0, the default, disables detection).
+  void SetThreshold(int threshold) { threshold_ = threshold; }
+
+  // Called on entry to every A-Trap (with flags such as auto-pop cleared).
+  void OnTrap(uint16_t trap_op);
+  // Called when a poll found nothing to do (a null event, `Button()` returning
+  // false or `TickCount()`). `has_written_memory` is whether the emulated CPU
+  // stored anywhere outside of the stack since the last poll. Returns true if
+  // the application is idle and the emulator thread should be parked.
+  bool OnIdlePoll(bool has_written_memory);
+  // Called when a poll returned something for the application to handle.
+  void OnBusy() { idle_polls_ = 0; }
+
+  // The number of times the application was found to be idle.
+  uint64_t idle_count() const { return idle_count_; }
+
+ private:
+  int threshold_ = 0;
+  int idle_polls_ = 0;
+  uint64_t idle_count_ = 0;
+};
+
+}  // namespace trap
+}  // namespace cyder
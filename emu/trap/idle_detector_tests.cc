@@ -0,0 +1,60 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/trap/idle_detector.h"
+
+#include <gtest/gtest.h>
+
+#include "gen/trap_names.h"
+
+namespace cyder {
+namespace trap {
+namespace {
+
+TEST(IdleDetectorTests, DisabledByDefault) {
+  IdleDetector detector;
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_FALSE(detector.OnIdlePoll(/*has_written_memory=*/false));
+  }
+  EXPECT_EQ(detector.idle_count(), 0u);
+}
+
+TEST(IdleDetectorTests, IdleAfterConsecutivePolls) {
+  IdleDetector detector;
+  detector.SetThreshold(3);
+  EXPECT_FALSE(detector.OnIdlePoll(/*has_written_memory=*/false));
+  EXPECT_FALSE(detector.OnIdlePoll(/*has_written_memory=*/false));
+  EXPECT_TRUE(detector.OnIdlePoll(/*has_written_memory=*/false));
+  // Remains idle until the application does something
+  EXPECT_TRUE(detector.OnIdlePoll(/*has_written_memory=*/false));
+  EXPECT_EQ(detector.idle_count(), 2u);
+}
+
+TEST(IdleDetectorTests, PollingTrapsKeepIdle) {
+  IdleDetector detector;
+  detector.SetThreshold(2);
+  detector.OnTrap(Trap::GetNextEvent);
+  EXPECT_FALSE(detector.OnIdlePoll(/*has_written_memory=*/false));
+  detector.OnTrap(Trap::SystemTask);
+  detector.OnTrap(Trap::GetNextEvent);
+  EXPECT_TRUE(detector.OnIdlePoll(/*has_written_memory=*/false));
+}
+
+TEST(IdleDetectorTests, WorkResetsIdle) {
+  IdleDetector detector;
+  detector.SetThreshold(2);
+  detector.OnIdlePoll(/*has_written_memory=*/false);
+  detector.OnTrap(Trap::DrawString);
+  EXPECT_FALSE(detector.OnIdlePoll(/*has_written_memory=*/false));
+
+  EXPECT_FALSE(detector.OnIdlePoll(/*has_written_memory=*/true));
+  EXPECT_FALSE(detector.OnIdlePoll(/*has_written_memory=*/false));
+
+  detector.OnBusy();
+  EXPECT_FALSE(detector.OnIdlePoll(/*has_written_memory=*/false));
+  EXPECT_TRUE(detector.OnIdlePoll(/*has_written_memory=*/false));
+}
+
+}  // namespace
+}  // namespace trap
+}  // namespace cyder
@@ -0,0 +1,63 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/trap/math_utilities.h"
+
+#include "absl/strings/str_cat.h"
+
+namespace cyder {
+namespace trap {
+
+// Link: http://0.0.0.0:8000/docs/mac/OSUtilities/OSUtilities-56.html
+absl::StatusOr<uint16_t> MathUtilities::HiWord(uint32_t x) {
+  return (x >> 16) & 0xFFFF;
+}
+
+// Link: http://0.0.0.0:8000/docs/mac/OSUtilities/OSUtilities-57.html
+absl::StatusOr<uint16_t> MathUtilities::LoWord(uint32_t x) {
+  return x & 0xFFFF;
+}
+
+// Link: http://0.0.0.0:8000/docs/mac/OSUtilities/OSUtilities-88.html
+absl::StatusOr<uint32_t> MathUtilities::FixRatio(uint16_t numer,
+                                                 uint16_t denom) {
+  if (denom == 0)
+    return absl::InvalidArgumentError(
+        absl::StrCat("FixRatio(", numer, ", 0) divides by zero"));
+  return (static_cast<uint32_t>(numer) << 16) / denom;
+}
+
+// Link: http://0.0.0.0:8000/docs/mac/OSUtilities/OSUtilities-68.html
+absl::StatusOr<uint32_t> MathUtilities::FixMul(uint32_t v1, uint32_t v2) {
+  uint64_t result = static_cast<uint64_t>(v1) * v2;
+  return result >> 16;
+}
+
+// Link: http://0.0.0.0:8000/docs/mac/OSUtilities/OSUtilities-89.html
+absl::StatusOr<uint16_t> MathUtilities::FixRound(uint32_t v) {
+  // Separate integer and fractional values
+  uint16_t integer = v >> 16;
+  uint16_t fractional = v & 0xFFFF;
+  // Round up only if `fractional` is greater than 0.5
+  if (fractional > 32767) {
+    integer = integer + 1;
+  }
+  return integer;
+}
+
+// Mathematical and Logical Utilities (3-30)
+absl::StatusOr<uint32_t> MathUtilities::BitAnd(uint32_t value1,
+                                               uint32_t value2) {
+  return value1 & value2;
+}
+
+// Mathematical and Logical Utilities (3-30)
+absl::StatusOr<uint32_t> MathUtilities::BitShift(uint32_t value,
+                                                 int16_t count) {
+  if (count < 0)
+    return value >> -count;
+  return value << count;
+}
+
+}  // namespace trap
+}  // namespace cyder
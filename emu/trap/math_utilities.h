@@ -0,0 +1,26 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#pragma once
+
+#include "emu/trap/math_utilities.tdef.h"
+
+namespace cyder {
+namespace trap {
+
+// The pure (no memory access) Mathematical and Logical Utilities. These are
+// dispatched through the generated trap table (see math_utilities.tdef).
+class MathUtilities : public ::gen::MathUtilities {
+ public:
+  // ::gen::MathUtilities implementation:
+  absl::StatusOr<uint16_t> HiWord(uint32_t x) override;
+  absl::StatusOr<uint16_t> LoWord(uint32_t x) override;
+  absl::StatusOr<uint32_t> FixRatio(uint16_t numer, uint16_t denom) override;
+  absl::StatusOr<uint32_t> FixMul(uint32_t v1, uint32_t v2) override;
+  absl::StatusOr<uint16_t> FixRound(uint32_t v) override;
+  absl::StatusOr<uint32_t> BitAnd(uint32_t value1, uint32_t value2) override;
+  absl::StatusOr<uint32_t> BitShift(uint32_t value, int16_t count) override;
+};
+
+}  // namespace trap
+}  // namespace cyder
@@ -0,0 +1,84 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/trap/math_utilities.h"
+
+#include <gtest/gtest.h>
+
+#include "core/status_helpers.h"
+#include "emu/memory/memory_map.h"
+#include "emu/trap/stack_helpers.h"
+#include "emu/trap/trap_dispatch_table.h"
+#include "gen/trap_names.h"
+#include "third_party/musashi/src/m68k.h"
+
+namespace cyder {
+namespace trap {
+namespace {
+
+class MathUtilitiesTests : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    m68k_set_reg(M68K_REG_SP, memory::StackStart());
+    targets_.math_utilities = &math_utilities_;
+  }
+
+  MathUtilities math_utilities_;
+  gen::TrapTargets targets_;
+};
+
+TEST_F(MathUtilitiesTests, DispatchesFromStack) {
+  // Space for the result followed by the arguments from left to right
+  Push<uint32_t>(0);
+  Push<uint32_t>(0xFF00FF00);
+  Push<uint32_t>(0x0FF00FF0);
+  CHECK_OK(gen::Dispatch(Trap::BitAnd, targets_));
+  EXPECT_EQ(Pop<uint32_t>(), 0x0F000F00u);
+  EXPECT_EQ(m68k_get_reg(NULL, M68K_REG_SP), memory::StackStart());
+
+  Push<uint32_t>(0);
+  Push<uint32_t>(0x10);
+  Push<int16_t>(-4);
+  CHECK_OK(gen::Dispatch(Trap::BitShift, targets_));
+  EXPECT_EQ(Pop<uint32_t>(), 0x1u);
+}
+
+TEST_F(MathUtilitiesTests, LooksUpAutoPopVariant) {
+  // The auto-pop bit (10) does not change which Toolbox trap is called
+  EXPECT_TRUE(gen::IsGenerated(Trap::HiWord));
+  EXPECT_TRUE(gen::IsGenerated(Trap::HiWord | (1 << 10)));
+  EXPECT_FALSE(gen::IsGenerated(Trap::BitTst));
+}
+
+TEST_F(MathUtilitiesTests, FallsBackToNativeTraps) {
+  struct FakeNativeTraps : gen::NativeTraps {
+    absl::Status DispatchNativeSystemTrap(uint16_t trap) override {
+      system_trap = trap;
+      return absl::OkStatus();
+    }
+    absl::Status DispatchNativeToolboxTrap(uint16_t trap) override {
+      toolbox_trap = trap;
+      return absl::OkStatus();
+    }
+    uint16_t system_trap = 0;
+    uint16_t toolbox_trap = 0;
+  } native;
+  targets_.native = &native;
+
+  CHECK_OK(gen::Dispatch(Trap::BitTst, targets_));
+  EXPECT_EQ(native.toolbox_trap, Trap::BitTst);
+  CHECK_OK(gen::Dispatch(Trap::NewPtrClear, targets_));
+  EXPECT_EQ(native.system_trap, Trap::NewPtrClear);
+}
+
+TEST_F(MathUtilitiesTests, FixedPoint) {
+  EXPECT_EQ(MUST(math_utilities_.FixRatio(1, 2)), 0x8000u);
+  EXPECT_EQ(MUST(math_utilities_.FixMul(0x00018000, 0x00020000)), 0x30000u);
+  EXPECT_EQ(MUST(math_utilities_.FixRound(0x00017FFF)), 1);
+  EXPECT_EQ(MUST(math_utilities_.FixRound(0x00018000)), 2);
+  EXPECT_FALSE(math_utilities_.FixRatio(1, 0).ok());
+}
+
+}  // namespace
+}  // namespace trap
+}  // namespace cyder
@@ -3,8 +3,6 @@
 
 #include "emu/trap/trap_dispatcher.h"
 
-#include <SDL.h>
-
 #include <cstdint>
 #include <iomanip>
 #include <tuple>
@@ -17,6 +15,7 @@
 #include "emu/controls/control_manager.h"
 #include "emu/debug/debugger.h"
 #include "emu/dialog/dialog_manager.h"
+#include "emu/emulator.h"
 #include "emu/font/font.h"
 #include "emu/graphics/grafport_types.tdef.h"
 #include "emu/graphics/graphics_helpers.h"
@@ -26,8 +25,12 @@
 #include "emu/memory/memory_manager.h"
 #include "emu/memory/memory_map.h"
 #include "emu/rsrc/resource.h"
+#include "emu/run_report.h"
+#include "emu/scheduler.h"
+#include "emu/trap/idle_detector.h"
 #include "emu/trap/stack_helpers.h"
 #include "emu/trap/trap_helpers.h"
+#include "emu/vertical_retrace.h"
 #include "gen/global_names.h"
 #include "gen/trap_names.h"
 #include "gen/typegen/typegen_prelude.h"
@@ -36,6 +39,8 @@
 #include "third_party/musashi/src/m68k.h"
 
 ABSL_DECLARE_FLAG(/*type=*/bool, exit_on_idle);
+ABSL_DECLARE_FLAG(/*type=*/std::string, screenshot_file);
+ABSL_DECLARE_FLAG(/*type=*/std::string, report_file);
 
 extern bool single_step;
 
@@ -81,12 +86,30 @@ absl::Status WithWindow(
 
 void SaveScreenShotAndExit() {
   auto globals = MUST(port::GetQDGlobals());
-  graphics::BitmapImage(
+  graphics::BitmapImage screen(
       globals.screen_bits,
-      memory::kSystemMemory.raw_mutable_ptr() + globals.screen_bits.base_addr)
-      .SaveBitmap("/tmp/screenshot.bmp");
-  LOG(INFO) << "Saved screenshot to: /tmp/screenshot.bmp";
-  exit(0);
+      memory::kSystemMemory.raw_mutable_ptr() + globals.screen_bits.base_addr);
+  SaveRunAndExit(screen, absl::GetFlag(FLAGS_screenshot_file),
+                 absl::GetFlag(FLAGS_report_file));
+}
+
+// Called when a poll found nothing for the application to do. Once it has been
+// idle for a while the emulator thread is parked until there is input or the
+// next tick (when VBL tasks run and `TickCount()` changes).
+void ParkIfIdle(EventManager& event_manager) {
+  if (!IdleDetector::Instance().OnIdlePoll(
+          Emulator::Instance().ConsumeNonStackWrites())) {
+    return;
+  }
+  Scheduler& scheduler = Scheduler::Instance();
+  // The virtual clock only advances as cycles are run (so spinning is what
+  // moves time forward) unless fast-forwarding where idle time is skipped.
+  if (scheduler.clock_mode() == Scheduler::ClockMode::kVirtual) {
+    if (scheduler.fast_forward())
+      scheduler.SkipTicks(1);
+    return;
+  }
+  event_manager.WaitForInput(scheduler.TimeUntilNextTick());
 }
 
 }  // namespace
@@ -102,20 +125,26 @@ TrapDispatcherImpl::TrapDispatcherImpl(memory::MemoryManager& memory_manager,
       event_manager_(event_manager),
       menu_manager_(menu_manager),
       window_manager_(window_manager),
-      screen_bits_(screen_bits) {}
+      screen_bits_(screen_bits) {
+  trap_targets_.native = this;
+  trap_targets_.math_utilities = &math_utilities_;
+
+  int generated_count = 0;
+  for (uint16_t index = 0; index < 0x400; ++index) {
+    if (index < 0x100 && gen::IsGenerated(0xA000 | index))
+      ++generated_count;
+    if (gen::IsGenerated(0xA800 | index))
+      ++generated_count;
+  }
+  LOG(INFO) << "Traps served by the generated dispatch table: "
+            << generated_count;
+}
 
 absl::Status TrapDispatcherImpl::Dispatch(uint16_t trap_op) {
-  if (IsToolbox(trap_op)) {
-    CHECK_OK(DispatchNativeToolboxTrap(trap_op))
-        << "Failed to dispatch Toolbox::" << GetTrapName(trap_op) << " (0x"
-        << std::hex << trap_op << ") Index: " << std::dec
-        << ExtractIndex(trap_op);
-  } else {
-    CHECK_OK(DispatchNativeSystemTrap(trap_op))
-        << "Failed to dispatch System::" << GetTrapName(trap_op) << " (0x"
-        << std::hex << trap_op << ") Index: " << std::dec
-        << ExtractIndex(trap_op);
-  }
+  CHECK_OK(gen::Dispatch(trap_op, trap_targets_))
+      << "Failed to dispatch " << (IsToolbox(trap_op) ? "Toolbox" : "System")
+      << "::" << GetTrapName(trap_op) << " (0x" << std::hex << trap_op
+      << ") Index: " << std::dec << ExtractIndex(trap_op);
   return absl::OkStatus();
 }
 
@@ -152,8 +181,26 @@ absl::Status TrapDispatcherImpl::DispatchNativeSystemTrap(uint16_t trap) {
 
       LOG_TRAP() << "DisposePtr(ptr: 0x" << std::hex << ptr << ")";
 
-      uint32_t status = 0;
-      m68k_set_reg(M68K_REG_D0, status);
+      memory_manager_.DeallocatePtr(ptr);
+      m68k_set_reg(M68K_REG_D0, /*noErr*/ 0);
+      return absl::OkStatus();
+    }
+    case Trap::DisposeHandle: {
+      uint32_t handle = m68k_get_reg(NULL, M68K_REG_A0);
+      LOG_TRAP() << "DisposeHandle(h: 0x" << std::hex << handle << ")";
+      // The master pointer is reused so it must not stay a cached resource
+      resource_manager_.ForgetResource(handle);
+      memory_manager_.Deallocate(handle);
+      m68k_set_reg(M68K_REG_D0, /*noErr*/ 0);
+      return absl::OkStatus();
+    }
+    case Trap::SetHandleSize: {
+      uint32_t handle = m68k_get_reg(NULL, M68K_REG_A0);
+      uint32_t new_size = m68k_get_reg(NULL, M68K_REG_D0);
+      LOG_TRAP() << "SetHandleSize(h: 0x" << std::hex << handle
+                 << ", newSize: " << std::dec << new_size << ")";
+      bool success = memory_manager_.SetHandleSize(handle, new_size);
+      m68k_set_reg(M68K_REG_D0, success ? /*noErr*/ 0 : /*memFullErr*/ -108);
       return absl::OkStatus();
     }
     // Link: http://0.0.0.0:8000/docs/mac/Memory/Memory-81.html
@@ -165,7 +212,7 @@ absl::Status TrapDispatcherImpl::DispatchNativeSystemTrap(uint16_t trap) {
     }
     // Link: http://0.0.0.0:8000/docs/mac/Memory/Memory-75.html
     case Trap::NewPtr:
-    // All allocated pointers are cleared (and never reallocated)
+    // All allocated pointers are cleared
     case Trap::NewPtrClear:
     case Trap::NewPtrSysClear:
     // FIXME: Should "SYS" pointers be allocated differently?
@@ -202,29 +249,72 @@ absl::Status TrapDispatcherImpl::DispatchNativeSystemTrap(uint16_t trap) {
     // Link: https://dev.os9.ca/techpubs/mac/Memory/Memory-97.html
     case Trap::RecoverHandle: {
       uint32_t ptr = m68k_get_reg(NULL, M68K_REG_A0);
+      LOG_TRAP() << "RecoverHandle(p: 0x" << std::hex << ptr << ")";
       m68k_set_reg(M68K_REG_A0, memory_manager_.RecoverHandle(ptr));
+      m68k_set_reg(M68K_REG_D0, /*noErr*/ 0);
+      return absl::OkStatus();
     }
     // Link: http://0.0.0.0:8000/docs/mac/Memory/Memory-31.html
     case Trap::HLock:
     // Link: http://0.0.0.0:8000/docs/mac/Memory/Memory-32.html
-    case Trap::HUnlock:
+    case Trap::HUnlock: {
+      uint32_t handle = m68k_get_reg(NULL, M68K_REG_A0);
+      LOG_TRAP() << GetTrapName(trap) << "(h: 0x" << std::hex << handle << ")";
+      memory_manager_.SetHandleLocked(handle, trap == Trap::HLock);
+      m68k_set_reg(M68K_REG_D0, /*noErr*/ 0);
+      return absl::OkStatus();
+    }
     // Link: http://0.0.0.0:8000/docs/mac/Memory/Memory-33.html
     case Trap::HPurge:
     // Link: http://0.0.0.0:8000/docs/mac/Memory/Memory-34.html
     case Trap::HNoPurge: {
-      // MemoryManager currently does not move or purge blocks so assume success
+      uint32_t handle = m68k_get_reg(NULL, M68K_REG_A0);
+      LOG_TRAP() << GetTrapName(trap) << "(h: 0x" << std::hex << handle << ")";
+      memory_manager_.SetHandlePurgeable(handle, trap == Trap::HPurge);
       m68k_set_reg(M68K_REG_D0, /*noErr*/ 0);
       return absl::OkStatus();
     }
     // Link: http://0.0.0.0:8000/docs/mac/Memory/Memory-64.html
-    case Trap::MaxApplZone:
+    case Trap::MaxApplZone: {
+      LOG_TRAP() << "MaxApplZone()";
+      // The zone always extends to its limit so only compact it
+      memory_manager_.Compact();
+      m68k_set_reg(M68K_REG_D0, /*noErr*/ 0);
+      return absl::OkStatus();
+    }
     // Link: http://0.0.0.0:8000/docs/mac/Memory/Memory-65.html
     case Trap::MoreMasters: {
-      // Memory manager currently assumes max heap already and
-      // heap fragmentation is not a huge concern right now.
+      // Master pointers are recycled from a fixed table (see MemoryManager)
       m68k_set_reg(M68K_REG_D0, /*noErr*/ 0);
       return absl::OkStatus();
     }
+    case Trap::CompactMem: {
+      uint32_t cb_needed = m68k_get_reg(NULL, M68K_REG_D0);
+      LOG_TRAP() << "CompactMem(cbNeeded: " << cb_needed << ")";
+      m68k_set_reg(M68K_REG_D0, memory_manager_.Compact());
+      return absl::OkStatus();
+    }
+    case Trap::PurgeMem: {
+      uint32_t cb_needed = m68k_get_reg(NULL, M68K_REG_D0);
+      LOG_TRAP() << "PurgeMem(cbNeeded: " << cb_needed << ")";
+      memory_manager_.Purge();
+      bool success = memory_manager_.MaxBlock(/*purge=*/false) >= cb_needed;
+      m68k_set_reg(M68K_REG_D0, success ? /*noErr*/ 0 : /*memFullErr*/ -108);
+      return absl::OkStatus();
+    }
+    case Trap::MaxMem: {
+      LOG_TRAP() << "MaxMem()";
+      memory_manager_.Purge();
+      m68k_set_reg(M68K_REG_D0, memory_manager_.Compact());
+      // The application heap can not grow any further
+      m68k_set_reg(M68K_REG_A0, 0);
+      return absl::OkStatus();
+    }
+    case Trap::MaxBlock: {
+      LOG_TRAP() << "MaxBlock()";
+      m68k_set_reg(M68K_REG_D0, memory_manager_.MaxBlock(/*purge=*/false));
+      return absl::OkStatus();
+    }
     // Link: http://0.0.0.0:8000/docs/mac/Memory/Memory-125.html
     case Trap::SetGrowZone:
       m68k_set_reg(M68K_REG_D0, /*noErr*/ 0);
@@ -548,7 +638,7 @@ absl::Status TrapDispatcherImpl::DispatchNativeSystemTrap(uint16_t trap) {
     case Trap::ReadDateTime: {
       Ptr time_var = m68k_get_reg(NULL, M68K_REG_A0);
       LOG_TRAP() << "ReadDateTime(VAR time: 0x" << std::hex << time_var << ")";
-      // Time is set with the current time before each emulation time slice.
+      // Time is set at startup and advanced by the VBL interrupt.
       RETURN_IF_ERROR(memory::kSystemMemory.Write<uint32_t>(
           time_var,
           TRY(memory::kSystemMemory.Read<uint32_t>(GlobalVars::Time))));
@@ -556,6 +646,25 @@ absl::Status TrapDispatcherImpl::DispatchNativeSystemTrap(uint16_t trap) {
       return absl::OkStatus();
     }
 
+    // ================  Vertical Retrace Manager  ===================
+
+    // Link: https://dev.os9.ca/techpubs/mac/Processes/Processes-43.html
+    case Trap::VInstall: {
+      Ptr vbl_task = m68k_get_reg(NULL, M68K_REG_A0);
+      LOG_TRAP() << "VInstall(vblTaskPtr: 0x" << std::hex << vbl_task << ")";
+      m68k_set_reg(M68K_REG_D0,
+                   TRY(VerticalRetraceManager::Instance().Install(vbl_task)));
+      return absl::OkStatus();
+    }
+    // Link: https://dev.os9.ca/techpubs/mac/Processes/Processes-44.html
+    case Trap::VRemove: {
+      Ptr vbl_task = m68k_get_reg(NULL, M68K_REG_A0);
+      LOG_TRAP() << "VRemove(vblTaskPtr: 0x" << std::hex << vbl_task << ")";
+      m68k_set_reg(M68K_REG_D0,
+                   TRY(VerticalRetraceManager::Instance().Remove(vbl_task)));
+      return absl::OkStatus();
+    }
+
     // ======================== Gestalt Manager ========================
 
     // Link: https://dev.os9.ca/techpubs/mac/OSUtilities/OSUtilities-19.html
@@ -587,7 +696,12 @@ absl::Status TrapDispatcherImpl::DispatchNativeToolboxTrap(uint16_t trap) {
     // Link: http://0.0.0.0:8000/docs/mac/Toolbox/Toolbox-73.html
     case Trap::Button: {
       LOG_TRAP() << "Button()";
-      return TrapReturn<bool>(event_manager_.HasMouseEvent(kMouseDown));
+      const bool is_down = event_manager_.HasMouseEvent(kMouseDown);
+      if (is_down)
+        IdleDetector::Instance().OnBusy();
+      else
+        ParkIfIdle(event_manager_);
+      return TrapReturn<bool>(is_down);
     }
       // Link: http://0.0.0.0:8000/docs/mac/Toolbox/Toolbox-74.html
     case Trap::StillDown: {
@@ -601,13 +715,7 @@ absl::Status TrapDispatcherImpl::DispatchNativeToolboxTrap(uint16_t trap) {
       LOG_TRAP() << "GetMouse(VAR mouseLoc: 0x" << std::hex
                  << mouse_location_var << ")";
 
-      int mouse_x = 0, mouse_y = 0;
-      SDL_GetMouseState(&mouse_x, &mouse_y);
-
-      // FIXME: Ensure it is safe to do these implicit bit-narrowing casts
-      Point mouse_location;
-      mouse_location.x = mouse_x;
-      mouse_location.y = mouse_y;
+      Point mouse_location = event_manager_.GetMouseLocation();
 
       return WithPort([&](GrafPort& the_port) {
         mouse_location = port::GlobalToLocal(the_port, mouse_location);
@@ -628,11 +736,18 @@ absl::Status TrapDispatcherImpl::DispatchNativeToolboxTrap(uint16_t trap) {
                  << std::hex << mouse_region << ")";
 
       if (absl::GetFlag(FLAGS_exit_on_idle) &&
-          !event_manager_.has_window_events()) {
+          !event_manager_.has_window_events() &&
+          !event_manager_.has_pending_replay()) {
         SaveScreenShotAndExit();
       }
 
       EventRecord event = event_manager_.WaitNextEvent(event_mask, sleep);
+      // A non-zero `sleep` has already waited (for up to `sleep` ticks)
+      if (event.what != kNullEvent) {
+        IdleDetector::Instance().OnBusy();
+      } else if (sleep == 0) {
+        ParkIfIdle(event_manager_);
+      }
       Debugger::Instance().OnEvent(event.what);
 
       RETURN_IF_ERROR(WriteType<EventRecord>(
@@ -649,11 +764,17 @@ absl::Status TrapDispatcherImpl::DispatchNativeToolboxTrap(uint16_t trap) {
                  << ", VAR theEvent: 0x" << std::hex << the_event_var << ")";
 
       if (absl::GetFlag(FLAGS_exit_on_idle) &&
-          !event_manager_.has_window_events()) {
+          !event_manager_.has_window_events() &&
+          !event_manager_.has_pending_replay()) {
         SaveScreenShotAndExit();
       }
 
       auto event = event_manager_.GetNextEvent(event_mask);
+      if (event.what == kNullEvent) {
+        ParkIfIdle(event_manager_);
+      } else {
+        IdleDetector::Instance().OnBusy();
+      }
 
       Debugger::Instance().OnEvent(event.what);
 
@@ -671,6 +792,7 @@ absl::Status TrapDispatcherImpl::DispatchNativeToolboxTrap(uint16_t trap) {
     }
     // Link: http://0.0.0.0:8000/docs/mac/Toolbox/Toolbox-80.html
     case Trap::TickCount: {
+      ParkIfIdle(event_manager_);
       return TrapReturn<uint32_t>(event_manager_.NowTicks());
     }
     // Link: http://0.0.0.0:8000/docs/mac/Toolbox/Toolbox-58.html
@@ -784,7 +906,11 @@ absl::Status TrapDispatcherImpl::DispatchNativeToolboxTrap(uint16_t trap) {
         size += item.size();
       }
 
-      Ptr new_location = memory_manager_.Allocate(size);
+      if (!memory_manager_.SetHandleSize(the_menu, size)) {
+        return absl::ResourceExhaustedError(
+            "Not enough memory to append to menu");
+      }
+      Ptr new_location = memory_manager_.GetPtrForHandle(the_menu);
       RETURN_IF_ERROR(
           WriteType<MenuResource>(menu, memory::kSystemMemory, new_location));
       size_t offset = menu.size();
@@ -794,7 +920,6 @@ absl::Status TrapDispatcherImpl::DispatchNativeToolboxTrap(uint16_t trap) {
         offset += item.size();
       }
 
-      memory_manager_.UpdateHandle(the_menu, new_location, offset);
       return absl::OkStatus();
     }
     // Link: http://0.0.0.0:8000/docs/mac/Toolbox/Toolbox-130.html
@@ -1599,8 +1724,9 @@ absl::Status TrapDispatcherImpl::DispatchNativeToolboxTrap(uint16_t trap) {
     // Link: http://0.0.0.0:8000/docs/mac/MoreToolbox/MoreToolbox-56.html
     case Trap::LoadResource: {
       auto handle = Pop<uint32_t>();
-      LOG_DUMMY() << "LoadResource(theResource: 0x" << std::hex << handle
-                  << ")";
+      LOG_TRAP() << "LoadResource(theResource: 0x" << std::hex << handle
+                 << ")";
+      resource_manager_.LoadResource(handle);
       return absl::OkStatus();
     }
     // Link: http://0.0.0.0:8000/docs/mac/MoreToolbox/MoreToolbox-85.html
@@ -2282,10 +2408,8 @@ absl::Status TrapDispatcherImpl::DispatchNativeToolboxTrap(uint16_t trap) {
       uint32_t number_of_seconds = m68k_get_reg(NULL, M68K_REG_D0);
       Ptr record_ptr = m68k_get_reg(NULL, M68K_REG_A0);
 
-      static auto kLocalTimeZone = absl::LocalTimeZone();
-
       return WithType<DateTimeRec>(record_ptr, [&](DateTimeRec& record) {
-        auto breakdown = kLocalTimeZone.At(
+        auto breakdown = Scheduler::Instance().time_zone().At(
             absl::FromUnixSeconds(number_of_seconds - 2082844800));
 
         record.day = breakdown.cs.day();
@@ -2306,7 +2430,8 @@ absl::Status TrapDispatcherImpl::DispatchNativeToolboxTrap(uint16_t trap) {
       return WithType<DateTimeRec>(record_ptr, [&](const DateTimeRec& record) {
         absl::CivilSecond civil_time(record.year, record.month, record.day,
                                      record.hour, record.minute, record.second);
-        absl::Time time = absl::FromCivil(civil_time, absl::LocalTimeZone());
+        absl::Time time =
+            absl::FromCivil(civil_time, Scheduler::Instance().time_zone());
         m68k_set_reg(M68K_REG_D0, absl::ToUnixSeconds(time) + 2082844800);
         return absl::OkStatus();
       });
@@ -2314,18 +2439,6 @@ absl::Status TrapDispatcherImpl::DispatchNativeToolboxTrap(uint16_t trap) {
 
     // ==================  Math and Logical Utilities  ====================
 
-    // Link: http://0.0.0.0:8000/docs/mac/OSUtilities/OSUtilities-56.html
-    case Trap::HiWord: {
-      auto x = Pop<uint32_t>();
-      LOG_TRAP() << "HiWord(x: " << x << ")";
-      return TrapReturn<uint16_t>((x >> 16) & 0xFFFF);
-    }
-    // Link: http://0.0.0.0:8000/docs/mac/OSUtilities/OSUtilities-57.html
-    case Trap::LoWord: {
-      auto x = Pop<uint32_t>();
-      LOG_TRAP() << "LoWord(x: " << x << ")";
-      return TrapReturn<uint16_t>(x & 0xFFFF);
-    }
     // Link: http://0.0.0.0:8000/docs/mac/OSUtilities/OSUtilities-58.html
     case Trap::StuffHex: {
       auto s = PopRef<std::string>();
@@ -2348,34 +2461,6 @@ absl::Status TrapDispatcherImpl::DispatchNativeToolboxTrap(uint16_t trap) {
       RETURN_IF_ERROR(TrapReturn<int16_t>(0xFFFF * rand()));
       return absl::OkStatus();
     }
-    // Link: http://0.0.0.0:8000/docs/mac/OSUtilities/OSUtilities-88.html
-    case Trap::FixRatio: {
-      auto denom = Pop<uint16_t>();
-      auto numer = Pop<uint16_t>();
-      LOG_TRAP() << "FixRatio(numer: " << numer << ", denom: " << denom << ")";
-      return TrapReturn<uint32_t>((static_cast<uint32_t>(numer) << 16) / denom);
-    }
-    // Link: http://0.0.0.0:8000/docs/mac/OSUtilities/OSUtilities-68.html
-    case Trap::FixMul: {
-      uint64_t v2 = Pop<uint32_t>();
-      uint64_t v1 = Pop<uint32_t>();
-      LOG_TRAP() << "FixMul(v1: " << v1 << ", v2: " << v2 << ")";
-      uint64_t result = v1 * v2;
-      return TrapReturn<uint32_t>(result >> 16);
-    }
-    // Link: http://0.0.0.0:8000/docs/mac/OSUtilities/OSUtilities-89.html
-    case Trap::FixRound: {
-      uint32_t v = Pop<uint32_t>();
-      LOG_TRAP() << "FixRound(v: " << v << ")";
-      // Separate integer and fractional values
-      uint16_t integer = v >> 16;
-      uint16_t fractional = v & 0xFFFF;
-      // Round up only if `fractional` is greater than 0.5
-      if (fractional > 32767) {
-        integer = integer + 1;
-      }
-      return TrapReturn<uint16_t>(integer);
-    }
     // Mathematical and Logical Utilities (3-28)
     // https://dev.os9.ca/techpubs/mac/pdf/Operating_System_Utilities/MLU.pdf
     case Trap::BitTst: {
@@ -2393,30 +2478,6 @@ absl::Status TrapDispatcherImpl::DispatchNativeToolboxTrap(uint16_t trap) {
     }
     // Mathematical and Logical Utilities (3-30)
     // https://dev.os9.ca/techpubs/mac/pdf/Operating_System_Utilities/MLU.pdf
-    case Trap::BitAnd: {
-      auto v2 = Pop<uint32_t>();
-      auto v1 = Pop<uint32_t>();
-
-      LOG_TRAP() << "BitAnd(value1: " << v1 << ", value2: " << v2 << ")";
-
-      return TrapReturn<uint32_t>(v1 & v2);
-    }
-    // Mathematical and Logical Utilities (3-30)
-    // https://dev.os9.ca/techpubs/mac/pdf/Operating_System_Utilities/MLU.pdf
-    case Trap::BitShift: {
-      auto count = Pop<int16_t>();
-      auto value = Pop<uint32_t>();
-
-      LOG_TRAP() << "BitShift(value: " << value << ", count: " << count << ")";
-
-      if (count < 0) {
-        return TrapReturn<uint32_t>(value >> -count);
-      } else {
-        return TrapReturn<uint32_t>(value << count);
-      }
-    }
-    // Mathematical and Logical Utilities (3-30)
-    // https://dev.os9.ca/techpubs/mac/pdf/Operating_System_Utilities/MLU.pdf
     case Trap::BitSet: {
       auto bitNum = Pop<uint32_t>();
       auto bytePtr = Pop<Ptr>();
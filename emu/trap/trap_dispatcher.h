@@ -13,6 +13,8 @@
 #include "emu/menu_manager.h"
 #include "emu/rsrc/resource_manager.h"
 #include "emu/segment_loader.h"
+#include "emu/trap/math_utilities.h"
+#include "emu/trap/trap_dispatch_table.h"
 #include "emu/window_manager.h"
 #include "gen/trap_names.h"
 
@@ -29,7 +31,7 @@ class TrapDispatcher {
 };
 
 // Handles dispatching from emulated A-Traps to native code
-class TrapDispatcherImpl : public TrapDispatcher {
+class TrapDispatcherImpl : public TrapDispatcher, private gen::NativeTraps {
  public:
   TrapDispatcherImpl(memory::MemoryManager& memory_manager,
                      ResourceManager& resource_manager,
@@ -43,8 +45,9 @@ class TrapDispatcherImpl : public TrapDispatcher {
   absl::Status Dispatch(uint16_t trap) override;
 
  private:
-  absl::Status DispatchNativeSystemTrap(uint16_t trap);
-  absl::Status DispatchNativeToolboxTrap(uint16_t trap);
+  // gen::NativeTraps implementation:
+  absl::Status DispatchNativeSystemTrap(uint16_t trap) override;
+  absl::Status DispatchNativeToolboxTrap(uint16_t trap) override;
 
   memory::MemoryManager& memory_manager_;
   ResourceManager& resource_manager_;
@@ -54,6 +57,12 @@ class TrapDispatcherImpl : public TrapDispatcher {
   BitMap screen_bits_;
 
   Handle previous_clip_region_;
+
+  // Every trap is dispatched through the generated table (see
+  // gen/typegen/compiler/codegen/trap_dispatch.py) which falls back to the
+  // switches above for traps not declared in a .tdef file.
+  MathUtilities math_utilities_;
+  gen::TrapTargets trap_targets_;
 };
 
 }  // namespace trap
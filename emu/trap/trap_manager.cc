@@ -3,6 +3,7 @@
 
 #include "emu/trap/trap_manager.h"
 
+#include <chrono>
 #include <cstdint>
 #include <iomanip>
 #include <tuple>
@@ -13,9 +14,12 @@
 #include "emu/emulator.h"
 #include "emu/memory/memory_helpers.h"
 #include "emu/memory/memory_map.h"
+#include "emu/scheduler.h"
 #include "emu/segment_loader.h"
+#include "emu/trap/idle_detector.h"
 #include "emu/trap/stack_helpers.h"
 #include "emu/trap/trap_helpers.h"
+#include "emu/trap/trap_stats.h"
 #include "gen/global_names.h"
 #include "gen/trap_names.h"
 #include "third_party/musashi/src/m68k.h"
@@ -53,7 +57,7 @@ TrapManager::TrapManager(SegmentLoader& segment_loader,
   // from patched traps to the native trap handlers.
   for (int i = 0; i < 1024; ++i) {
     Emulator::Instance().RegisterNativeFunction(
-        memory::kBaseToolboxTrapAddress + (i * sizeof(uint16_t)), [this, i]() {
+        memory::BaseToolboxTrapAddress() + (i * sizeof(uint16_t)), [this, i]() {
           PerformTrapDispatch(0xA000 | i, /*is_toolbox=*/true);
           ReturnSubroutine();
         });
@@ -63,7 +67,7 @@ TrapManager::TrapManager(SegmentLoader& segment_loader,
   // from patched traps to the native trap handlers.
   for (int i = 0; i < 256; ++i) {
     Emulator::Instance().RegisterNativeFunction(
-        memory::kBaseSystemTrapAddress + (i * sizeof(uint16_t)), [this, i]() {
+        memory::BaseSystemTrapAddress() + (i * sizeof(uint16_t)), [this, i]() {
           PerformTrapDispatch(0xA000 | i, /*is_toolbox=*/false);
           ReturnSubroutine();
         });
@@ -71,10 +75,10 @@ TrapManager::TrapManager(SegmentLoader& segment_loader,
 
   // Sets up the A-Trap exit handler. It is a mix of emulated and native code.
   CHECK_OK(memory::kSystemMemory.Write<uint16_t>(
-      cyder::memory::kTrapManagerExitAddress, 0x4A40 /* TST.W D0 */));
+      cyder::memory::TrapManagerExitAddress(), 0x4A40 /* TST.W D0 */));
   // Ensure the native funtion occures after the `TST.W D0` instruction.
   Emulator::Instance().RegisterNativeFunction(
-      memory::kTrapManagerExitAddress + 2, [this]() {
+      memory::TrapManagerExitAddress() + 2, [this]() {
         CHECK_OK(PerformTrapExit());
         ReturnSubroutine();
       });
@@ -102,6 +106,9 @@ uint32_t TrapManager::PerformTrapEntry() {
     ip += 2;
   }
 
+  TrapStats::Counters& counters = TrapStats::Instance().RecordTrap(
+      trap_op, Scheduler::Instance().total_cycles());
+  IdleDetector::Instance().OnTrap(trap_op);
   ::cyder::Debugger::Instance().OnTrapEntry(GetTrapName(trap_op));
 
   LOG_IF(INFO, kVerboseLogTraps)
@@ -129,17 +136,17 @@ uint32_t TrapManager::PerformTrapEntry() {
     // the registes (and stack). Pushing the exit address emulates a `JSR` so
     // that TrapManager can complete the rest of its logic (the same as native).
     if (IsSystem(trap_op))
-      Push<uint32_t>(memory::kTrapManagerExitAddress);
+      Push<uint32_t>(memory::TrapManagerExitAddress());
 
     // A patched trap address should end with an `RTS` instruction. So the PC
     // will be reset to `ip` when the patched trap address returns.
     return patch_address->second;
   }
 
-  PerformTrapDispatch(ExtractIndex(trap_op), IsToolbox(trap_op));
+  DispatchTrap(trap_op, counters);
 
   if (IsSystem(trap_op)) {
-    return memory::kTrapManagerExitAddress;
+    return memory::TrapManagerExitAddress();
   }
   return Pop<uint32_t>();
 }
@@ -164,6 +171,12 @@ void TrapManager::PerformTrapDispatch(uint16_t trap_index, bool is_toolbox) {
     trap_op = m68k_get_reg(/*context=*/NULL, M68K_REG_D1);
     CHECK_EQ(trap_index, ExtractIndex(trap_op));
   }
+  DispatchTrap(trap_op, TrapStats::Instance().CountersFor(trap_op));
+}
+
+void TrapManager::DispatchTrap(uint16_t trap_op,
+                               TrapStats::Counters& counters) {
+  const auto start = std::chrono::steady_clock::now();
 
   // This must be removed from the stack so the arguments are at the top:
   Ptr return_address = Pop<Ptr>();
@@ -178,6 +191,11 @@ void TrapManager::PerformTrapDispatch(uint16_t trap_index, bool is_toolbox) {
   }
 
   Push<Ptr>(return_address);
+
+  TrapStats::RecordLatency(
+      counters, std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start)
+                    .count());
 }
 
 uint32_t TrapManager::GetTrapAddress(uint16_t trap) {
@@ -190,18 +208,18 @@ uint32_t TrapManager::GetTrapAddress(uint16_t trap) {
     return patch_address->second;
   } else {
     if (IsToolbox(trap)) {
-      return memory::kBaseToolboxTrapAddress +
+      return memory::BaseToolboxTrapAddress() +
              ExtractIndex(trap) * sizeof(uint16_t);
     } else {
-      return memory::kBaseSystemTrapAddress +
+      return memory::BaseSystemTrapAddress() +
              ExtractIndex(trap) * sizeof(uint16_t);
     }
   }
 }
 
 void TrapManager::SetTrapAddress(uint16_t trap, uint32_t address) {
-  if (address >= memory::kBaseToolboxTrapAddress &&
-      address < memory::kTrapManagerExitAddress) {
+  if (address >= memory::BaseToolboxTrapAddress() &&
+      address < memory::TrapManagerExitAddress()) {
     patch_trap_addresses_.erase(trap);
     return;
   }
@@ -224,6 +242,8 @@ void TrapManager::PatchTrapsFromSystemFile(
     LOG(INFO) << "Loading PACK4 into memory";
     Handle handle =
         memory_manager.AllocateHandleForRegion(pack4->GetData(), "PACK4");
+    // The trap table refers to the package by address so it must not move
+    memory_manager.SetHandleLocked(handle, /*locked=*/true);
     size_t address = MUST(memory::kSystemMemory.Read<uint32_t>(handle));
     SetTrapAddress(Trap::Pack4, address);
   }
@@ -232,6 +252,7 @@ void TrapManager::PatchTrapsFromSystemFile(
     LOG(INFO) << "Loading PACK7 into memory";
     Handle handle =
         memory_manager.AllocateHandleForRegion(pack7->GetData(), "PACK7");
+    memory_manager.SetHandleLocked(handle, /*locked=*/true);
     size_t address = MUST(memory::kSystemMemory.Read<uint32_t>(handle));
     SetTrapAddress(Trap::Pack7, address);
   }
@@ -303,5 +324,23 @@ bool TrapManager::InternalDispatch(uint16_t trap_op) {
   }
 }
 
+void TrapManager::SaveState(core::SnapshotWriter& writer) const {
+  writer.Write<uint32_t>(patch_trap_addresses_.size());
+  for (const auto& [trap, address] : patch_trap_addresses_) {
+    writer.Write<uint16_t>(trap);
+    writer.Write<uint32_t>(address);
+  }
+}
+
+absl::Status TrapManager::RestoreState(core::SnapshotReader& reader) {
+  patch_trap_addresses_.clear();
+  auto count = TRY(reader.Read<uint32_t>());
+  for (uint32_t i = 0; i < count; ++i) {
+    auto trap = TRY(reader.Read<uint16_t>());
+    patch_trap_addresses_[trap] = TRY(reader.Read<uint32_t>());
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace trap
 }  // namespace cyder
\ No newline at end of file
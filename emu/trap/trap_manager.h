@@ -8,10 +8,12 @@
 #include <optional>
 
 #include "absl/status/status.h"
+#include "core/snapshot.h"
 #include "emu/memory/memory_manager.h"
 #include "emu/rsrc/resource_file.h"
 #include "emu/segment_loader.h"
 #include "emu/trap/trap_dispatcher.h"
+#include "emu/trap/trap_stats.h"
 
 struct SDL_Renderer;
 
@@ -27,6 +29,10 @@ class TrapManager {
   void PatchTrapsFromSystemFile(memory::MemoryManager& memory_manager,
                                 rsrc::ResourceFile& system_file);
 
+  // Saves/restores the addresses of patched traps.
+  void SaveState(core::SnapshotWriter& writer) const;
+  absl::Status RestoreState(core::SnapshotReader& reader);
+
  private:
   // Gets the current address for the given `trap` handler.
   uint32_t GetTrapAddress(uint16_t trap);
@@ -39,6 +45,8 @@ class TrapManager {
   // Dispatches to a native trap handler for the given trap. Can be called from
   // emulated code (in the case of trap patches chaining to the original).
   void PerformTrapDispatch(uint16_t trap_index, bool is_toolbox);
+  // Runs the native handler for `trap_op` timing it into `counters`.
+  void DispatchTrap(uint16_t trap_op, TrapStats::Counters& counters);
   // Handles traps pertaining to the TrapManager itself. Prevents dependency
   // inversion with the TrapDispatcher.
   bool InternalDispatch(uint16_t trap_op);
@@ -0,0 +1,88 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/trap/trap_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "absl/numeric/bits.h"
+#include "absl/strings/str_format.h"
+#include "emu/machine.h"
+#include "gen/trap_names.h"
+
+namespace cyder {
+namespace trap {
+
+uint64_t TrapStats::Counters::LatencyPercentile(double percentile) const {
+  if (timed_calls == 0)
+    return 0;
+
+  const uint64_t target = std::max<uint64_t>(
+      1, static_cast<uint64_t>(std::ceil(percentile * timed_calls)));
+  uint64_t seen = 0;
+  for (size_t bucket = 0; bucket < kLatencyBuckets; ++bucket) {
+    seen += latency_histogram[bucket];
+    if (seen >= target)
+      return uint64_t{1} << bucket;
+  }
+  return uint64_t{1} << (kLatencyBuckets - 1);
+}
+
+// static
+TrapStats& TrapStats::Instance() {
+  return Machine::Current().Get<TrapStats>();
+}
+
+TrapStats::Counters& TrapStats::RecordTrap(uint16_t trap_op,
+                                           uint64_t total_cycles) {
+  Counters& counters = CountersFor(trap_op);
+  if (counters.calls != 0) {
+    counters.cycles_between_calls += total_cycles - counters.last_call_cycles;
+  }
+  counters.last_call_cycles = total_cycles;
+  ++counters.calls;
+  ++total_;
+  return counters;
+}
+
+// static
+void TrapStats::RecordLatency(Counters& counters, uint64_t ns) {
+  ++counters.timed_calls;
+  counters.total_ns += ns;
+  // Bucket N holds [2^(N-1), 2^N) so that its upper bound is exclusive
+  size_t bucket = std::min<size_t>(absl::bit_width(ns), kLatencyBuckets - 1);
+  ++counters.latency_histogram[bucket];
+}
+
+void TrapStats::Print(std::ostream& os) const {
+  std::vector<std::pair<uint16_t, const Counters*>> sorted;
+  ForEachTrap([&](uint16_t trap_op, const Counters& counters) {
+    sorted.push_back({trap_op, &counters});
+  });
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const auto& lhs, const auto& rhs) {
+                     return lhs.second->total_ns > rhs.second->total_ns;
+                   });
+
+  os << absl::StreamFormat("%-24s %10s %10s %9s %9s %9s %12s\n", "Trap",
+                           "Calls", "Total ms", "Mean us", "p50 us", "p99 us",
+                           "Cycles/call");
+  for (const auto& [trap_op, counters] : sorted) {
+    const char* name = GetTrapName(trap_op);
+    const double timed = std::max<uint64_t>(counters->timed_calls, 1);
+    const uint64_t gaps = std::max<uint64_t>(counters->calls - 1, 1);
+    os << absl::StreamFormat(
+        "%-24s %10d %10.3f %9.1f %9.1f %9.1f %12d\n",
+        name ? name : absl::StrFormat("0x%04X", trap_op), counters->calls,
+        counters->total_ns / 1e6, counters->total_ns / timed / 1e3,
+        counters->LatencyPercentile(0.5) / 1e3,
+        counters->LatencyPercentile(0.99) / 1e3,
+        counters->cycles_between_calls / gaps);
+  }
+  os << absl::StreamFormat("%d traps\n", total_);
+}
+
+}  // namespace trap
+}  // namespace cyder
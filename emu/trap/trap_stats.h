@@ -0,0 +1,81 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+
+#include "emu/trap/trap_helpers.h"
+
+namespace cyder {
+namespace trap {
+
+// Counts the A-Traps entered by the running application and times their
+// native handlers (for reports and finding slow traps).
+class TrapStats {
+ public:
+  static TrapStats& Instance();
+
+  // Latencies are bucketed by powers of two of nanoseconds (bucket N holds
+  // latencies below 2^N ns with the last bucket holding everything larger).
+  static constexpr size_t kLatencyBuckets = 32;
+
+  struct Counters {
+    uint64_t calls = 0;
+    // The emulated cycles run between consecutive calls (summed).
+    uint64_t cycles_between_calls = 0;
+    uint64_t last_call_cycles = 0;
+    // The host time spent in the native handler (including nested traps).
+    uint64_t timed_calls = 0;
+    uint64_t total_ns = 0;
+    std::array<uint64_t, kLatencyBuckets> latency_histogram{};
+
+    // Returns the upper bound (in ns) of the bucket holding `percentile`
+    // (0-1) of the timed calls or 0 if none were timed.
+    uint64_t LatencyPercentile(double percentile) const;
+  };
+
+  // Returns the counters of `trap_op` which are shared by all of its flags.
+  Counters& CountersFor(uint16_t trap_op) {
+    return IsToolbox(trap_op) ? toolbox_[ExtractToolboxIndex(trap_op)]
+                              : system_[ExtractSystemIndex(trap_op)];
+  }
+  const Counters& CountersFor(uint16_t trap_op) const {
+    return const_cast<TrapStats*>(this)->CountersFor(trap_op);
+  }
+
+  // Records an entry to `trap_op` after `total_cycles` emulated cycles have
+  // been run and returns its counters (for passing to `RecordLatency()`).
+  Counters& RecordTrap(uint16_t trap_op, uint64_t total_cycles);
+  // Records that the native handler took `ns` to run.
+  static void RecordLatency(Counters& counters, uint64_t ns);
+
+  // Calls `fn(trap_op, counters)` for each trap which was entered or timed
+  // (in order of `trap_op`).
+  template <typename Fn>
+  void ForEachTrap(Fn fn) const {
+    for (size_t index = 0; index < system_.size(); ++index) {
+      if (system_[index].calls != 0 || system_[index].timed_calls != 0)
+        fn(static_cast<uint16_t>(0xA000 | index), system_[index]);
+    }
+    for (size_t index = 0; index < toolbox_.size(); ++index) {
+      if (toolbox_[index].calls != 0 || toolbox_[index].timed_calls != 0)
+        fn(static_cast<uint16_t>(0xA800 | index), toolbox_[index]);
+    }
+  }
+  uint64_t total() const { return total_; }
+
+  // Prints a table of each trap's counters ordered by total host time.
+  void Print(std::ostream& os) const;
+
+ private:
+  // Indexed the same as the trap dispatch tables
+  std::array<Counters, 1024> toolbox_;
+  std::array<Counters, 256> system_;
+  uint64_t total_ = 0;
+};
+
+}  // namespace trap
+}  // namespace cyder
@@ -0,0 +1,73 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/trap/trap_stats.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+namespace cyder {
+namespace trap {
+namespace {
+
+using ::testing::HasSubstr;
+
+TEST(TrapStatsTests, CountsCallsAndCyclesBetween) {
+  TrapStats stats;
+  stats.RecordTrap(0xA970, /*total_cycles=*/100);
+  stats.RecordTrap(0xA970, /*total_cycles=*/300);
+  stats.RecordTrap(0xA970, /*total_cycles=*/700);
+
+  const auto& counters = stats.CountersFor(0xA970);
+  EXPECT_EQ(counters.calls, 3u);
+  EXPECT_EQ(counters.cycles_between_calls, 600u);
+  EXPECT_EQ(stats.total(), 3u);
+}
+
+TEST(TrapStatsTests, SharesCountersAcrossFlags) {
+  TrapStats stats;
+  // _NewPtr with and without the "clear" flag
+  stats.RecordTrap(0xA11E, /*total_cycles=*/0);
+  stats.RecordTrap(0xA31E, /*total_cycles=*/0);
+
+  EXPECT_EQ(stats.CountersFor(0xA11E).calls, 2u);
+  EXPECT_EQ(&stats.CountersFor(0xA11E), &stats.CountersFor(0xA31E));
+}
+
+TEST(TrapStatsTests, LatencyPercentiles) {
+  TrapStats stats;
+  auto& counters = stats.CountersFor(0xA970);
+  for (int i = 0; i < 98; ++i) {
+    TrapStats::RecordLatency(counters, /*ns=*/1000);
+  }
+  TrapStats::RecordLatency(counters, /*ns=*/1'000'000);
+  TrapStats::RecordLatency(counters, /*ns=*/1'000'000);
+
+  EXPECT_EQ(counters.total_ns, 98'000u + 2'000'000u);
+  // 1000ns falls within [512, 1024)
+  EXPECT_EQ(counters.LatencyPercentile(0.5), 1024u);
+  EXPECT_EQ(counters.LatencyPercentile(0.98), 1024u);
+  // 1ms falls within [2^19, 2^20)
+  EXPECT_EQ(counters.LatencyPercentile(0.99), 1u << 20);
+  EXPECT_EQ(TrapStats::Counters().LatencyPercentile(0.5), 0u);
+}
+
+TEST(TrapStatsTests, PrintsSlowestFirst) {
+  TrapStats stats;
+  TrapStats::RecordLatency(stats.RecordTrap(0xA970, /*total_cycles=*/0),
+                           /*ns=*/10);
+  TrapStats::RecordLatency(stats.RecordTrap(0xA8F6, /*total_cycles=*/0),
+                           /*ns=*/1000);
+
+  std::stringstream output;
+  stats.Print(output);
+  EXPECT_LT(output.str().find("DrawPicture"),
+            output.str().find("GetNextEvent"));
+  EXPECT_THAT(output.str(), HasSubstr("2 traps"));
+}
+
+}  // namespace
+}  // namespace trap
+}  // namespace cyder
@@ -0,0 +1,162 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#include "emu/vertical_retrace.h"
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+#include "core/logging.h"
+#include "core/status_helpers.h"
+#include "emu/emulator.h"
+#include "emu/machine.h"
+#include "emu/memory/memory_map.h"
+#include "gen/global_names.h"
+#include "gen/typegen/generated_types.tdef.h"
+#include "third_party/musashi/src/m68k.h"
+
+namespace cyder {
+namespace {
+
+constexpr bool kVerboseLogging = false;
+
+#define LOG_VBL(level) LOG_IF(level, kVerboseLogging)
+
+constexpr uint16_t kVType = 1;
+constexpr int16_t kNoErr = 0;
+constexpr int16_t kQErr = -1;
+constexpr int16_t kVTypErr = -2;
+
+constexpr uint32_t kTicksPerSecond = 60;
+
+// Offsets of `qHead` and `qTail` in the `QHdr` at `VBLQueue`
+constexpr uint32_t kQueueHeadOffset = 2;
+constexpr uint32_t kQueueTailOffset = 6;
+
+// The registers an interrupted routine expects to be preserved. A7 is restored
+// by `CallFunction()`.
+constexpr m68k_register_t kSavedRegisters[] = {
+    M68K_REG_D0, M68K_REG_D1, M68K_REG_D2, M68K_REG_D3, M68K_REG_D4,
+    M68K_REG_D5, M68K_REG_D6, M68K_REG_D7, M68K_REG_A0, M68K_REG_A1,
+    M68K_REG_A2, M68K_REG_A3, M68K_REG_A4, M68K_REG_A5, M68K_REG_A6};
+
+}  // namespace
+
+// static
+VerticalRetraceManager& VerticalRetraceManager::Instance() {
+  return Machine::Current().Get<VerticalRetraceManager>();
+}
+
+absl::StatusOr<int16_t> VerticalRetraceManager::Install(Ptr task) {
+  auto record = TRY(ReadType<VBLTask>(memory::kSystemMemory, task));
+  LOG_VBL(INFO) << "Install VBL task at 0x" << std::hex << task << ": "
+                << record;
+  if (record.qType != kVType)
+    return kVTypErr;
+
+  tasks_.push_back(task);
+  RETURN_IF_ERROR(WriteQueue());
+  return kNoErr;
+}
+
+absl::StatusOr<int16_t> VerticalRetraceManager::Remove(Ptr task) {
+  auto it = std::find(tasks_.begin(), tasks_.end(), task);
+  if (it == tasks_.end())
+    return kQErr;
+
+  LOG_VBL(INFO) << "Remove VBL task at 0x" << std::hex << task;
+  tasks_.erase(it);
+  RETURN_IF_ERROR(WriteQueue());
+  return kNoErr;
+}
+
+absl::Status VerticalRetraceManager::OnVerticalBlank(uint32_t ticks) {
+  RETURN_IF_ERROR(memory::kSystemMemory.Write<uint32_t>(GlobalVars::Ticks,
+                                                        ticks));
+  // `Time` (in seconds) is advanced by the whole seconds which have passed
+  // since the last VBL interrupt. Ticks can be skipped while waiting for
+  // events so it is not just one tick at a time.
+  uint32_t elapsed_seconds =
+      ticks / kTicksPerSecond - last_ticks_ / kTicksPerSecond;
+  last_ticks_ = ticks;
+  if (elapsed_seconds > 0) {
+    uint32_t time =
+        TRY(memory::kSystemMemory.Read<uint32_t>(GlobalVars::Time));
+    RETURN_IF_ERROR(memory::kSystemMemory.Write<uint32_t>(
+        GlobalVars::Time, time + elapsed_seconds));
+  }
+
+  if (tasks_.empty())
+    return absl::OkStatus();
+
+  // Tasks may install/remove tasks (including themselves) while running
+  const std::vector<Ptr> tasks(tasks_.begin(), tasks_.end());
+  for (Ptr task : tasks) {
+    if (std::find(tasks_.begin(), tasks_.end(), task) == tasks_.end())
+      continue;
+
+    // Tasks whose count has reached zero stay in the queue but are not run
+    // again until the task resets `vblCount`.
+    auto count = TRY(memory::kSystemMemory.Read<uint16_t>(
+        task + VBLTaskFields::vblCount.offset));
+    if (count == 0)
+      continue;
+    RETURN_IF_ERROR(memory::kSystemMemory.Write<uint16_t>(
+        task + VBLTaskFields::vblCount.offset, --count));
+    if (count != 0)
+      continue;
+
+    auto vbl_addr = TRY(memory::kSystemMemory.Read<uint32_t>(
+        task + VBLTaskFields::vblAddr.offset));
+    LOG_VBL(INFO) << "Run VBL task at 0x" << std::hex << task
+                  << " (vblAddr: 0x" << vbl_addr << ")";
+
+    uint32_t saved_registers[std::size(kSavedRegisters)];
+    for (size_t i = 0; i < std::size(kSavedRegisters); ++i) {
+      saved_registers[i] = m68k_get_reg(NULL, kSavedRegisters[i]);
+    }
+    // VBL tasks are passed a pointer to their `VBLTask` in A0
+    m68k_set_reg(M68K_REG_A0, task);
+    CallFunction<void>(vbl_addr);
+    for (size_t i = 0; i < std::size(kSavedRegisters); ++i) {
+      m68k_set_reg(kSavedRegisters[i], saved_registers[i]);
+    }
+  }
+  return absl::OkStatus();
+}
+
+void VerticalRetraceManager::SaveState(core::SnapshotWriter& writer) const {
+  writer.Write<uint32_t>(last_ticks_);
+  writer.Write<uint32_t>(tasks_.size());
+  for (Ptr task : tasks_) {
+    writer.Write<Ptr>(task);
+  }
+}
+
+absl::Status VerticalRetraceManager::RestoreState(
+    core::SnapshotReader& reader) {
+  last_ticks_ = TRY(reader.Read<uint32_t>());
+  tasks_.clear();
+  auto count = TRY(reader.Read<uint32_t>());
+  for (uint32_t i = 0; i < count; ++i) {
+    tasks_.push_back(TRY(reader.Read<Ptr>()));
+  }
+  return absl::OkStatus();
+}
+
+absl::Status VerticalRetraceManager::WriteQueue() {
+  for (auto it = tasks_.begin(); it != tasks_.end(); ++it) {
+    auto next = std::next(it);
+    RETURN_IF_ERROR(memory::kSystemMemory.Write<uint32_t>(
+        *it + VBLTaskFields::qLink.offset, next == tasks_.end() ? 0 : *next));
+  }
+  RETURN_IF_ERROR(memory::kSystemMemory.Write<uint32_t>(
+      GlobalVars::VBLQueue + kQueueHeadOffset,
+      tasks_.empty() ? 0 : tasks_.front()));
+  return memory::kSystemMemory.Write<uint32_t>(
+      GlobalVars::VBLQueue + kQueueTailOffset,
+      tasks_.empty() ? 0 : tasks_.back());
+}
+
+}  // namespace cyder
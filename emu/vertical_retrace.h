@@ -0,0 +1,44 @@
+// Copyright (c) 2025, Jordan Werthman
+// SPDX-License-Identifier: BSD-2-Clause
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "core/snapshot.h"
+#include "gen/typegen/typegen_prelude.h"
+
+namespace cyder {
+
+// Implements the Vertical Retrace Manager which runs the VBL tasks installed
+// with `VInstall` on every vertical blanking interrupt and keeps the `Ticks`
+// and `Time` globals up to date.
+// Link: http://0.0.0.0:8000/docs/mac/Processes/Processes-92.html
+class VerticalRetraceManager {
+ public:
+  static VerticalRetraceManager& Instance();
+
+  // Adds `task` (a `VBLTask`) to the VBL queue returning an `OSErr`.
+  absl::StatusOr<int16_t> Install(Ptr task);
+  // Removes `task` from the VBL queue returning an `OSErr`.
+  absl::StatusOr<int16_t> Remove(Ptr task);
+
+  // Handles a vertical blanking interrupt at `ticks` since startup.
+  absl::Status OnVerticalBlank(uint32_t ticks);
+
+  // Saves/restores the installed tasks.
+  void SaveState(core::SnapshotWriter& writer) const;
+  absl::Status RestoreState(core::SnapshotReader& reader);
+
+ private:
+  // Writes the queue back to the `VBLQueue` global and `qLink` fields.
+  absl::Status WriteQueue();
+
+  std::list<Ptr> tasks_;
+  uint32_t last_ticks_ = 0;
+};
+
+}  // namespace cyder
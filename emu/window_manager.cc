@@ -6,6 +6,7 @@
 #include "emu/font/font.h"
 #include "emu/graphics/graphics_helpers.h"
 #include "emu/graphics/quickdraw.h"
+#include "emu/machine.h"
 #include "emu/memory/memory_helpers.h"
 #include "emu/memory/memory_manager.h"
 #include "emu/memory/memory_map.h"
@@ -78,8 +79,6 @@ Rect CalculateGoAwayRect(Rect title_rect) {
   return InsetRect(title_rect, 3, 3);
 }
 
-static WindowManager* s_instance;
-
 }  // namespace
 
 void DrawWindowFrame(const WindowRecord& window,
@@ -91,13 +90,18 @@ WindowManager::WindowManager(EventManager& event_manager,
     : event_manager_(event_manager),
       screen_(screen),
       memory_(memory),
-      desktop_region_(CalculateDesktopRegion(screen)) {
-  s_instance = this;
+      desktop_region_(CalculateDesktopRegion(screen)),
+      machine_(Machine::Current()) {
+  machine_.Register(this);
+}
+
+WindowManager::~WindowManager() {
+  machine_.Unregister(this);
 }
 
 // static
 WindowManager& WindowManager::the() {
-  return *s_instance;
+  return Machine::Current().GetRegistered<WindowManager>();
 }
 
 absl::StatusOr<WindowRecord> WindowManager::NewWindowRecord(
@@ -592,4 +596,20 @@ void UpdateWindowRegions(WindowRecord& window, const MemoryManager& memory) {
   write_region_to_handle(window.structure_region, struct_rect);
 }
 
+void WindowManager::SaveState(core::SnapshotWriter& writer) const {
+  writer.Write<uint32_t>(window_list_.size());
+  for (Ptr window : window_list_) {
+    writer.Write<Ptr>(window);
+  }
+}
+
+absl::Status WindowManager::RestoreState(core::SnapshotReader& reader) {
+  window_list_.clear();
+  auto count = TRY(reader.Read<uint32_t>());
+  for (uint32_t i = 0; i < count; ++i) {
+    window_list_.push_back(TRY(reader.Read<Ptr>()));
+  }
+  return absl::OkStatus();
+}
+
 }  // namespace cyder
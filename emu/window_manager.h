@@ -5,8 +5,10 @@
 
 #include <list>
 
+#include "core/snapshot.h"
 #include "emu/event_manager.h"
 #include "emu/graphics/bitmap_image.h"
+#include "emu/machine.h"
 #include "emu/memory/memory_manager.h"
 #include "emu/window_manager.tdef.h"
 #include "gen/typegen/generated_types.tdef.h"
@@ -20,6 +22,7 @@ class WindowManager {
   WindowManager(EventManager& event_manager,
                 graphics::BitmapImage& screen,
                 memory::MemoryManager& memory);
+  ~WindowManager();
 
   static WindowManager& the();
 
@@ -71,6 +74,10 @@ class WindowManager {
 
   void AddWindowToListAndActivate(WindowPtr window_storage);
 
+  // Saves/restores the window list (front to back).
+  void SaveState(core::SnapshotWriter& writer) const;
+  absl::Status RestoreState(core::SnapshotReader& reader);
+
  private:
   // Reorders the window linked list so that |window_pt| comes first
   void MoveToFront(Ptr window_ptr);
@@ -89,6 +96,9 @@ class WindowManager {
   std::list<Ptr> window_list_;
 
   Rect outline_rect_;
+
+  // The machine this is registered with (until it is destroyed).
+  Machine& machine_;
 };
 
 void UpdateWindowRegions(WindowRecord& record,
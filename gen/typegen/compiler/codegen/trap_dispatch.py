@@ -4,72 +4,123 @@ import re
 from compiler.codegen.common import get_c_type, get_stream_format
 from compiler.type_checker import CheckedTrapExpression, CheckedTypeExpression
 
-_HEADER_FILE_TEMPLATE = """
+_GENERATED_NOTICE = """
 // This file is auto-generated by gen/typegen/main.py
 // Do not edit this file directly.
-// To regenerate, run: gen/typegen/main.py -i <input_files> -o <output_file> <root_directory>
+// To regenerate, run: gen/typegen/main.py -c build_dispatch -i <input_files> -o <output_file> <root_directory>
+"""
 
+_HEADER_FILE_TEMPLATE = """
 #pragma once
 
 #include <cstdint>
 
 #include "absl/status/status.h"
 
-{{#includes}}
-#include "{{.}}"
-{{/includes}}
+{includes}
+
+namespace cyder::trap::gen {{
+
+// Handles the traps which are not declared in any definition file.
+class NativeTraps {{
+ public:
+  virtual ~NativeTraps() = default;
+
+  virtual absl::Status DispatchNativeSystemTrap(uint16_t trap) = 0;
+  virtual absl::Status DispatchNativeToolboxTrap(uint16_t trap) = 0;
+}};
 
-namespace cyder::trap::gen {
+// The native implementations of the traps declared in each definition file.
+struct TrapTargets {{
+  NativeTraps* native = nullptr;
+{targets}
+}};
 
-absl::Status Dispatch(uint16_t trap, {{dependencies}});
+// Returns whether `trap` is declared in a definition file (otherwise it is
+// dispatched to `TrapTargets::native`).
+bool IsGenerated(uint16_t trap);
 
-}  // namespace cyder::trap::gen
+// Unmarshals the arguments of `trap` (from the stack for Toolbox traps or
+// registers for OS traps), calls its native implementation in `targets` and
+// returns the result the same way. Toolbox and OS traps are each a single load
+// from a table indexed by trap number.
+absl::Status Dispatch(uint16_t trap, const TrapTargets& targets);
+
+}}  // namespace cyder::trap::gen
 """
 
 _SOURCE_FILE_TEMPLATE = """
-// This file is auto-generated by gen/typegen/main.py
-// Do not edit this file directly.
-// To regenerate, run: gen/typegen/main.py -i <input_files> -o <output_file> <root_directory>
+#include "{header}"
 
+#include <array>
 #include <cstddef>
 #include <cstdint>
 
 #include "absl/status/status.h"
-#include "absl/strings/str_cat.h"
 #include "core/logging.h"
+#include "core/status_helpers.h"
 #include "emu/trap/stack_helpers.h"
-#include "gen/trap_names.h"
 #include "third_party/musashi/src/m68k.h"
 
-{{#includes}}
-#include "{{.}}"
-{{/includes}}
-
 constexpr bool kVerboseLogTraps = false;
 
 #define LOG_TRAP() LOG_IF(INFO, kVerboseLogTraps) << "TRAP "
 
-namespace cyder::trap::gen {
-
-absl::Status Dispatch(uint16_t trap, {{dependencies}}) {
-  switch(trap) {
-    {{#file}}
-    // {{path}}:
-    {{#traps}}
-    case Trap::{{name}}: {
-      {{{body}}}
-    }
-    {{/traps}}
-    {{/file}}
-    default:
-      return absl::UnimplementedError(absl::StrCat(
-          "Unimplemented Toolbox trap: '", GetTrapName(trap), "'"));
-  }
-}
-
-}  // namespace cyder::trap::gen
+namespace cyder::trap::gen {{
+namespace {{
+
+using TrapHandler = absl::Status (*)(uint16_t trap, const TrapTargets& targets);
+
+{handlers}
+
+absl::Status HandleNativeSystemTrap(uint16_t trap, const TrapTargets& targets) {{
+  return targets.native->DispatchNativeSystemTrap(trap);
+}}
+
+absl::Status HandleNativeToolboxTrap(uint16_t trap,
+                                     const TrapTargets& targets) {{
+  return targets.native->DispatchNativeToolboxTrap(trap);
+}}
+
+constexpr std::array<TrapHandler, 1024> kToolboxHandlers = [] {{
+  std::array<TrapHandler, 1024> handlers{{}};
+  for (auto& handler : handlers)
+    handler = &HandleNativeToolboxTrap;
+{toolbox_entries}
+  return handlers;
+}}();
+
+constexpr std::array<TrapHandler, 256> kSystemHandlers = [] {{
+  std::array<TrapHandler, 256> handlers{{}};
+  for (auto& handler : handlers)
+    handler = &HandleNativeSystemTrap;
+{system_entries}
+  return handlers;
+}}();
+
+TrapHandler GetHandler(uint16_t trap) {{
+  if (trap & (1 << 11))
+    return kToolboxHandlers[trap & 0x03FF];
+  return kSystemHandlers[trap & 0x00FF];
+}}
+
+}}  // namespace
+
+bool IsGenerated(uint16_t trap) {{
+  TrapHandler handler = GetHandler(trap);
+  return handler != &HandleNativeToolboxTrap &&
+         handler != &HandleNativeSystemTrap;
+}}
+
+absl::Status Dispatch(uint16_t trap, const TrapTargets& targets) {{
+  return GetHandler(trap)(trap, targets);
+}}
+
+}}  // namespace cyder::trap::gen
 """
 
+RE_NAME_ENTRY = re.compile(r'^(?P<trap>A[\d\w]{3}) => (?P<name>[\d\w]+)$')
+
 
 def snake_to_camel(snake_case: str, capitalize_first: bool):
   split = snake_case.split('_')
@@ -82,27 +133,34 @@ def snake_to_camel(snake_case: str, capitalize_first: bool):
 def _format_log_trap(trap: CheckedTrapExpression):
   if not trap.arguments:
     return f'LOG_TRAP() << "{trap.id}()";'
-  return f'LOG_TRAP() << "{trap.id}(' + ' << " '.join(f'{snake_to_camel(arg.id, capitalize_first=False)}: " << {get_stream_format('', arg)}' for arg in trap.arguments) + ' << ")";'
+  args = ' << ", '.join(
+      f'{snake_to_camel(arg.id, capitalize_first=False)}: " << '
+      f'{get_stream_format("", arg)}' for arg in trap.arguments)
+  return f'LOG_TRAP() << "{trap.id}({args} << ")";'
 
 
-def _format_toolbox_trap_body(path: str, trap: CheckedTrapExpression):
+def _format_call(object_name: str, trap: CheckedTrapExpression):
+  args_list = ', '.join(arg.id for arg in trap.arguments)
+  return f'targets.{object_name}->{trap.id}({args_list})'
+
+
+def _format_toolbox_trap_body(object_name: str, trap: CheckedTrapExpression):
   lines = []
-  for arg in trap.arguments:
+  # Pascal pushes arguments from left to right so the last is on top
+  for arg in reversed(trap.arguments):
     pop_func = 'PopRef' if arg.type.size > 4 or arg.type.id == 'str' else 'PopType' if arg.type.is_struct else 'Pop'
-    lines.append(f'auto {arg.id} = TRY({pop_func}<{get_c_type(arg.type)}>());')
+    lines.append(f'auto {arg.id} = {pop_func}<{get_c_type(arg.type)}>();')
 
   lines.append(_format_log_trap(trap))
 
-  object_name = os.path.splitext(os.path.basename(path))[0]
-  args_list = ', '.join(arg.id for arg in trap.arguments)
   if trap.ret:
-    lines.append(f'auto _result = TRY({object_name}->{trap.id}({args_list}));')
-    lines.append(f'return TrapReturn<{get_c_type(trap.ret)}>(_result);')
+    lines.append(f'auto result = TRY({_format_call(object_name, trap)});')
+    lines.append(f'return TrapReturn<{get_c_type(trap.ret)}>(result);')
   else:
-    lines.append(f'{object_name}->{trap.id}({args_list});')
+    lines.append(f'{_format_call(object_name, trap)};')
     lines.append('return absl::OkStatus();')
 
-  return '\n'.join(lines)
+  return lines
 
 
 class RegisterAssigner:
@@ -124,80 +182,103 @@ class RegisterAssigner:
     self.d = 0
 
 
-def _format_system_trap_body(path: str, trap: CheckedTrapExpression):
+def _format_system_trap_body(object_name: str, trap: CheckedTrapExpression):
   assigner = RegisterAssigner()
 
   lines = []
   for arg in trap.arguments:
     lines.append(
-        f'auto {arg.id} = m68k_get_reg(NULL, {assigner.get_reg(arg.type)});')
+        f'auto {arg.id} = static_cast<{get_c_type(arg.type)}>('
+        f'm68k_get_reg(NULL, {assigner.get_reg(arg.type)}));')
 
   lines.append(_format_log_trap(trap))
 
   assigner.reset()
 
-  object_name = os.path.splitext(os.path.basename(path))[0]
-  args_list = ', '.join(arg.id for arg in trap.arguments)
   if trap.ret:
-    lines.append(f'auto _result = TRY({object_name}->{trap.id}({args_list}));')
-    result = 'static_cast<int32_t>(_result)' if trap.ret.is_enum else '_result'
+    lines.append(f'auto result = TRY({_format_call(object_name, trap)});')
+    result = 'static_cast<int32_t>(result)' if trap.ret.is_enum else 'result'
     lines.append(f'm68k_set_reg({assigner.get_reg(trap.ret)}, {result});')
   else:
-    lines.append(f'{object_name}->{trap.id}({args_list});')
+    lines.append(f'{_format_call(object_name, trap)};')
 
   lines.append('return absl::OkStatus();')
-  return '\n'.join(lines)
+  return lines
 
 
-def write_dispatch_table(output_path, path_to_traps):
-  TRAP_NAMES_PATH = os.path.join(os.path.dirname(
+def _read_trap_numbers():
+  trap_names_path = os.path.join(os.path.dirname(
       os.path.realpath(__file__)), '../../../trap_names.txt')
 
-  RE_NAME_ENTRY = re.compile(r'^(?P<trap>A[\d\w]{3}) => (?P<name>[\d\w]+)$')
-
-  trap_is_toolbox = {}
-  with open(TRAP_NAMES_PATH, 'r') as f:
+  trap_numbers = {}
+  with open(trap_names_path, 'r') as f:
     for line in f.readlines():
       # Skip blank lines
       if not line.strip():
-          continue
+        continue
 
       match = RE_NAME_ENTRY.match(line)
       if not match:
-          raise ValueError(f'Invalid trap name entry: "{line.strip()}"')
-
-      (name, trap) = (match.group('name'), match.group('trap'))
-      trap_is_toolbox[name] = (int(trap, 16) >> 11) & 1
-
-  list_of_deps = [os.path.splitext(os.path.basename(path))[0]
-                  for path in path_to_traps.keys()]
-
-  import pystache
-  with open(output_path + ".h", 'w') as file:
-    print('writing header file:', output_path + ".h")
-    file.write(pystache.render(_HEADER_FILE_TEMPLATE, {
-        'includes': [f'{include}.h' for include in path_to_traps.keys()],
-        'dependencies': ', '.join(
-            f'::gen::{snake_to_camel(dep, capitalize_first=True)}* {dep}'
-            for dep in list_of_deps),
-    }))
+        raise ValueError(f'Invalid trap name entry: "{line.strip()}"')
+
+      trap_numbers[match.group('name')] = int(match.group('trap'), 16)
+  return trap_numbers
+
+
+def write_dispatch_table(output_path, root_directory, path_to_traps):
+  trap_numbers = _read_trap_numbers()
+
+  includes = []
+  targets = []
+  handlers = []
+  toolbox_entries = {}
+  system_entries = {}
+  for (path, traps) in path_to_traps.items():
+    # Generated headers are included relative to the root (see typegen.cmake)
+    includes.append(
+        f'#include "{os.path.relpath(path, root_directory)}.h"')
+    object_name = os.path.splitext(os.path.basename(path))[0]
+    targets.append(
+        f'  ::gen::{snake_to_camel(object_name, capitalize_first=True)}* '
+        f'{object_name} = nullptr;')
+
+    handlers.append(f'// {os.path.relpath(path, root_directory)}:')
+    for trap in traps:
+      if trap.id not in trap_numbers:
+        raise ValueError(f'Unknown trap (see gen/trap_names.txt): {trap.id}')
+      trap_number = trap_numbers[trap.id]
+
+      if (trap_number >> 11) & 1:
+        body = _format_toolbox_trap_body(object_name, trap)
+        entries, index = toolbox_entries, trap_number & 0x03FF
+      else:
+        body = _format_system_trap_body(object_name, trap)
+        entries, index = system_entries, trap_number & 0x00FF
+      if index in entries:
+        raise ValueError(
+            f'{trap.id} has the same index as {entries[index]}')
+      entries[index] = trap.id
+
+      handlers.append(
+          f'absl::Status Handle{trap.id}(uint16_t, const TrapTargets& targets) {{\n' +
+          '\n'.join(f'  {line}' for line in body) + '\n}\n')
+
+  def format_entries(entries):
+    return '\n'.join(f'  handlers[0x{index:03X}] = &Handle{name};'
+                     for (index, name) in sorted(entries.items()))
+
+  header_path = output_path + ".h"
+  with open(header_path, 'w') as file:
+    print('writing header file:', header_path)
+    file.write(_GENERATED_NOTICE.lstrip())
+    file.write(_HEADER_FILE_TEMPLATE.format(
+        includes='\n'.join(includes),
+        targets='\n'.join(targets)))
 
   with open(output_path + ".cc", 'w') as file:
-    file.write(pystache.render(_SOURCE_FILE_TEMPLATE, {
-        'includes': [f'{include}.h' for include in path_to_traps.keys()],
-        'dependencies': ', '.join(
-            f'::gen::{snake_to_camel(dep, capitalize_first=True)}* {dep}'
-            for dep in list_of_deps),
-        'file': [
-            {
-                'path': path, 'traps': [
-                    {
-                        'name': trap.id,
-                        'body': _format_toolbox_trap_body(path, trap)
-                                if trap_is_toolbox[trap.id]
-                                else _format_system_trap_body(path, trap)
-                    }
-                    for trap in traps]
-            }
-            for (path, traps) in path_to_traps.items()],
-    }))
+    file.write(_GENERATED_NOTICE.lstrip())
+    file.write(_SOURCE_FILE_TEMPLATE.format(
+        header=os.path.basename(header_path),
+        handlers='\n'.join(handlers),
+        toolbox_entries=format_entries(toolbox_entries),
+        system_entries=format_entries(system_entries)))
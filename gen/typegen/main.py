@@ -7,7 +7,7 @@ import argparse
 import sys
 
 from compiler.codegen.codegen import CodeGenerator
-# from compiler.codegen.trap_dispatch import write_dispatch_table
+from compiler.codegen.trap_dispatch import write_dispatch_table
 from compiler.error_message import print_errors
 from compiler.files import FileResolver, FileException
 from compiler.type_checker import TypeChecker, CheckedTrapExpression
@@ -39,30 +39,33 @@ def compile(files_to_compile, output_path, root_directory):
       sys.exit(-1)
 
 
-# def build_trap_dispatch(files_to_compile, output_path, root_directory):
-#   try:
-#     sorted_files = FileResolver(root_directory).resolve(files_to_compile)
-#   except FileException as e:
-#     print_errors(e.errors, e.contents)
-#     exit(-1)
-
-#   global_checked_exprs = []
-#   collected_traps = {}
-#   for file in sorted_files:
-#     (exprs, errors) = TypeChecker().check(global_checked_exprs, file.exprs)
-#     if errors:
-#       print_errors(errors, file.contents)
-#       sys.exit(-1)
+def build_trap_dispatch(files_to_compile, output_path, root_directory):
+  try:
+    sorted_files = FileResolver(root_directory).resolve(files_to_compile)
+  except FileException as e:
+    print_errors(e.errors, e.contents)
+    exit(-1)
 
-#     global_checked_exprs += exprs
-#     if file.path not in files_to_compile:
-#       continue
+  global_checked_exprs = []
+  collected_traps = {}
+  for file in sorted_files:
+    (exprs, errors) = TypeChecker().check(global_checked_exprs, file.exprs)
+    if errors:
+      print_errors(errors, file.contents)
+      sys.exit(-1)
 
-#     collected_traps[file.path] = [expr for expr in exprs
-#                                   if isinstance(expr, CheckedTrapExpression)]
+    global_checked_exprs += exprs
+    if file.path not in files_to_compile:
+      continue
 
+    collected_traps[file.path] = [expr for expr in exprs
+                                  if isinstance(expr, CheckedTrapExpression)]
 
-#   write_dispatch_table(output_path, collected_traps)
+  try:
+    write_dispatch_table(output_path, root_directory, collected_traps)
+  except ValueError as e:
+    print(e)
+    sys.exit(-1)
 
 
 def main():
@@ -83,8 +86,7 @@ def main():
   if args.codegen == 'compile':
     compile(args.input, args.output, args.root_directory)
   elif args.codegen == 'build_dispatch':
-    # build_trap_dispatch(args.input, args.output, args.root_directory)
-    pass
+    build_trap_dispatch(args.input, args.output, args.root_directory)
 
 
 if __name__ == "__main__":
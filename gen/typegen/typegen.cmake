@@ -23,3 +23,27 @@ macro(typegen target_name type_definition)
   target_link_libraries(${target_name} CORE_LIB absl::statusor MEMORY_LOGGER_LIB TYPEGEN_PRELUDE)
   target_include_directories(${target_name} PUBLIC ${CMAKE_BINARY_DIR})
 endmacro()
+
+# ! trap_dispatch: generates a table dispatching the traps declared in each
+#   definition file (also built with `typegen`) to its native implementation
+macro(trap_dispatch target_name output_name)
+  set(type_definitions)
+  foreach(type_definition ${ARGN})
+    list(APPEND type_definitions ${CMAKE_CURRENT_SOURCE_DIR}/${type_definition})
+  endforeach()
+
+  add_custom_command(
+    OUTPUT ${output_name}.cc ${output_name}.h
+    COMMAND
+      ${Python3_EXECUTABLE} ${CMAKE_SOURCE_DIR}/gen/typegen/main.py
+      -c build_dispatch
+      -i ${type_definitions}
+      -o ${CMAKE_CURRENT_BINARY_DIR}/${output_name}
+      ${CMAKE_SOURCE_DIR}
+    DEPENDS ${TYPEGEN_SRC} ${type_definitions}
+            ${CMAKE_SOURCE_DIR}/gen/trap_names.txt)
+
+  add_library(${target_name} STATIC ${output_name}.cc)
+  target_link_libraries(${target_name} CORE_LIB absl::statusor MEMORY_LIB MUSASHI_LIB TYPEGEN_PRELUDE)
+  target_include_directories(${target_name} PUBLIC ${CMAKE_BINARY_DIR})
+endmacro()
@@ -74,8 +74,9 @@
 /* If ON, the CPU will call m68k_read_immediate_xx() for immediate addressing
  * and m68k_read_pcrelative_xx() for PC-relative addressing.
  * If off, all read requests from the CPU will be redirected to m68k_read_xx()
+ * Cyder separates them so instruction fetches are not counted as data reads.
  */
-#define M68K_SEPARATE_READS         OPT_OFF
+#define M68K_SEPARATE_READS         OPT_ON
 
 /* If ON, the CPU will call m68k_write_32_pd() when it executes move.l with a
  * predecrement destination EA mode instead of m68k_write_32().
@@ -138,7 +139,7 @@
  * You should put OPT_SPECIFY_HANDLER here if you cant to use it, otherwise it will
  * use a dummy default handler and you'll have to call m68k_set_illg_instr_callback explicitely
  */
-#define M68K_ILLG_HAS_CALLBACK	    OPT_OFF
+#define M68K_ILLG_HAS_CALLBACK	    OPT_ON
 #define M68K_ILLG_CALLBACK(opcode)  op_illg(opcode)
 
 /* If ON, CPU will call the set fc callback on every memory access to
@@ -160,8 +161,14 @@
 
 /* If ON, CPU will call the instruction hook callback before every
  * instruction.
+ * Cyder only needs the hook for single-stepping and tracing so it can be
+ * compiled out entirely (see CYDER_INSTRUCTION_HOOK in //CMakeLists.txt).
  */
+#ifdef CYDER_NO_INSTRUCTION_HOOK
+#define M68K_INSTRUCTION_HOOK       OPT_OFF
+#else
 #define M68K_INSTRUCTION_HOOK       OPT_ON
+#endif
 #define M68K_INSTRUCTION_CALLBACK(pc) your_instruction_hook_function(pc)
 
 